@@ -309,6 +309,45 @@ void archcheck_conn(const Context *ctx)
     }
 }
 
+void archcheck_indices(const Context *ctx)
+{
+    int bel_count = ctx->getBelCount();
+    if (bel_count > 0) {
+        log_info("Checking dense bel indices...\n");
+        std::vector<bool> used(bel_count, false);
+        for (BelId bel : ctx->getBels()) {
+            int idx = ctx->getBelIndex(bel);
+            log_assert(idx >= 0 && idx < bel_count);
+            log_assert(!used.at(idx));
+            used.at(idx) = true;
+        }
+    }
+
+    int wire_count = ctx->getWireCount();
+    if (wire_count > 0) {
+        log_info("Checking dense wire indices...\n");
+        std::vector<bool> used(wire_count, false);
+        for (WireId wire : ctx->getWires()) {
+            int idx = ctx->getWireIndex(wire);
+            log_assert(idx >= 0 && idx < wire_count);
+            log_assert(!used.at(idx));
+            used.at(idx) = true;
+        }
+    }
+
+    int pip_count = ctx->getPipCount();
+    if (pip_count > 0) {
+        log_info("Checking dense pip indices...\n");
+        std::vector<bool> used(pip_count, false);
+        for (PipId pip : ctx->getPips()) {
+            int idx = ctx->getPipIndex(pip);
+            log_assert(idx >= 0 && idx < pip_count);
+            log_assert(!used.at(idx));
+            used.at(idx) = true;
+        }
+    }
+}
+
 void archcheck_buckets(const Context *ctx)
 {
     log_info("Checking bucket data.\n");
@@ -374,6 +413,7 @@ void Context::archcheck() const
     archcheck_names(this);
     archcheck_locs(this);
     archcheck_conn(this);
+    archcheck_indices(this);
     archcheck_buckets(this);
 }
 
@@ -121,7 +121,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void bindBel(BelId bel, CellInfo *cell, PlaceStrength strength) override
     {
         NPNR_ASSERT(bel != BelId());
-        auto &entry = base_bel2cell[bel];
+        auto &entry = bel2cell_entry(bel);
         NPNR_ASSERT(entry == nullptr);
         cell->bel = bel;
         cell->belStrength = strength;
@@ -131,7 +131,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void unbindBel(BelId bel) override
     {
         NPNR_ASSERT(bel != BelId());
-        auto &entry = base_bel2cell[bel];
+        auto &entry = bel2cell_entry(bel);
         NPNR_ASSERT(entry != nullptr);
         entry->bel = BelId();
         entry->belStrength = STRENGTH_NONE;
@@ -145,6 +145,8 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual bool checkBelAvail(BelId bel) const override { return getBoundBelCell(bel) == nullptr; };
     virtual CellInfo *getBoundBelCell(BelId bel) const override
     {
+        if (!dense_bel2cell.empty())
+            return dense_bel2cell[this->getBelIndex(bel)];
         auto fnd = base_bel2cell.find(bel);
         return fnd == base_bel2cell.end() ? nullptr : fnd->second;
     }
@@ -158,6 +160,12 @@ template <typename R> struct BaseArch : ArchAPI<R>
     {
         return return_if_match<std::array<IdString, 1>, typename R::CellBelPinRangeT>({pin});
     }
+    // Dense bel indices are optional, a count of zero means that users must fall back to hashing BelId
+    virtual int getBelCount() const override { return 0; }
+    virtual int getBelIndex(BelId bel) const override
+    {
+        NPNR_ASSERT_FALSE("getBelIndex must be implemented when getBelCount is non-zero!");
+    }
 
     // Wire methods
     virtual IdString getWireType(WireId wire) const override { return IdString(); }
@@ -170,7 +178,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void bindWire(WireId wire, NetInfo *net, PlaceStrength strength) override
     {
         NPNR_ASSERT(wire != WireId());
-        auto &w2n_entry = base_wire2net[wire];
+        auto &w2n_entry = wire2net_entry(wire);
         NPNR_ASSERT(w2n_entry == nullptr);
         net->wires[wire].pip = PipId();
         net->wires[wire].strength = strength;
@@ -180,7 +188,7 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void unbindWire(WireId wire) override
     {
         NPNR_ASSERT(wire != WireId());
-        auto &w2n_entry = base_wire2net[wire];
+        auto &w2n_entry = wire2net_entry(wire);
         NPNR_ASSERT(w2n_entry != nullptr);
 
         auto &net_wires = w2n_entry->wires;
@@ -189,23 +197,29 @@ template <typename R> struct BaseArch : ArchAPI<R>
 
         auto pip = it->second.pip;
         if (pip != PipId()) {
-            base_pip2net[pip] = nullptr;
+            pip2net_entry(pip) = nullptr;
         }
 
         net_wires.erase(it);
-        base_wire2net[wire] = nullptr;
-
         w2n_entry = nullptr;
         this->refreshUiWire(wire);
     }
     virtual bool checkWireAvail(WireId wire) const override { return getBoundWireNet(wire) == nullptr; }
     virtual NetInfo *getBoundWireNet(WireId wire) const override
     {
+        if (!dense_wire2net.empty())
+            return dense_wire2net[this->getWireIndex(wire)];
         auto fnd = base_wire2net.find(wire);
         return fnd == base_wire2net.end() ? nullptr : fnd->second;
     }
     virtual WireId getConflictingWireWire(WireId wire) const override { return wire; };
     virtual NetInfo *getConflictingWireNet(WireId wire) const override { return getBoundWireNet(wire); }
+    // Dense wire indices are optional, a count of zero means that users must fall back to hashing WireId
+    virtual int getWireCount() const override { return 0; }
+    virtual int getWireIndex(WireId wire) const override
+    {
+        NPNR_ASSERT_FALSE("getWireIndex must be implemented when getWireCount is non-zero!");
+    }
 
     // Pip methods
     virtual IdString getPipType(PipId pip) const override { return IdString(); }
@@ -217,12 +231,12 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void bindPip(PipId pip, NetInfo *net, PlaceStrength strength) override
     {
         NPNR_ASSERT(pip != PipId());
-        auto &p2n_entry = base_pip2net[pip];
+        auto &p2n_entry = pip2net_entry(pip);
         NPNR_ASSERT(p2n_entry == nullptr);
         p2n_entry = net;
 
         WireId dst = this->getPipDstWire(pip);
-        auto &w2n_entry = base_wire2net[dst];
+        auto &w2n_entry = wire2net_entry(dst);
         NPNR_ASSERT(w2n_entry == nullptr);
         w2n_entry = net;
         net->wires[dst].pip = pip;
@@ -231,11 +245,11 @@ template <typename R> struct BaseArch : ArchAPI<R>
     virtual void unbindPip(PipId pip) override
     {
         NPNR_ASSERT(pip != PipId());
-        auto &p2n_entry = base_pip2net[pip];
+        auto &p2n_entry = pip2net_entry(pip);
         NPNR_ASSERT(p2n_entry != nullptr);
         WireId dst = this->getPipDstWire(pip);
 
-        auto &w2n_entry = base_wire2net[dst];
+        auto &w2n_entry = wire2net_entry(dst);
         NPNR_ASSERT(w2n_entry != nullptr);
         w2n_entry = nullptr;
 
@@ -250,11 +264,19 @@ template <typename R> struct BaseArch : ArchAPI<R>
     }
     virtual NetInfo *getBoundPipNet(PipId pip) const override
     {
+        if (!dense_pip2net.empty())
+            return dense_pip2net[this->getPipIndex(pip)];
         auto fnd = base_pip2net.find(pip);
         return fnd == base_pip2net.end() ? nullptr : fnd->second;
     }
     virtual WireId getConflictingPipWire(PipId pip) const override { return WireId(); }
     virtual NetInfo *getConflictingPipNet(PipId pip) const override { return getBoundPipNet(pip); }
+    // Dense pip indices are optional, a count of zero means that users must fall back to hashing PipId
+    virtual int getPipCount() const override { return 0; }
+    virtual int getPipIndex(PipId pip) const override
+    {
+        NPNR_ASSERT_FALSE("getPipIndex must be implemented when getPipCount is non-zero!");
+    }
 
     // Group methods
     virtual GroupId getGroupByName(IdStringList name) const override { return GroupId(); };
@@ -348,11 +370,35 @@ template <typename R> struct BaseArch : ArchAPI<R>
 
     // --------------------------------------------------------------
     // These structures are used to provide default implementations of bel/wire/pip binding. Arches might want to
-    // replace them with their own, for example to use faster access structures than unordered_map. Arches might also
-    // want to add extra checks around these functions
+    // replace them with their own, or add extra checks around these functions. When the arch provides dense indices
+    // (get{Bel,Wire,Pip}Count() is non-zero) the flat arrays are used, otherwise the hash maps. Each array is sized the
+    // first time the default binding of its kind is used, as the counts aren't available while BaseArch is being
+    // constructed, and so that arches that bind a kind of object themselves don't allocate an unused array. Until
+    // then nothing is bound and lookups see the empty maps.
     std::unordered_map<BelId, CellInfo *> base_bel2cell;
     std::unordered_map<WireId, NetInfo *> base_wire2net;
     std::unordered_map<PipId, NetInfo *> base_pip2net;
+    std::vector<CellInfo *> dense_bel2cell;
+    std::vector<NetInfo *> dense_wire2net, dense_pip2net;
+
+    CellInfo *&bel2cell_entry(BelId bel)
+    {
+        if (dense_bel2cell.empty() && this->getBelCount() > 0)
+            dense_bel2cell.resize(this->getBelCount());
+        return dense_bel2cell.empty() ? base_bel2cell[bel] : dense_bel2cell[this->getBelIndex(bel)];
+    }
+    NetInfo *&wire2net_entry(WireId wire)
+    {
+        if (dense_wire2net.empty() && this->getWireCount() > 0)
+            dense_wire2net.resize(this->getWireCount());
+        return dense_wire2net.empty() ? base_wire2net[wire] : dense_wire2net[this->getWireIndex(wire)];
+    }
+    NetInfo *&pip2net_entry(PipId pip)
+    {
+        if (dense_pip2net.empty() && this->getPipCount() > 0)
+            dense_pip2net.resize(this->getPipCount());
+        return dense_pip2net.empty() ? base_pip2net[pip] : dense_pip2net[this->getPipIndex(pip)];
+    }
 
     // For the default cell/bel bucket implementations
     std::vector<IdString> cell_types;
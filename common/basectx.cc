@@ -272,7 +272,7 @@ NetInfo *BaseCtx::createNet(IdString name)
 {
     NPNR_ASSERT(!nets.count(name));
     NPNR_ASSERT(!net_aliases.count(name));
-    std::unique_ptr<NetInfo> net{new NetInfo};
+    std::unique_ptr<NetInfo> net{new (this) NetInfo};
     net->name = name;
     net_aliases[name] = name;
     NetInfo *ptr = net.get();
@@ -313,7 +313,7 @@ void BaseCtx::lockNetRouting(IdString name)
 CellInfo *BaseCtx::createCell(IdString name, IdString type)
 {
     NPNR_ASSERT(!cells.count(name));
-    std::unique_ptr<CellInfo> cell{new CellInfo};
+    std::unique_ptr<CellInfo> cell{new (this) CellInfo};
     cell->name = name;
     cell->type = type;
     CellInfo *ptr = cell.get();
@@ -331,4 +331,33 @@ void BaseCtx::copyBelPorts(IdString cell, BelId bel)
     }
 }
 
+void BaseCtx::reportNetlistMemory() const
+{
+    size_t cell_ports = 0, cell_props = 0, net_users = 0, net_wires = 0, net_attrs = 0;
+    for (auto &cell : cells) {
+        cell_ports += cell.second->ports.memory_usage();
+        cell_props += cell.second->attrs.memory_usage() + cell.second->params.memory_usage();
+    }
+    for (auto &net : nets) {
+        net_users += net.second->users.capacity() * sizeof(PortRef);
+        net_wires += net.second->wires.memory_usage();
+        net_attrs += net.second->attrs.memory_usage();
+    }
+    size_t tables = cells.memory_usage() + nets.memory_usage() + net_aliases.memory_usage() + ports.memory_usage();
+    auto cell_slab = cell_pool.stats();
+    auto net_slab = net_pool.stats();
+    auto kib = [](size_t bytes) { return double(bytes) / 1024.0; };
+
+    log_info("Netlist memory usage:\n");
+    log_info("    %8d cells:   %10.1f KiB objects (%d/%d slab slots used), %.1f KiB ports, %.1f KiB attrs/params\n",
+             int(cells.size()), kib(cell_slab.bytes), int(cell_slab.live), int(cell_slab.capacity), kib(cell_ports),
+             kib(cell_props));
+    log_info("    %8d nets:    %10.1f KiB objects (%d/%d slab slots used), %.1f KiB users, %.1f KiB routing, "
+             "%.1f KiB attrs\n",
+             int(nets.size()), kib(net_slab.bytes), int(net_slab.live), int(net_slab.capacity), kib(net_users),
+             kib(net_wires), kib(net_attrs));
+    log_info("    %8d IdStrings: %8.1f KiB\n", idstring_db->size(), kib(idstring_db->memory_usage()));
+    log_info("    lookup tables: %10.1f KiB\n", kib(tables));
+}
+
 NEXTPNR_NAMESPACE_END
@@ -29,14 +29,17 @@
 #endif
 
 #include "idstring.h"
+#include "idstring_db.h"
 #include "nextpnr_namespaces.h"
 #include "nextpnr_types.h"
+#include "object_pool.h"
 #include "property.h"
 #include "str_ring_buffer.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
 struct Context;
+struct FastBelsIndex;
 
 struct BaseCtx
 {
@@ -52,36 +55,43 @@ struct BaseCtx
 #endif
 
     // ID String database.
-    mutable std::unordered_map<std::string, int> *idstring_str_to_idx;
-    mutable std::vector<const std::string *> *idstring_idx_to_str;
+    mutable IdStringDB *idstring_db;
 
     // Temporary string backing store for logging
     mutable StrRingBuffer log_strs;
 
     // Project settings and config switches
-    std::unordered_map<IdString, Property> settings;
+    dict<IdString, Property> settings;
+
+    // Slabs that nets and cells are allocated from. These must be declared before (and so destroyed after) the nets
+    // and cells themselves.
+    ObjectPool<NetInfo> net_pool;
+    ObjectPool<CellInfo> cell_pool;
 
     // Placed nets and cells.
-    std::unordered_map<IdString, std::unique_ptr<NetInfo>> nets;
-    std::unordered_map<IdString, std::unique_ptr<CellInfo>> cells;
+    dict<IdString, std::unique_ptr<NetInfo>> nets;
+    dict<IdString, std::unique_ptr<CellInfo>> cells;
 
     // Hierarchical (non-leaf) cells by full path
-    std::unordered_map<IdString, HierarchicalCell> hierarchy;
+    dict<IdString, HierarchicalCell> hierarchy;
     // This is the root of the above structure
     IdString top_module;
 
     // Aliases for nets, which may have more than one name due to assignments and hierarchy
-    std::unordered_map<IdString, IdString> net_aliases;
+    dict<IdString, IdString> net_aliases;
 
     // Top-level ports
-    std::unordered_map<IdString, PortInfo> ports;
-    std::unordered_map<IdString, CellInfo *> port_cells;
+    dict<IdString, PortInfo> ports;
+    dict<IdString, CellInfo *> port_cells;
 
     // Floorplanning regions
-    std::unordered_map<IdString, std::unique_ptr<Region>> region;
+    dict<IdString, std::unique_ptr<Region>> region;
 
     // Context meta data
-    std::unordered_map<IdString, Property> attrs;
+    dict<IdString, Property> attrs;
+
+    // Index of BELs by cell type and location shared by the placers, created on first use (see fast_bels.h)
+    std::shared_ptr<FastBelsIndex> fast_bels_index;
 
     Context *as_ctx = nullptr;
 
@@ -90,8 +100,7 @@ struct BaseCtx
 
     BaseCtx()
     {
-        idstring_str_to_idx = new std::unordered_map<std::string, int>;
-        idstring_idx_to_str = new std::vector<const std::string *>;
+        idstring_db = new IdStringDB;
         IdString::initialize_add(this, "", 0);
         IdString::initialize_arch(this);
 
@@ -100,8 +109,7 @@ struct BaseCtx
 
     virtual ~BaseCtx()
     {
-        delete idstring_str_to_idx;
-        delete idstring_idx_to_str;
+        delete idstring_db;
     }
 
     // Must be called before performing any mutating changes on the Ctx/Arch.
@@ -231,6 +239,9 @@ struct BaseCtx
 
     void archInfoToAttributes();
     void attributesToArchInfo();
+
+    // Log the memory used by the netlist, broken down by object type
+    void reportNetlistMemory() const;
 };
 
 NEXTPNR_NAMESPACE_END
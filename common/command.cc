@@ -139,6 +139,9 @@ po::options_description CommandHandler::getGeneralOptions()
                         "; default: " + Arch::defaultRouter)
                     .c_str());
 
+    general.add_options()("router-lookahead",
+                          "use a precomputed routing delay lookahead, cached on disk (ECP5, iCE40, Nexus)");
+
     general.add_options()("slack_redist_iter", po::value<int>(), "number of iterations between slack redistribution");
     general.add_options()("cstrweight", po::value<float>(), "placer weighting for relative constraint satisfaction");
     general.add_options()("starttemp", po::value<float>(), "placer SA start temperature");
@@ -245,6 +248,10 @@ void CommandHandler::setupContext(Context *ctx)
         ctx->settings[ctx->id("router")] = router;
     }
 
+    if (vm.count("router-lookahead")) {
+        ctx->settings[ctx->id("router/lookahead")] = true;
+    }
+
     if (vm.count("cstrweight")) {
         ctx->settings[ctx->id("placer1/constraintWeight")] = std::to_string(vm["cstrweight"].as<float>());
     }
@@ -371,6 +378,8 @@ int CommandHandler::executeMain(std::unique_ptr<Context> ctx)
         assign_budget(ctx.get());
         ctx->check();
         print_utilisation(ctx.get());
+        if (ctx->verbose)
+            ctx->reportNetlistMemory();
 
         if (do_place) {
             run_script_hook("pre-place");
@@ -25,23 +25,39 @@
 #include "util.h"
 NEXTPNR_NAMESPACE_BEGIN
 
+namespace {
+// Find the index of a cell port in the users of a net, trying the index recorded in the port first
+int find_user(const NetInfo *net, const CellInfo *cell, IdString port_name, int hint)
+{
+    auto is_port = [&](const PortRef &user) { return user.cell == cell && user.port == port_name; };
+    if (hint >= 0 && hint < int(net->users.size()) && is_port(net->users.at(hint)))
+        return hint;
+    auto found = std::find_if(net->users.begin(), net->users.end(), is_port);
+    return found == net->users.end() ? -1 : int(found - net->users.begin());
+}
+} // namespace
+
 void replace_port(CellInfo *old_cell, IdString old_name, CellInfo *rep_cell, IdString rep_name)
 {
     if (!old_cell->ports.count(old_name))
         return;
-    PortInfo &old = old_cell->ports.at(old_name);
 
     // Create port on the replacement cell if it doesn't already exist
     if (!rep_cell->ports.count(rep_name)) {
+        PortType type = old_cell->ports.at(old_name).type;
         rep_cell->ports[rep_name].name = rep_name;
-        rep_cell->ports[rep_name].type = old.type;
+        rep_cell->ports[rep_name].type = type;
     }
 
+    // Adding a port may move the other ports of the cell, so only take references now
+    PortInfo &old = old_cell->ports.at(old_name);
     PortInfo &rep = rep_cell->ports.at(rep_name);
     NPNR_ASSERT(old.type == rep.type);
 
     rep.net = old.net;
     old.net = nullptr;
+    int old_user_idx = old.user_idx;
+    old.user_idx = -1;
     if (rep.type == PORT_OUT) {
         if (rep.net != nullptr) {
             rep.net->driver.cell = rep_cell;
@@ -49,12 +65,13 @@ void replace_port(CellInfo *old_cell, IdString old_name, CellInfo *rep_cell, IdS
         }
     } else if (rep.type == PORT_IN) {
         if (rep.net != nullptr) {
-            for (PortRef &load : rep.net->users) {
-                if (load.cell == old_cell && load.port == old_name) {
-                    load.cell = rep_cell;
-                    load.port = rep_name;
-                }
+            int idx = find_user(rep.net, old_cell, old_name, old_user_idx);
+            if (idx != -1) {
+                PortRef &load = rep.net->users.at(idx);
+                load.cell = rep_cell;
+                load.port = rep_name;
             }
+            rep.user_idx = idx;
         }
     } else {
         NPNR_ASSERT(false);
@@ -101,6 +118,7 @@ void connect_port(const Context *ctx, NetInfo *net, CellInfo *cell, IdString por
         PortRef user;
         user.cell = cell;
         user.port = port_name;
+        port.user_idx = int(net->users.size());
         net->users.push_back(user);
     } else {
         NPNR_ASSERT_FALSE("invalid port type for connect_port");
@@ -113,11 +131,19 @@ void disconnect_port(const Context *ctx, CellInfo *cell, IdString port_name)
         return;
     PortInfo &port = cell->ports.at(port_name);
     if (port.net != nullptr) {
-        port.net->users.erase(std::remove_if(port.net->users.begin(), port.net->users.end(),
-                                             [cell, port_name](const PortRef &user) {
-                                                 return user.cell == cell && user.port == port_name;
-                                             }),
-                              port.net->users.end());
+        auto &users = port.net->users;
+        int idx = find_user(port.net, cell, port_name, port.user_idx);
+        if (idx != -1) {
+            // Swap the last user into the removed slot, so removal doesn't have to shift the whole list
+            if (idx != int(users.size()) - 1) {
+                users.at(idx) = users.back();
+                auto moved = users.at(idx).cell->ports.find(users.at(idx).port);
+                if (moved != users.at(idx).cell->ports.end())
+                    moved->second.user_idx = idx;
+            }
+            users.pop_back();
+        }
+        port.user_idx = -1;
         if (port.net->driver.cell == cell && port.net->driver.port == port_name)
             port.net->driver.cell = nullptr;
         port.net = nullptr;
@@ -129,7 +155,7 @@ void connect_ports(Context *ctx, CellInfo *cell1, IdString port1_name, CellInfo
     PortInfo &port1 = cell1->ports.at(port1_name);
     if (port1.net == nullptr) {
         // No net on port1; need to create one
-        std::unique_ptr<NetInfo> p1net(new NetInfo());
+        std::unique_ptr<NetInfo> p1net(new (ctx) NetInfo());
         p1net->name = ctx->id(cell1->name.str(ctx) + "$conn$" + port1_name.str(ctx));
         connect_port(ctx, p1net.get(), cell1, port1_name);
         IdString p1name = p1net->name;
@@ -147,9 +173,10 @@ void rename_port(Context *ctx, CellInfo *cell, IdString old_name, IdString new_n
     if (pi.net != nullptr) {
         if (pi.net->driver.cell == cell && pi.net->driver.port == old_name)
             pi.net->driver.port = new_name;
-        for (auto &usr : pi.net->users)
-            if (usr.cell == cell && usr.port == old_name)
-                usr.port = new_name;
+        int idx = find_user(pi.net, cell, old_name, pi.user_idx);
+        if (idx != -1)
+            pi.net->users.at(idx).port = new_name;
+        pi.user_idx = idx;
     }
     cell->ports.erase(old_name);
     pi.name = new_name;
@@ -161,9 +188,11 @@ void rename_net(Context *ctx, NetInfo *net, IdString new_name)
     if (net == nullptr)
         return;
     NPNR_ASSERT(!ctx->nets.count(new_name));
-    std::swap(ctx->nets[net->name], ctx->nets[new_name]);
+    // Inserting into the dict may move its entries, so take the net out before adding it under the new name
+    std::unique_ptr<NetInfo> ptr = std::move(ctx->nets.at(net->name));
     ctx->nets.erase(net->name);
     net->name = new_name;
+    ctx->nets.emplace(new_name, std::move(ptr));
 }
 
 void replace_bus(Context *ctx, CellInfo *old_cell, IdString old_name, int old_offset, bool old_brackets,
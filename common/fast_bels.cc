@@ -0,0 +1,94 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "fast_bels.h"
+#include "nextpnr.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+FastBelsIndex &FastBelsIndex::get(Context *ctx)
+{
+    if (ctx->fast_bels_index == nullptr)
+        ctx->fast_bels_index = std::make_shared<FastBelsIndex>(ctx);
+    return *ctx->fast_bels_index;
+}
+
+void FastBelsIndex::add_bel(TypeBels &type_bels, BelId bel, Loc loc)
+{
+    type_bels.bels.push_back(bel);
+    auto &grid = type_bels.grid;
+    if (int(grid.size()) < (loc.x + 1))
+        grid.resize(loc.x + 1);
+    if (int(grid.at(loc.x).size()) < (loc.y + 1))
+        grid.at(loc.x).resize(loc.y + 1);
+    grid.at(loc.x).at(loc.y).push_back(bel);
+}
+
+FastBelsIndex::TypeBels &FastBelsIndex::getCellType(IdString cell_type)
+{
+    auto found = cell_types.find(cell_type);
+    if (found != cell_types.end())
+        return *found->second;
+
+    // Add all the cell types in the design that aren't yet in the index, so there is only one pass over the BELs
+    std::vector<std::pair<IdString, TypeBels *>> new_types;
+    auto add_type = [&](IdString type) {
+        auto &entry = cell_types[type];
+        if (entry != nullptr)
+            return;
+        entry = std::make_unique<TypeBels>();
+        new_types.emplace_back(type, entry.get());
+    };
+    add_type(cell_type);
+    for (auto &cell : ctx->cells)
+        add_type(cell.second->type);
+
+    for (auto bel : ctx->getBels()) {
+        Loc loc = ctx->getBelLocation(bel);
+        for (auto &type : new_types)
+            if (ctx->isValidBelForCellType(type.first, bel))
+                add_bel(*type.second, bel, loc);
+    }
+    return *cell_types.at(cell_type);
+}
+
+FastBelsIndex::TypeBels &FastBelsIndex::getBelBucket(BelBucketId bucket)
+{
+    auto found = bel_buckets.find(bucket);
+    if (found != bel_buckets.end())
+        return *found->second;
+
+    // Every BEL is in exactly one bucket, so add all of them at once
+    bel_buckets[bucket] = std::make_unique<TypeBels>();
+    std::unordered_set<BelBucketId> new_buckets{bucket};
+    for (auto bel : ctx->getBels()) {
+        BelBucketId bel_bucket = ctx->getBelBucketForBel(bel);
+        auto &entry = bel_buckets[bel_bucket];
+        if (entry == nullptr) {
+            entry = std::make_unique<TypeBels>();
+            new_buckets.insert(bel_bucket);
+        } else if (!new_buckets.count(bel_bucket)) {
+            continue;
+        }
+        add_bel(*entry, bel, ctx->getBelLocation(bel));
+    }
+    return *bel_buckets.at(bucket);
+}
+
+NEXTPNR_NAMESPACE_END
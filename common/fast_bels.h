@@ -25,8 +25,45 @@
 
 NEXTPNR_NAMESPACE_BEGIN
 
+// FastBelsIndex holds the BELs that support each cell type and BEL bucket, both in the order of getBels() and by
+// location. It is built once per context (the first time a placer asks for it) and shared by all users of FastBels,
+// so that each placer doesn't have to scan every BEL of the device again for every cell type.
+struct FastBelsIndex
+{
+    typedef std::vector<std::vector<std::vector<BelId>>> BelGrid;
+
+    struct TypeBels
+    {
+        // All BELs of this type, in the order of getBels()
+        std::vector<BelId> bels;
+        // All BELs of this type by location
+        BelGrid grid;
+    };
+
+    explicit FastBelsIndex(Context *ctx) : ctx(ctx) {}
+
+    // Get the index of a context, creating it if needed
+    static FastBelsIndex &get(Context *ctx);
+
+    // Get the BELs of a cell type or BEL bucket. The first call for a cell type that isn't yet in the index adds all
+    // the cell types used in the design in a single pass over the BELs, likewise for BEL buckets
+    TypeBels &getCellType(IdString cell_type);
+    TypeBels &getBelBucket(BelBucketId bucket);
+
+    Context *ctx;
+    std::unordered_map<IdString, std::unique_ptr<TypeBels>> cell_types;
+    std::unordered_map<BelBucketId, std::unique_ptr<TypeBels>> bel_buckets;
+
+  private:
+    void add_bel(TypeBels &type_bels, BelId bel, Loc loc);
+};
+
 // FastBels is a lookup class that provides a fast lookup for finding BELs
 // that support a given cell type.
+//
+// It is a view of the shared FastBelsIndex. With check_bel_available, the BELs of a cell type are the ones that were
+// free when the type was added; the placers rely on this, as they rip up cells they placed themselves. If a cell type
+// has fewer than minBelsForGridPick BELs, all of them are put at location (0, 0).
 struct FastBels
 {
     struct TypeData
@@ -35,8 +72,11 @@ struct FastBels
         int number_of_possible_bels;
     };
 
+    typedef FastBelsIndex::BelGrid FastBelsData;
+
     FastBels(Context *ctx, bool check_bel_available, int minBelsForGridPick)
-            : ctx(ctx), check_bel_available(check_bel_available), minBelsForGridPick(minBelsForGridPick)
+            : ctx(ctx), index(FastBelsIndex::get(ctx)), check_bel_available(check_bel_available),
+              minBelsForGridPick(minBelsForGridPick)
     {
     }
 
@@ -52,43 +92,9 @@ struct FastBels
         auto &cell_type_data = cell_types[cell_type];
         cell_type_data.type_index = type_idx;
 
-        fast_bels_by_cell_type.resize(type_idx + 1);
-        auto &bel_data = fast_bels_by_cell_type.at(type_idx);
-        NPNR_ASSERT(bel_data.get() == nullptr);
-        bel_data = std::make_unique<FastBelsData>();
-
-        for (auto bel : ctx->getBels()) {
-            if (!ctx->isValidBelForCellType(cell_type, bel)) {
-                continue;
-            }
-
-            cell_type_data.number_of_possible_bels += 1;
-        }
-
-        for (auto bel : ctx->getBels()) {
-            if (check_bel_available && !ctx->checkBelAvail(bel)) {
-                continue;
-            }
-
-            if (!ctx->isValidBelForCellType(cell_type, bel)) {
-                continue;
-            }
-
-            Loc loc = ctx->getBelLocation(bel);
-            if (minBelsForGridPick >= 0 && cell_type_data.number_of_possible_bels < minBelsForGridPick) {
-                loc.x = loc.y = 0;
-            }
-
-            if (int(bel_data->size()) < (loc.x + 1)) {
-                bel_data->resize(loc.x + 1);
-            }
-
-            if (int(bel_data->at(loc.x).size()) < (loc.y + 1)) {
-                bel_data->at(loc.x).resize(loc.y + 1);
-            }
-
-            bel_data->at(loc.x).at(loc.y).push_back(bel);
-        }
+        auto &type_bels = index.getCellType(cell_type);
+        cell_type_data.number_of_possible_bels = int(type_bels.bels.size());
+        fast_bels_by_cell_type.push_back(make_view(type_bels, cell_type_data.number_of_possible_bels));
     }
 
     void addBelBucket(BelBucketId partition)
@@ -103,47 +109,11 @@ struct FastBels
         auto &type_data = partition_types[partition];
         type_data.type_index = type_idx;
 
-        fast_bels_by_partition_type.resize(type_idx + 1);
-        auto &bel_data = fast_bels_by_partition_type.at(type_idx);
-        NPNR_ASSERT(bel_data.get() == nullptr);
-        bel_data = std::make_unique<FastBelsData>();
-
-        for (auto bel : ctx->getBels()) {
-            if (ctx->getBelBucketForBel(bel) != partition) {
-                continue;
-            }
-
-            type_data.number_of_possible_bels += 1;
-        }
-
-        for (auto bel : ctx->getBels()) {
-            if (check_bel_available && !ctx->checkBelAvail(bel)) {
-                continue;
-            }
-
-            if (ctx->getBelBucketForBel(bel) != partition) {
-                continue;
-            }
-
-            Loc loc = ctx->getBelLocation(bel);
-            if (minBelsForGridPick >= 0 && type_data.number_of_possible_bels < minBelsForGridPick) {
-                loc.x = loc.y = 0;
-            }
-
-            if (int(bel_data->size()) < (loc.x + 1)) {
-                bel_data->resize(loc.x + 1);
-            }
-
-            if (int(bel_data->at(loc.x).size()) < (loc.y + 1)) {
-                bel_data->at(loc.x).resize(loc.y + 1);
-            }
-
-            bel_data->at(loc.x).at(loc.y).push_back(bel);
-        }
+        auto &type_bels = index.getBelBucket(partition);
+        type_data.number_of_possible_bels = int(type_bels.bels.size());
+        fast_bels_by_partition_type.push_back(make_view(type_bels, type_data.number_of_possible_bels));
     }
 
-    typedef std::vector<std::vector<std::vector<BelId>>> FastBelsData;
-
     int getBelsForCellType(IdString cell_type, FastBelsData **data)
     {
         auto iter = cell_types.find(cell_type);
@@ -155,7 +125,7 @@ struct FastBels
 
         auto cell_type_data = iter->second;
 
-        *data = fast_bels_by_cell_type.at(cell_type_data.type_index).get();
+        *data = fast_bels_by_cell_type.at(cell_type_data.type_index);
         return cell_type_data.number_of_possible_bels;
     }
 
@@ -170,19 +140,52 @@ struct FastBels
 
         auto type_data = iter->second;
 
-        *data = fast_bels_by_partition_type.at(type_data.type_index).get();
+        *data = fast_bels_by_partition_type.at(type_data.type_index);
         return type_data.number_of_possible_bels;
     }
 
     Context *ctx;
+    FastBelsIndex &index;
     const bool check_bel_available;
     const int minBelsForGridPick;
 
     std::unordered_map<IdString, TypeData> cell_types;
-    std::vector<std::unique_ptr<FastBelsData>> fast_bels_by_cell_type;
+    std::vector<FastBelsData *> fast_bels_by_cell_type;
 
     std::unordered_map<BelBucketId, TypeData> partition_types;
-    std::vector<std::unique_ptr<FastBelsData>> fast_bels_by_partition_type;
+    std::vector<FastBelsData *> fast_bels_by_partition_type;
+
+  private:
+    // Views that can't point straight into the index
+    std::vector<std::unique_ptr<FastBelsData>> owned_data;
+
+    FastBelsData *make_view(FastBelsIndex::TypeBels &type_bels, int number_of_possible_bels)
+    {
+        bool collapse = minBelsForGridPick >= 0 && number_of_possible_bels < minBelsForGridPick;
+        if (!check_bel_available && !collapse)
+            return &type_bels.grid;
+        owned_data.push_back(std::make_unique<FastBelsData>());
+        FastBelsData *bel_data = owned_data.back().get();
+        if (collapse) {
+            for (auto bel : type_bels.bels) {
+                if (check_bel_available && !ctx->checkBelAvail(bel))
+                    continue;
+                if (bel_data->empty())
+                    bel_data->resize(1, std::vector<std::vector<BelId>>(1));
+                bel_data->at(0).at(0).push_back(bel);
+            }
+        } else {
+            bel_data->resize(type_bels.grid.size());
+            for (size_t x = 0; x < type_bels.grid.size(); x++) {
+                bel_data->at(x).resize(type_bels.grid.at(x).size());
+                for (size_t y = 0; y < type_bels.grid.at(x).size(); y++)
+                    for (auto bel : type_bels.grid.at(x).at(y))
+                        if (ctx->checkBelAvail(bel))
+                            bel_data->at(x).at(y).push_back(bel);
+            }
+        }
+        return bel_data;
+    }
 };
 
 NEXTPNR_NAMESPACE_END
@@ -28,7 +28,16 @@
 #include <unordered_set>
 #endif
 
+#include <algorithm>
 #include <boost/functional/hash.hpp>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "nextpnr_namespaces.h"
 
@@ -47,6 +56,448 @@ template <typename Value, typename Hash = std::hash<Value>> using HashSet = std:
 
 }; // namespace HashTables
 
+namespace HashTableDetail {
+
+// Spread a std::hash result over 32 bits (Fibonacci hashing), so that the identity hashes used for IdString and many
+// of the arch-specific ids still distribute well when the top bits pick the slot
+inline uint32_t mix_hash(std::size_t h)
+{
+    uint64_t x = uint64_t(h) ^ (uint64_t(h) >> 32);
+    return uint32_t((x * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+/*
+Core of dict and pool: entries are kept densely in insertion order, and an open-addressed (linear probing) table of
+entry indices is used for lookup. Erasing only marks the entry as dead; dead entries are skipped when iterating and
+compacted away during a later insertion once they outnumber the live ones.
+*/
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename KeyEqual> class OrderedTable
+{
+  public:
+    struct Entry
+    {
+        Value udata;
+        uint32_t hash;
+        bool live;
+        template <typename... Args>
+        explicit Entry(uint32_t hash, Args &&... args) : udata(std::forward<Args>(args)...), hash(hash), live(true)
+        {
+        }
+    };
+
+    std::vector<Entry> entries;
+    // Indices into entries, or -1 for an empty slot; the size is always zero or a power of two
+    std::vector<int32_t> slots;
+    int shift = 32;
+    std::size_t live_count = 0;
+
+    OrderedTable() = default;
+    OrderedTable(const OrderedTable &other) = default;
+    OrderedTable(OrderedTable &&other) = default;
+    // Entries have a const key, so they can be copy constructed but not assigned
+    OrderedTable &operator=(OrderedTable other)
+    {
+        entries.swap(other.entries);
+        slots.swap(other.slots);
+        std::swap(shift, other.shift);
+        std::swap(live_count, other.live_count);
+        return *this;
+    }
+
+    uint32_t do_hash(const Key &key) const { return mix_hash(Hash()(key)); }
+    std::size_t home_slot(uint32_t hash) const { return std::size_t(hash >> shift); }
+
+    int find_slot(const Key &key, uint32_t hash) const
+    {
+        if (slots.empty())
+            return -1;
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t s = home_slot(hash);; s = (s + 1) & mask) {
+            int32_t e = slots[s];
+            if (e == -1)
+                return -1;
+            if (entries[e].hash == hash && KeyEqual()(KeyOf()(entries[e].udata), key))
+                return int(s);
+        }
+    }
+
+    int find_entry(const Key &key) const
+    {
+        int s = find_slot(key, do_hash(key));
+        return s == -1 ? -1 : slots[s];
+    }
+
+    void insert_slot(int32_t e)
+    {
+        std::size_t mask = slots.size() - 1;
+        std::size_t s = home_slot(entries[e].hash);
+        while (slots[s] != -1)
+            s = (s + 1) & mask;
+        slots[s] = e;
+    }
+
+    void rebuild_slots(std::size_t n_slots)
+    {
+        slots.assign(n_slots, -1);
+        shift = 32;
+        for (std::size_t n = n_slots; n > 1; n >>= 1)
+            --shift;
+        for (std::size_t i = 0; i < entries.size(); i++)
+            if (entries[i].live)
+                insert_slot(int32_t(i));
+    }
+
+    void compact()
+    {
+        std::vector<Entry> live_entries;
+        live_entries.reserve(live_count);
+        for (auto &e : entries)
+            if (e.live)
+                live_entries.push_back(std::move(e));
+        entries.swap(live_entries);
+    }
+
+    // Make room for one more entry; this is the only place where iterators and references are invalidated
+    void prepare_insert()
+    {
+        bool dead_heavy = (entries.size() - live_count) > std::max<std::size_t>(live_count, 8);
+        if (dead_heavy)
+            compact();
+        if ((live_count + 1) * 2 > slots.size())
+            rebuild_slots(std::max<std::size_t>(16, slots.size() * 2));
+        else if (dead_heavy)
+            rebuild_slots(slots.size());
+    }
+
+    template <typename... Args> int32_t append(uint32_t hash, Args &&... args)
+    {
+        prepare_insert();
+        int32_t e = int32_t(entries.size());
+        entries.emplace_back(hash, std::forward<Args>(args)...);
+        insert_slot(e);
+        ++live_count;
+        return e;
+    }
+
+    // Remove the slot of an entry by backward-shift deletion, so that no tombstones are needed in the slot table
+    void erase_slot(std::size_t s)
+    {
+        std::size_t mask = slots.size() - 1;
+        for (std::size_t j = (s + 1) & mask; slots[j] != -1; j = (j + 1) & mask) {
+            std::size_t home = home_slot(entries[slots[j]].hash);
+            if (((j - home) & mask) >= ((j - s) & mask)) {
+                slots[s] = slots[j];
+                s = j;
+            }
+        }
+        slots[s] = -1;
+    }
+
+    // Returns the index of the dead entry, or -1 if the key wasn't present
+    int erase_key(const Key &key)
+    {
+        int s = find_slot(key, do_hash(key));
+        if (s == -1)
+            return -1;
+        int32_t e = slots[s];
+        erase_slot(s);
+        entries[e].live = false;
+        --live_count;
+        return e;
+    }
+
+    int next_live(int i) const
+    {
+        while (i < int(entries.size()) && !entries[i].live)
+            ++i;
+        return i;
+    }
+
+    void reserve(std::size_t n)
+    {
+        entries.reserve(n);
+        std::size_t n_slots = 16;
+        while (n_slots < n * 2)
+            n_slots *= 2;
+        if (n_slots > slots.size())
+            rebuild_slots(n_slots);
+    }
+
+    std::size_t memory_usage() const
+    {
+        return entries.capacity() * sizeof(Entry) + slots.capacity() * sizeof(int32_t);
+    }
+
+    void clear()
+    {
+        entries.clear();
+        slots.clear();
+        shift = 32;
+        live_count = 0;
+    }
+};
+
+template <typename Table, typename Value, bool IsConst> class OrderedIterator
+{
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename std::remove_const<Value>::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<IsConst, const value_type *, value_type *>::type pointer;
+    typedef typename std::conditional<IsConst, const value_type &, value_type &>::type reference;
+    typedef typename std::conditional<IsConst, const Table *, Table *>::type table_ptr;
+
+    OrderedIterator() : table(nullptr), index(0){};
+    OrderedIterator(table_ptr table, int index) : table(table), index(index){};
+    // Allow iterator to const_iterator conversion
+    template <bool WasConst, typename = typename std::enable_if<IsConst && !WasConst>::type>
+    OrderedIterator(const OrderedIterator<Table, Value, WasConst> &other) : table(other.table), index(other.index){};
+
+    reference operator*() const { return table->entries[index].udata; }
+    pointer operator->() const { return &table->entries[index].udata; }
+    OrderedIterator &operator++()
+    {
+        index = table->next_live(index + 1);
+        return *this;
+    }
+    OrderedIterator operator++(int)
+    {
+        OrderedIterator prev = *this;
+        ++*this;
+        return prev;
+    }
+    bool operator==(const OrderedIterator &other) const { return index == other.index; }
+    bool operator!=(const OrderedIterator &other) const { return index != other.index; }
+
+    table_ptr table;
+    int index;
+};
+
+template <typename Key, typename T> struct FirstOf
+{
+    const Key &operator()(const std::pair<const Key, T> &kv) const { return kv.first; }
+};
+
+template <typename Key> struct Identity
+{
+    const Key &operator()(const Key &k) const { return k; }
+};
+
+} // namespace HashTableDetail
+
+/*
+dict and pool are drop-in replacements for std::unordered_map and std::unordered_set, used for the core netlist
+structures. They differ from the standard containers in two ways:
+ - iteration is in insertion order (erased entries are skipped, and the order of the rest is kept), so results never
+   depend on the standard library's hashing and bucket layout;
+ - elements are stored in a vector, so references are not stable the way they are for the node-based containers.
+
+Iterator and reference invalidation:
+ - insertion (operator[] on a missing key, insert, emplace) may invalidate all iterators and references, as the entry
+   vector can grow or be compacted to drop erased entries. Growing the lookup table alone never moves elements, so
+   after reserve(n) references stay valid across insertions until the table has seen n insertions in total, provided
+   nothing has been erased in the meantime (erasing makes a later insertion free to compact);
+ - erase only invalidates iterators and references to the erased element, so erasing while iterating is fine, using
+   the iterator returned by erase(pos);
+ - lookups, operator[] on an existing key, and iteration never invalidate anything;
+ - clear, assignment, reserve and swap invalidate all iterators and references.
+*/
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>> class dict
+{
+    typedef HashTableDetail::OrderedTable<Key, std::pair<const Key, T>, HashTableDetail::FirstOf<Key, T>, Hash,
+                                          KeyEqual>
+            table_t;
+    table_t table;
+
+  public:
+    typedef Key key_type;
+    typedef T mapped_type;
+    typedef std::pair<const Key, T> value_type;
+    typedef std::size_t size_type;
+    typedef HashTableDetail::OrderedIterator<table_t, value_type, false> iterator;
+    typedef HashTableDetail::OrderedIterator<table_t, value_type, true> const_iterator;
+
+    dict(){};
+    template <typename InputIt> dict(InputIt first, InputIt last) { insert(first, last); }
+    dict(std::initializer_list<value_type> init) { insert(init.begin(), init.end()); }
+
+    iterator begin() { return iterator(&table, table.next_live(0)); }
+    iterator end() { return iterator(&table, int(table.entries.size())); }
+    const_iterator begin() const { return const_iterator(&table, table.next_live(0)); }
+    const_iterator end() const { return const_iterator(&table, int(table.entries.size())); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    size_type size() const { return table.live_count; }
+    bool empty() const { return table.live_count == 0; }
+    void clear() { table.clear(); }
+    void reserve(size_type n) { table.reserve(n); }
+    void swap(dict &other) { std::swap(table, other.table); }
+    // Bytes of heap storage used by the table itself, excluding anything owned by the keys and values
+    size_type memory_usage() const { return table.memory_usage(); }
+
+    iterator find(const Key &key)
+    {
+        int e = table.find_entry(key);
+        return e == -1 ? end() : iterator(&table, e);
+    }
+    const_iterator find(const Key &key) const
+    {
+        int e = table.find_entry(key);
+        return e == -1 ? end() : const_iterator(&table, e);
+    }
+    size_type count(const Key &key) const { return table.find_entry(key) == -1 ? 0 : 1; }
+
+    T &at(const Key &key)
+    {
+        int e = table.find_entry(key);
+        if (e == -1)
+            throw std::out_of_range("dict::at()");
+        return table.entries[e].udata.second;
+    }
+    const T &at(const Key &key) const
+    {
+        int e = table.find_entry(key);
+        if (e == -1)
+            throw std::out_of_range("dict::at()");
+        return table.entries[e].udata.second;
+    }
+
+    T &operator[](const Key &key)
+    {
+        uint32_t hash = table.do_hash(key);
+        int s = table.find_slot(key, hash);
+        if (s != -1)
+            return table.entries[table.slots[s]].udata.second;
+        return table.entries[table.append(hash, std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>())]
+                .udata.second;
+    }
+
+    template <typename... Args> std::pair<iterator, bool> emplace(const Key &key, Args &&... args)
+    {
+        uint32_t hash = table.do_hash(key);
+        int s = table.find_slot(key, hash);
+        if (s != -1)
+            return std::make_pair(iterator(&table, table.slots[s]), false);
+        int e = table.append(hash, std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args)...));
+        return std::make_pair(iterator(&table, e), true);
+    }
+    std::pair<iterator, bool> insert(const value_type &value) { return emplace(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type &&value) { return emplace(value.first, std::move(value.second)); }
+    // The hint is ignored; this is only for std::inserter
+    iterator insert(const_iterator hint, const value_type &value) { return insert(value).first; }
+    template <typename InputIt> void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+            emplace(first->first, first->second);
+    }
+
+    size_type erase(const Key &key)
+    {
+        int e = table.erase_key(key);
+        if (e == -1)
+            return 0;
+        // Release the value now; key may refer into it, so this is the last thing done
+        table.entries[e].udata.second = T();
+        return 1;
+    }
+    iterator erase(const_iterator pos)
+    {
+        int next = table.next_live(pos.index + 1);
+        erase(table.entries[pos.index].udata.first);
+        return iterator(&table, next);
+    }
+
+    bool operator==(const dict &other) const
+    {
+        if (size() != other.size())
+            return false;
+        for (auto &kv : *this) {
+            auto found = other.find(kv.first);
+            if (found == other.end() || !(found->second == kv.second))
+                return false;
+        }
+        return true;
+    }
+    bool operator!=(const dict &other) const { return !(*this == other); }
+};
+
+template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>> class pool
+{
+    typedef HashTableDetail::OrderedTable<Key, Key, HashTableDetail::Identity<Key>, Hash, KeyEqual> table_t;
+    table_t table;
+
+  public:
+    typedef Key key_type;
+    typedef Key value_type;
+    typedef std::size_t size_type;
+    // Elements of a pool can't be modified in place, as that would change their hash
+    typedef HashTableDetail::OrderedIterator<table_t, const Key, true> iterator;
+    typedef iterator const_iterator;
+
+    pool(){};
+    template <typename InputIt> pool(InputIt first, InputIt last) { insert(first, last); }
+    pool(std::initializer_list<Key> init) { insert(init.begin(), init.end()); }
+
+    iterator begin() const { return iterator(&table, table.next_live(0)); }
+    iterator end() const { return iterator(&table, int(table.entries.size())); }
+    iterator cbegin() const { return begin(); }
+    iterator cend() const { return end(); }
+
+    size_type size() const { return table.live_count; }
+    bool empty() const { return table.live_count == 0; }
+    void clear() { table.clear(); }
+    void reserve(size_type n) { table.reserve(n); }
+    void swap(pool &other) { std::swap(table, other.table); }
+    size_type memory_usage() const { return table.memory_usage(); }
+
+    iterator find(const Key &key) const
+    {
+        int e = table.find_entry(key);
+        return e == -1 ? end() : iterator(&table, e);
+    }
+    size_type count(const Key &key) const { return table.find_entry(key) == -1 ? 0 : 1; }
+
+    std::pair<iterator, bool> insert(const Key &key)
+    {
+        uint32_t hash = table.do_hash(key);
+        int s = table.find_slot(key, hash);
+        if (s != -1)
+            return std::make_pair(iterator(&table, table.slots[s]), false);
+        return std::make_pair(iterator(&table, table.append(hash, key)), true);
+    }
+    iterator insert(iterator hint, const Key &key) { return insert(key).first; }
+    template <typename InputIt> void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+            insert(*first);
+    }
+    template <typename... Args> std::pair<iterator, bool> emplace(Args &&... args)
+    {
+        return insert(Key(std::forward<Args>(args)...));
+    }
+
+    size_type erase(const Key &key) { return table.erase_key(key) == -1 ? 0 : 1; }
+    iterator erase(iterator pos)
+    {
+        int next = table.next_live(pos.index + 1);
+        table.erase_key(table.entries[pos.index].udata);
+        return iterator(&table, next);
+    }
+
+    bool operator==(const pool &other) const
+    {
+        if (size() != other.size())
+            return false;
+        for (auto &k : *this)
+            if (!other.count(k))
+                return false;
+        return true;
+    }
+    bool operator!=(const pool &other) const { return !(*this == other); }
+};
+
 struct PairHash
 {
     template <typename T1, typename T2> std::size_t operator()(const std::pair<T1, T2> &idp) const noexcept
@@ -24,28 +24,22 @@
 
 NEXTPNR_NAMESPACE_BEGIN
 
-void IdString::set(const BaseCtx *ctx, const std::string &s)
+void IdString::set(const BaseCtx *ctx, const std::string &s) { index = ctx->idstring_db->intern(s); }
+
+const std::string &IdString::str(const BaseCtx *ctx) const
 {
-    auto it = ctx->idstring_str_to_idx->find(s);
-    if (it == ctx->idstring_str_to_idx->end()) {
-        index = ctx->idstring_idx_to_str->size();
-        auto insert_rc = ctx->idstring_str_to_idx->insert({s, index});
-        ctx->idstring_idx_to_str->push_back(&insert_rc.first->first);
-    } else {
-        index = it->second;
-    }
+    NPNR_ASSERT(index >= 0 && index < ctx->idstring_db->size());
+    return ctx->idstring_db->str(index);
 }
 
-const std::string &IdString::str(const BaseCtx *ctx) const { return *ctx->idstring_idx_to_str->at(index); }
-
 const char *IdString::c_str(const BaseCtx *ctx) const { return str(ctx).c_str(); }
 
 void IdString::initialize_add(const BaseCtx *ctx, const char *s, int idx)
 {
-    NPNR_ASSERT(ctx->idstring_str_to_idx->count(s) == 0);
-    NPNR_ASSERT(int(ctx->idstring_idx_to_str->size()) == idx);
-    auto insert_rc = ctx->idstring_str_to_idx->insert({s, idx});
-    ctx->idstring_idx_to_str->push_back(&insert_rc.first->first);
+    NPNR_ASSERT(ctx->idstring_db->size() == idx);
+    int new_idx = ctx->idstring_db->intern(s);
+    // Each string must only be added once
+    NPNR_ASSERT(new_idx == idx);
 }
 
 NEXTPNR_NAMESPACE_END
@@ -0,0 +1,153 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "idstring_db.h"
+
+#include <algorithm>
+
+#include "hash_table.h"
+#include "nextpnr_assertions.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+IdStringDB::IdStringDB() : chunks(nullptr), chunk_slots(0), next_index(0)
+{
+    std::lock_guard<std::mutex> lock(chunk_mutex);
+    grow_chunk_table(initial_chunk_slots);
+}
+
+IdStringDB::~IdStringDB()
+{
+    int count = next_index.load();
+    std::atomic<std::string *> *table = chunks.load();
+    for (int i = 0; i < chunk_slots.load(); i++) {
+        std::string *chunk = table[i].load();
+        if (chunk == nullptr)
+            break;
+        int in_chunk = std::min(count - (i << chunk_bits), chunk_mask + 1);
+        for (int j = 0; j < in_chunk; j++)
+            chunk[j].~basic_string();
+        ::operator delete(chunk);
+    }
+}
+
+uint32_t IdStringDB::do_hash(const std::string &s) { return HashTableDetail::mix_hash(std::hash<std::string>()(s)); }
+
+// Must be called with chunk_mutex held
+void IdStringDB::grow_chunk_table(int min_slots)
+{
+    int old_slots = chunk_slots.load(std::memory_order_relaxed);
+    int new_slots = std::max(initial_chunk_slots, 2 * old_slots);
+    while (new_slots < min_slots)
+        new_slots *= 2;
+    new_slots = std::min(new_slots, max_chunks);
+    std::unique_ptr<std::atomic<std::string *>[]> table(new std::atomic<std::string *>[new_slots]);
+    std::atomic<std::string *> *old_table = chunks.load(std::memory_order_relaxed);
+    for (int i = 0; i < new_slots; i++)
+        table[i].store((i < old_slots) ? old_table[i].load(std::memory_order_relaxed) : nullptr,
+                       std::memory_order_relaxed);
+    // Publish the table before its size, so that a reader that sees the new size also sees the new table
+    chunks.store(table.get(), std::memory_order_release);
+    chunk_slots.store(new_slots, std::memory_order_release);
+    chunk_tables.push_back(std::move(table));
+    chunk_table_bytes += new_slots * sizeof(std::atomic<std::string *>);
+}
+
+std::string *IdStringDB::get_chunk(int index)
+{
+    int chunk_idx = index >> chunk_bits;
+    NPNR_ASSERT(chunk_idx < max_chunks);
+    if (chunk_idx < chunk_slots.load(std::memory_order_acquire)) {
+        std::string *ptr = chunks.load(std::memory_order_acquire)[chunk_idx].load(std::memory_order_acquire);
+        if (ptr != nullptr)
+            return ptr;
+    }
+    std::lock_guard<std::mutex> lock(chunk_mutex);
+    if (chunk_idx >= chunk_slots.load(std::memory_order_relaxed))
+        grow_chunk_table(chunk_idx + 1);
+    auto &chunk = chunks.load(std::memory_order_relaxed)[chunk_idx];
+    std::string *ptr = chunk.load(std::memory_order_relaxed);
+    if (ptr == nullptr) {
+        ptr = static_cast<std::string *>(::operator new(sizeof(std::string) * (chunk_mask + 1)));
+        chunk.store(ptr, std::memory_order_release);
+    }
+    return ptr;
+}
+
+void IdStringDB::Shard::grow()
+{
+    std::vector<int32_t> old_slots;
+    old_slots.swap(slots);
+    std::vector<uint32_t> old_hashes;
+    old_hashes.swap(hashes);
+    size_t new_size = std::max<size_t>(64, old_slots.size() * 2);
+    slots.resize(new_size, -1);
+    hashes.resize(new_size);
+    for (size_t i = 0; i < old_slots.size(); i++) {
+        if (old_slots.at(i) == -1)
+            continue;
+        size_t s = (old_hashes.at(i) >> shard_bits) & (new_size - 1);
+        while (slots.at(s) != -1)
+            s = (s + 1) & (new_size - 1);
+        slots.at(s) = old_slots.at(i);
+        hashes.at(s) = old_hashes.at(i);
+    }
+}
+
+size_t IdStringDB::memory_usage() const
+{
+    int count = size();
+    size_t bytes = chunk_table_bytes;
+    bytes += size_t((count + chunk_mask) >> chunk_bits) * (chunk_mask + 1) * sizeof(std::string);
+    for (int i = 0; i < count; i++) {
+        const std::string &s = str(i);
+        // Short strings are stored inside the std::string itself
+        if (s.capacity() > std::string().capacity())
+            bytes += s.capacity() + 1;
+    }
+    for (auto &shard : shards)
+        bytes += shard.slots.capacity() * sizeof(int32_t) + shard.hashes.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+int IdStringDB::intern(const std::string &s)
+{
+    uint32_t hash = do_hash(s);
+    Shard &shard = shards[hash & ((1 << shard_bits) - 1)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (2 * (shard.used + 1) > int(shard.slots.size()))
+        shard.grow();
+    size_t mask = shard.slots.size() - 1;
+    size_t slot = (hash >> shard_bits) & mask;
+    for (; shard.slots[slot] != -1; slot = (slot + 1) & mask) {
+        int32_t index = shard.slots[slot];
+        if (shard.hashes[slot] == hash && str(index) == s)
+            return index;
+    }
+    // Not found, so add the string at a new index. The index only becomes visible to other threads once it is in the
+    // shard's table, after the string itself has been constructed
+    int index = next_index.fetch_add(1);
+    new (get_chunk(index) + (index & chunk_mask)) std::string(s);
+    shard.slots[slot] = index;
+    shard.hashes[slot] = hash;
+    ++shard.used;
+    return index;
+}
+
+NEXTPNR_NAMESPACE_END
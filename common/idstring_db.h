@@ -0,0 +1,103 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef IDSTRING_DB_H
+#define IDSTRING_DB_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+/*
+The string database behind IdString.
+
+Strings live in fixed-size chunks that are never moved, so looking up the string for an index is a few array accesses
+and needs no lock. The table of chunk pointers starts small and is replaced by a larger copy as the database grows;
+the old tables are kept until the database is destroyed, as other threads may still be reading them. The string to
+index table is split into shards by hash, each with its own lock, so that several threads can create IdStrings at
+once. Indices are handed out in the order strings are first added; when names are
+added from more than one thread at once, their relative order (and so the order of sorting by IdString) is only
+deterministic within each thread.
+*/
+class IdStringDB
+{
+  public:
+    IdStringDB();
+    ~IdStringDB();
+    IdStringDB(const IdStringDB &other) = delete;
+    IdStringDB &operator=(const IdStringDB &other) = delete;
+
+    // Return the index of a string, adding it if it doesn't yet exist. Safe to call from multiple threads
+    int intern(const std::string &s);
+
+    // Number of strings in the database
+    int size() const { return next_index.load(std::memory_order_acquire); }
+
+    // Approximate bytes used by the database, including the characters of long strings. Must not be called while
+    // other threads are adding strings
+    size_t memory_usage() const;
+
+    const std::string &str(int index) const
+    {
+        return chunks.load(std::memory_order_acquire)[index >> chunk_bits].load(std::memory_order_acquire)[index &
+                                                                                                          chunk_mask];
+    }
+
+  private:
+    static const int chunk_bits = 14;
+    static const int chunk_mask = (1 << chunk_bits) - 1;
+    static const int max_chunks = 1 << (31 - chunk_bits);
+    static const int initial_chunk_slots = 16;
+    static const int shard_bits = 6;
+
+    struct Shard
+    {
+        std::mutex mutex;
+        // Open addressing (linear probing) table of string indices, or -1 if empty, and their hashes
+        std::vector<int32_t> slots;
+        std::vector<uint32_t> hashes;
+        int used = 0;
+
+        void grow();
+    };
+
+    // The current table of chunk pointers, and all the tables that have been used (the last is the current one)
+    std::atomic<std::atomic<std::string *> *> chunks;
+    std::vector<std::unique_ptr<std::atomic<std::string *>[]>> chunk_tables;
+    std::atomic<int> chunk_slots;
+    size_t chunk_table_bytes = 0;
+    std::mutex chunk_mutex;
+    std::atomic<int> next_index;
+    Shard shards[1 << shard_bits];
+
+    static uint32_t do_hash(const std::string &s);
+    std::string *get_chunk(int index);
+    void grow_chunk_table(int min_slots);
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* IDSTRING_DB_H */
@@ -19,10 +19,56 @@
 
 #include "nextpnr_types.h"
 
+#include "basectx.h"
+#include "nextpnr_assertions.h"
 #include "nextpnr_namespaces.h"
+#include "object_pool.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
+void *NetInfo::operator new(std::size_t size, BaseCtx *ctx)
+{
+    NPNR_ASSERT(size == sizeof(NetInfo));
+    return ObjectPool<NetInfo>::allocate(&ctx->net_pool);
+}
+void *NetInfo::operator new(std::size_t size)
+{
+    NPNR_ASSERT(size == sizeof(NetInfo));
+    return ObjectPool<NetInfo>::allocate(nullptr);
+}
+void NetInfo::operator delete(void *ptr, BaseCtx *) { ObjectPool<NetInfo>::deallocate(ptr); }
+void NetInfo::operator delete(void *ptr) { ObjectPool<NetInfo>::deallocate(ptr); }
+
+void NetInfo::add_user(const PortRef &user)
+{
+    auto port = user.cell->ports.find(user.port);
+    if (port != user.cell->ports.end())
+        port->second.user_idx = int(users.size());
+    users.push_back(user);
+}
+
+void NetInfo::refresh_user_idx()
+{
+    for (int i = 0; i < int(users.size()); i++) {
+        auto port = users.at(i).cell->ports.find(users.at(i).port);
+        if (port != users.at(i).cell->ports.end())
+            port->second.user_idx = i;
+    }
+}
+
+void *CellInfo::operator new(std::size_t size, BaseCtx *ctx)
+{
+    NPNR_ASSERT(size == sizeof(CellInfo));
+    return ObjectPool<CellInfo>::allocate(&ctx->cell_pool);
+}
+void *CellInfo::operator new(std::size_t size)
+{
+    NPNR_ASSERT(size == sizeof(CellInfo));
+    return ObjectPool<CellInfo>::allocate(nullptr);
+}
+void CellInfo::operator delete(void *ptr, BaseCtx *) { ObjectPool<CellInfo>::deallocate(ptr); }
+void CellInfo::operator delete(void *ptr) { ObjectPool<CellInfo>::deallocate(ptr); }
+
 void CellInfo::addInput(IdString name)
 {
     ports[name].name = name;
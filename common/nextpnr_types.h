@@ -24,10 +24,12 @@
 #ifndef NEXTPNR_TYPES_H
 #define NEXTPNR_TYPES_H
 
+#include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 
 #include "archdefs.h"
+#include "hash_table.h"
 #include "nextpnr_base_types.h"
 #include "nextpnr_namespaces.h"
 #include "property.h"
@@ -56,9 +58,9 @@ struct Region
     bool constr_wires = false;
     bool constr_pips = false;
 
-    std::unordered_set<BelId> bels;
-    std::unordered_set<WireId> wires;
-    std::unordered_set<Loc> piplocs;
+    pool<BelId> bels;
+    pool<WireId> wires;
+    pool<Loc> piplocs;
 };
 
 struct PipMap
@@ -67,6 +69,7 @@ struct PipMap
     PlaceStrength strength = STRENGTH_NONE;
 };
 
+struct BaseCtx;
 struct CellInfo;
 
 struct PortRef
@@ -128,16 +131,33 @@ struct NetInfo : ArchNetInfo
 
     PortRef driver;
     std::vector<PortRef> users;
-    std::unordered_map<IdString, Property> attrs;
+    dict<IdString, Property> attrs;
 
     // wire -> uphill_pip
-    std::unordered_map<WireId, PipMap> wires;
+    dict<WireId, PipMap> wires;
 
     std::vector<IdString> aliases; // entries in net_aliases that point to this net
 
     std::unique_ptr<ClockConstraint> clkconstr;
 
     Region *region = nullptr;
+
+    // Code that edits users directly should use these, so that the user_idx of the ports stays correct. add_user
+    // appends a user and remove_users_if keeps the order of the others; after users has been rebuilt or reordered in
+    // any other way, refresh_user_idx sets the index of every user
+    void add_user(const PortRef &user);
+    template <typename Tpred> void remove_users_if(Tpred pred)
+    {
+        users.erase(std::remove_if(users.begin(), users.end(), pred), users.end());
+        refresh_user_idx();
+    }
+    void refresh_user_idx();
+
+    // Nets and cells are allocated from the slab of a context with `new (ctx) NetInfo` (see object_pool.h)
+    static void *operator new(std::size_t size, BaseCtx *ctx);
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, BaseCtx *ctx);
+    static void operator delete(void *ptr);
 };
 
 enum PortType
@@ -152,6 +172,10 @@ struct PortInfo
     IdString name;
     NetInfo *net;
     PortType type;
+    // Index of this port in net->users, so that it can be disconnected in constant time. It is kept up to date by
+    // connect_port, disconnect_port and the NetInfo user helpers; as scripts may still edit users directly, it is
+    // checked against the entry before use
+    int user_idx = -1;
 };
 
 struct CellInfo : ArchCellInfo
@@ -159,8 +183,8 @@ struct CellInfo : ArchCellInfo
     IdString name, type, hierpath;
     int32_t udata;
 
-    std::unordered_map<IdString, PortInfo> ports;
-    std::unordered_map<IdString, Property> attrs, params;
+    dict<IdString, PortInfo> ports;
+    dict<IdString, Property> attrs, params;
 
     BelId bel;
     PlaceStrength belStrength = STRENGTH_NONE;
@@ -193,6 +217,11 @@ struct CellInfo : ArchCellInfo
     bool testRegion(BelId bel) const;
     // get the constrained location for this cell given a provisional location for its parent
     Loc getConstrainedLoc(Loc parent_loc) const;
+
+    static void *operator new(std::size_t size, BaseCtx *ctx);
+    static void *operator new(std::size_t size);
+    static void operator delete(void *ptr, BaseCtx *ctx);
+    static void operator delete(void *ptr);
 };
 
 enum TimingPortClass
@@ -245,13 +274,13 @@ struct HierarchicalCell
 {
     IdString name, type, parent, fullpath;
     // Name inside cell instance -> global name
-    std::unordered_map<IdString, IdString> leaf_cells, nets;
+    dict<IdString, IdString> leaf_cells, nets;
     // Global name -> name inside cell instance
-    std::unordered_map<IdString, IdString> leaf_cells_by_gname, nets_by_gname;
+    dict<IdString, IdString> leaf_cells_by_gname, nets_by_gname;
     // Cell port to net
-    std::unordered_map<IdString, HierarchicalPort> ports;
+    dict<IdString, HierarchicalPort> ports;
     // Name inside cell instance -> global name
-    std::unordered_map<IdString, IdString> hier_cells;
+    dict<IdString, IdString> hier_cells;
 };
 
 NEXTPNR_NAMESPACE_END
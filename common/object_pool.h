@@ -0,0 +1,127 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef OBJECT_POOL_H
+#define OBJECT_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+/*
+Slab allocator for objects that are created and destroyed in large numbers (the cells and nets of the netlist).
+
+Each BaseCtx owns one pool per type. Objects are carved out of fixed-size chunks, so they stay packed together in
+memory and never move; freed slots go onto a free list and are handed out again first. The chunks are released in one
+go when the pool (and so the context) is destroyed, so every object must have been freed by then.
+
+Every slot records the pool it came from, so that an object can be freed without knowing its context. Objects created
+without a pool get a slot of their own from the heap. Like the rest of the netlist, a pool must only be used from one
+thread at a time.
+*/
+template <typename T> class ObjectPool
+{
+  public:
+    struct Stats
+    {
+        size_t live = 0;
+        size_t capacity = 0;
+        size_t bytes = 0;
+    };
+
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    // Allocate storage for one object from pool, or from the heap if pool is nullptr
+    static void *allocate(ObjectPool *pool)
+    {
+        Slot *slot;
+        if (pool == nullptr) {
+            slot = static_cast<Slot *>(::operator new(sizeof(Slot)));
+        } else {
+            if (pool->free_list == nullptr)
+                pool->add_chunk();
+            slot = pool->free_list;
+            pool->free_list = slot->next;
+            ++pool->live;
+        }
+        slot->owner = pool;
+        return slot->data;
+    }
+
+    static void deallocate(void *ptr)
+    {
+        Slot *slot = reinterpret_cast<Slot *>(static_cast<unsigned char *>(ptr) - offsetof(Slot, data));
+        ObjectPool *pool = slot->owner;
+        if (pool == nullptr) {
+            ::operator delete(slot);
+            return;
+        }
+        slot->next = pool->free_list;
+        pool->free_list = slot;
+        --pool->live;
+    }
+
+    Stats stats() const
+    {
+        Stats result;
+        result.live = live;
+        result.capacity = chunks.size() * chunk_size;
+        result.bytes = result.capacity * sizeof(Slot);
+        return result;
+    }
+
+  private:
+    static const size_t chunk_size = 256;
+
+    struct Slot
+    {
+        ObjectPool *owner;
+        union
+        {
+            Slot *next;
+            alignas(T) unsigned char data[sizeof(T)];
+        };
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> chunks;
+    Slot *free_list = nullptr;
+    size_t live = 0;
+
+    // Link the slots of a new chunk onto the free list, so they are allocated in address order
+    void add_chunk()
+    {
+        chunks.emplace_back(new Slot[chunk_size]);
+        Slot *chunk = chunks.back().get();
+        for (size_t i = chunk_size; i > 0; i--) {
+            chunk[i - 1].next = free_list;
+            free_list = &chunk[i - 1];
+        }
+    }
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* OBJECT_POOL_H */
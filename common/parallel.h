@@ -0,0 +1,63 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#ifndef NPNR_DISABLE_THREADS
+#include <boost/thread.hpp>
+#endif
+
+#include "nextpnr_namespaces.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+// Call func(i) for each i in [0, count) using up to the given number of threads; the calls must be independent.
+// Work items can vary a lot in size, so they are handed out one at a time
+template <typename Tfunc> void for_each_parallel(int threads, size_t count, Tfunc func)
+{
+#ifndef NPNR_DISABLE_THREADS
+    size_t n_threads = std::min<size_t>(std::max(1, threads), count);
+    if (n_threads > 1) {
+        std::atomic<size_t> next{0};
+        auto worker = [&]() {
+            for (size_t i = next++; i < count; i = next++)
+                func(i);
+        };
+        std::vector<boost::thread> workers;
+        for (size_t i = 1; i < n_threads; i++)
+            workers.emplace_back(worker);
+        worker();
+        for (auto &w : workers)
+            w.join();
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; i++)
+        func(i);
+}
+
+NEXTPNR_NAMESPACE_END
+
+#endif /* PARALLEL_H */
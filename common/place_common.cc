@@ -19,6 +19,7 @@
 
 #include "place_common.h"
 #include <cmath>
+#include "fast_bels.h"
 #include "log.h"
 #include "util.h"
 
@@ -116,28 +117,26 @@ bool place_single_cell(Context *ctx, CellInfo *cell, bool require_legality)
         if (cell->bel != BelId()) {
             ctx->unbindBel(cell->bel);
         }
-        IdString targetType = cell->type;
-        for (auto bel : ctx->getBels()) {
-            if (ctx->isValidBelForCellType(targetType, bel)) {
-                if (ctx->checkBelAvail(bel)) {
-                    wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
-                    if (iters >= 4)
-                        wirelen += ctx->rng(25);
-                    if (wirelen <= best_wirelen) {
-                        best_wirelen = wirelen;
-                        best_bel = bel;
-                    }
-                } else {
-                    wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
-                    if (iters >= 4)
-                        wirelen += ctx->rng(25);
-                    if (wirelen <= best_ripup_wirelen) {
-                        CellInfo *curr_cell = ctx->getBoundBelCell(bel);
-                        if (curr_cell->belStrength < STRENGTH_STRONG) {
-                            best_ripup_wirelen = wirelen;
-                            ripup_bel = bel;
-                            ripup_target = curr_cell;
-                        }
+        // Only look at the bels of the right type, rather than every bel of the device
+        for (auto bel : FastBelsIndex::get(ctx).getCellType(cell->type).bels) {
+            if (ctx->checkBelAvail(bel)) {
+                wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
+                if (iters >= 4)
+                    wirelen += ctx->rng(25);
+                if (wirelen <= best_wirelen) {
+                    best_wirelen = wirelen;
+                    best_bel = bel;
+                }
+            } else {
+                wirelen_t wirelen = get_cell_metric_at_bel(ctx, cell, bel, MetricType::COST);
+                if (iters >= 4)
+                    wirelen += ctx->rng(25);
+                if (wirelen <= best_ripup_wirelen) {
+                    CellInfo *curr_cell = ctx->getBoundBelCell(bel);
+                    if (curr_cell->belStrength < STRENGTH_STRONG) {
+                        best_ripup_wirelen = wirelen;
+                        ripup_bel = bel;
+                        ripup_target = curr_cell;
                     }
                 }
             }
@@ -25,6 +25,10 @@
 #include <algorithm>
 #include <boost/lexical_cast.hpp>
 #include <boost/range/adaptor/reversed.hpp>
+#ifndef NPNR_DISABLE_THREADS
+#include <boost/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#endif
 #include <chrono>
 #include <cmath>
 #include <iostream>
@@ -98,13 +102,22 @@ class SAPlacer
         }
 
         net_bounds.resize(ctx->nets.size());
+        net_ignored.resize(ctx->nets.size());
         net_arc_tcost.resize(ctx->nets.size());
+        net_arc_delay.resize(ctx->nets.size());
+        net_arc_weight.resize(ctx->nets.size());
         old_udata.reserve(ctx->nets.size());
         net_by_udata.reserve(ctx->nets.size());
         decltype(NetInfo::udata) n = 0;
         for (auto &net : ctx->nets) {
             old_udata.emplace_back(net.second->udata);
             net_arc_tcost.at(n).resize(net.second->users.size());
+            net_arc_delay.at(n).resize(net.second->users.size());
+            net_arc_weight.at(n).resize(net.second->users.size());
+            int cc;
+            net_timing_ignored.push_back(net.second->driver.cell == nullptr ||
+                                         ctx->getPortTimingClass(net.second->driver.cell, net.second->driver.port,
+                                                                 cc) == TMG_IGNORE);
             net.second->udata = n++;
             net_by_udata.push_back(net.second.get());
         }
@@ -248,6 +261,13 @@ class SAPlacer
         // Calculate costs after initial placement
         setup_costs();
         moveChange.init(this);
+        // The net sharing metric is a global count, so isn't suitable for independent windows
+        bool windowed = cfg.threads > 1 && cfg.netShareWeight <= 0;
+        if (windowed) {
+            window_move_change.resize(cfg.threads);
+            for (auto &mc : window_move_change)
+                mc.init(this);
+        }
         curr_wirelen_cost = total_wirelen_cost();
         curr_timing_cost = total_timing_cost();
         last_wirelen_cost = curr_wirelen_cost;
@@ -272,9 +292,18 @@ class SAPlacer
                          "%.0f, wirelen = %.0f\n",
                          iter, temp, double(curr_timing_cost), double(curr_wirelen_cost));
 
+            if (windowed) {
+                // Cells that can be moved independently within a window are moved in parallel first; the remaining
+                // (boundary) cells and chains are then moved serially below
+                setup_windows(autoplaced);
+                run_window_moves();
+            }
+
             for (int m = 0; m < 15; ++m) {
                 // Loop through all automatically placed cells
                 for (auto cell : autoplaced) {
+                    if (windowed && cell_window.count(cell))
+                        continue;
                     // Find another random Bel for this cell
                     BelId try_bel = random_bel_for_cell(cell);
                     // If valid, try and swap to a new position and see if
@@ -295,7 +324,7 @@ class SAPlacer
                 // Verify correctness of incremental wirelen updates
                 for (size_t i = 0; i < net_bounds.size(); i++) {
                     auto net = net_by_udata[i];
-                    if (ignore_net(net))
+                    if (net_ignored[i])
                         continue;
                     auto &incr = net_bounds.at(i), gold = get_net_bounds(net);
                     NPNR_ASSERT(incr.x0 == gold.x0);
@@ -372,6 +401,8 @@ class SAPlacer
                     // Legalisation is a big change so force a slack redistribution here
                     if (cfg.slack_redist_iter > 0 && cfg.budgetBased)
                         assign_budget(ctx, true /* quiet */);
+                    // Cells were moved outside of the incremental cost updates
+                    cost_cache_valid = false;
                 }
                 require_legal = false;
             } else if (cfg.budgetBased && cfg.slack_redist_iter > 0 && iter % cfg.slack_redist_iter == 0) {
@@ -386,6 +417,10 @@ class SAPlacer
             // Reset incremental bounds
             moveChange.reset(this);
             moveChange.new_net_bounds = net_bounds;
+            for (auto &mc : window_move_change) {
+                mc.reset(this);
+                mc.new_net_bounds = net_bounds;
+            }
 
             // Recalculate total metric entirely to avoid rounding errors
             // accumulating over time
@@ -470,7 +505,7 @@ class SAPlacer
                     proc_bel(bel);
                 }
             } else {
-                for (auto bel : ctx->getBels()) {
+                for (auto bel : fast_bels.index.getCellType(targetType).bels) {
                     proc_bel(bel);
                 }
             }
@@ -827,36 +862,55 @@ class SAPlacer
         return bb;
     }
 
-    // Get the timing cost for an arc of a net
-    inline double get_timing_cost(NetInfo *net, size_t user)
+    // Get the predicted delay (in ns) for an arc of a net at the current placement
+    inline double get_arc_delay(NetInfo *net, size_t user)
     {
-        int cc;
-        if (net->driver.cell == nullptr)
-            return 0;
-        if (ctx->getPortTimingClass(net->driver.cell, net->driver.port, cc) == TMG_IGNORE)
+        return ctx->getDelayNS(ctx->predictDelay(net, net->users.at(user)));
+    }
+
+    // Get the timing weight for an arc of a net; this is the budget (in ns) for budget based placement, or the
+    // criticality raised to the criticality exponent otherwise. It only changes when budgets or criticalities are
+    // updated, so is cached in net_arc_weight
+    inline double get_arc_weight(NetInfo *net, size_t user)
+    {
+        if (cfg.budgetBased)
+            return ctx->getDelayNS(net->users.at(user).budget);
+        float crit = tmg.get_criticality(CellPortKey(net->users.at(user)));
+        return std::pow(crit, crit_exp);
+    }
+
+    // Get the timing cost for an arc of a net, given its delay
+    inline double get_timing_cost(decltype(NetInfo::udata) net, size_t user, double delay)
+    {
+        if (net_timing_ignored[net])
             return 0;
-        if (cfg.budgetBased) {
-            double delay = ctx->getDelayNS(ctx->predictDelay(net, net->users.at(user)));
-            return std::min(10.0, std::exp(delay - ctx->getDelayNS(net->users.at(user).budget) / 10));
-        } else {
-            float crit = tmg.get_criticality(CellPortKey(net->users.at(user)));
-            double delay = ctx->getDelayNS(ctx->predictDelay(net, net->users.at(user)));
-            return delay * std::pow(crit, crit_exp);
-        }
+        if (cfg.budgetBased)
+            return std::min(10.0, std::exp(delay - net_arc_weight[net][user] / 10));
+        else
+            return delay * net_arc_weight[net][user];
     }
 
-    // Set up the cost maps
+    // Set up the cost maps. Net bounds and arc delays are maintained incrementally by moves, so they are only
+    // recomputed if the cells have been moved by something else since (or if a net is no longer ignored)
     void setup_costs()
     {
-        for (auto net : sorted(ctx->nets)) {
-            NetInfo *ni = net.second;
-            if (ignore_net(ni))
+        for (auto ni : net_by_udata) {
+            bool ignored = ignore_net(ni);
+            bool refresh = !cost_cache_valid || (net_ignored[ni->udata] && !ignored);
+            net_ignored[ni->udata] = ignored;
+            if (ignored)
                 continue;
-            net_bounds[ni->udata] = get_net_bounds(ni);
+            if (refresh)
+                net_bounds[ni->udata] = get_net_bounds(ni);
             if (cfg.timing_driven && int(ni->users.size()) < cfg.timingFanoutThresh)
-                for (size_t i = 0; i < ni->users.size(); i++)
-                    net_arc_tcost[ni->udata][i] = get_timing_cost(ni, i);
+                for (size_t i = 0; i < ni->users.size(); i++) {
+                    if (refresh)
+                        net_arc_delay[ni->udata][i] = get_arc_delay(ni, i);
+                    net_arc_weight[ni->udata][i] = get_arc_weight(ni, i);
+                    net_arc_tcost[ni->udata][i] = get_timing_cost(ni->udata, i, net_arc_delay[ni->udata][i]);
+                }
         }
+        cost_cache_valid = true;
     }
 
     // Get the total wiring cost for the design
@@ -900,6 +954,7 @@ class SAPlacer
 
         std::vector<BoundingBox> new_net_bounds;
         std::vector<std::pair<std::pair<decltype(NetInfo::udata), size_t>, double>> new_arc_costs;
+        std::vector<double> new_arc_delays;
 
         wirelen_t wirelen_delta = 0;
         double timing_delta = 0;
@@ -931,6 +986,7 @@ class SAPlacer
             bounds_changed_nets_y.clear();
             changed_arcs.clear();
             new_arc_costs.clear();
+            new_arc_delays.clear();
             wirelen_delta = 0;
             timing_delta = 0;
         }
@@ -946,7 +1002,7 @@ class SAPlacer
             NetInfo *pn = port.second.net;
             if (pn == nullptr)
                 continue;
-            if (ignore_net(pn))
+            if (net_ignored[pn->udata])
                 continue;
             BoundingBox &curr_bounds = mc.new_net_bounds[pn->udata];
             // Incremental bounding box updates
@@ -1073,9 +1129,7 @@ class SAPlacer
             if (cfg.timing_driven && int(pn->users.size()) < cfg.timingFanoutThresh) {
                 // Output ports - all arcs change timing
                 if (port.second.type == PORT_OUT) {
-                    int cc;
-                    TimingPortClass cls = ctx->getPortTimingClass(cell, port.first, cc);
-                    if (cls != TMG_IGNORE)
+                    if (!net_timing_ignored[pn->udata])
                         for (size_t i = 0; i < pn->users.size(); i++)
                             if (!mc.already_changed_arcs[pn->udata][i]) {
                                 mc.changed_arcs.emplace_back(std::make_pair(pn->udata, i));
@@ -1113,8 +1167,10 @@ class SAPlacer
         if (cfg.timing_driven) {
             for (const auto &tc : md.changed_arcs) {
                 double old_cost = net_arc_tcost.at(tc.first).at(tc.second);
-                double new_cost = get_timing_cost(net_by_udata.at(tc.first), tc.second);
+                double new_delay = get_arc_delay(net_by_udata.at(tc.first), tc.second);
+                double new_cost = get_timing_cost(tc.first, tc.second, new_delay);
                 md.new_arc_costs.emplace_back(std::make_pair(tc, new_cost));
+                md.new_arc_delays.push_back(new_delay);
                 md.timing_delta += (new_cost - old_cost);
                 md.already_changed_arcs[tc.first][tc.second] = false;
             }
@@ -1127,11 +1183,355 @@ class SAPlacer
             net_bounds[bc] = md.new_net_bounds[bc];
         for (const auto &bc : md.bounds_changed_nets_y)
             net_bounds[bc] = md.new_net_bounds[bc];
-        for (const auto &tc : md.new_arc_costs)
+        for (size_t i = 0; i < md.new_arc_costs.size(); i++) {
+            const auto &tc = md.new_arc_costs.at(i);
             net_arc_tcost[tc.first.first].at(tc.first.second) = tc.second;
+            net_arc_delay[tc.first.first].at(tc.first.second) = md.new_arc_delays.at(i);
+        }
         curr_wirelen_cost += md.wirelen_delta;
         curr_timing_cost += md.timing_delta;
     }
+
+    struct WindowMove
+    {
+        CellInfo *cell, *other_cell;
+        BelId old_bel, new_bel;
+    };
+
+    // A window of the device for windowed parallel annealing, and the batch of moves it accepted in the current round
+    struct AnnealWindow
+    {
+        int x0 = 0, x1 = 0, y0 = 0, y1 = 0;
+        DeterministicRNG rng;
+        std::vector<CellInfo *> cells;
+        int next_cell = 0, moves_left = 0;
+
+        // Accepted moves are applied to the cell locations and the cost data of the window straight away, so that
+        // later moves in the batch see them, but are only bound when the batch is committed
+        std::vector<WindowMove> moves;
+        std::unordered_map<CellInfo *, BelId> bound_bel;
+        std::unordered_map<BelId, CellInfo *> moved_bels;
+        std::vector<decltype(NetInfo::udata)> changed_nets;
+        std::vector<std::pair<decltype(NetInfo::udata), size_t>> changed_arcs;
+        int n_proposed = 0;
+        wirelen_t wirelen_delta = 0;
+        double timing_delta = 0;
+    };
+
+    // Partition the device into square windows for windowed parallel annealing, and find the cells that can be moved
+    // independently inside each window. A cell belongs to a window if every net it connects to either lies entirely
+    // inside that window, or is ignored for costing (like clocks), or spans more than one window with the cell being
+    // a sink strictly inside its bounding box. In the last two cases the cell must not be the driver and may only
+    // move within the bounding box, so the costs of nets that span windows only change arc-by-arc. Moves of different
+    // windows therefore never affect the same net bounds, arcs or bels.
+    void setup_windows(const std::vector<CellInfo *> &autoplaced)
+    {
+        windows.clear();
+        cell_window.clear();
+        int side = std::max(min_window_size, 2 * diameter + 1);
+        // Randomly offset the windows at each temperature step, so that cells on a boundary once will be inside a
+        // window later on
+        int ox = ctx->rng(side), oy = ctx->rng(side);
+        int nwx = (max_x + ox) / side + 1, nwy = (max_y + oy) / side + 1;
+        if (nwx * nwy < 2)
+            return;
+        auto window_of = [&](BelId bel) {
+            Loc loc = ctx->getBelLocation(bel);
+            return ((loc.y + oy) / side) * nwx + (loc.x + ox) / side;
+        };
+        windows.resize(nwx * nwy);
+        for (int wy = 0; wy < nwy; wy++) {
+            for (int wx = 0; wx < nwx; wx++) {
+                auto &w = windows.at(wy * nwx + wx);
+                w.x0 = wx * side - ox;
+                w.x1 = w.x0 + side - 1;
+                w.y0 = wy * side - oy;
+                w.y1 = w.y0 + side - 1;
+                w.rng.rngseed(ctx->rng64());
+            }
+        }
+
+        net_window.assign(net_by_udata.size(), -1);
+        for (size_t i = 0; i < net_by_udata.size(); i++) {
+            NetInfo *ni = net_by_udata.at(i);
+            if (net_ignored.at(i)) {
+                net_window.at(i) = -2;
+                continue;
+            }
+            // -2: no pins seen yet, -1: pins in more than one window (or unplaced)
+            int w = -2;
+            auto add_pin = [&](const PortRef &pr) {
+                if (pr.cell == nullptr || w == -1)
+                    return;
+                int pw = (pr.cell->bel == BelId()) ? -1 : window_of(pr.cell->bel);
+                w = (w == -2 || w == pw) ? pw : -1;
+            };
+            add_pin(ni->driver);
+            for (const auto &usr : ni->users)
+                add_pin(usr);
+            net_window.at(i) = std::max(w, -1);
+        }
+
+        for (auto cell : autoplaced) {
+            if (cell->bel == BelId() || cell->isConstrained(false) || cell->belStrength > STRENGTH_WEAK)
+                continue;
+            // Rare cell types are picked from the whole device rather than a location, so can't be windowed
+            FastBels::FastBelsData *bel_data;
+            if (cfg.minBelsForGridPick >= 0 &&
+                fast_bels.getBelsForCellType(cell->type, &bel_data) < cfg.minBelsForGridPick)
+                continue;
+            int w = window_of(cell->bel);
+            bool contained = true;
+            for (const auto &port : cell->ports) {
+                NetInfo *pn = port.second.net;
+                if (pn == nullptr || net_window.at(pn->udata) == w)
+                    continue;
+                if (pn->driver.cell != cell)
+                    continue;
+                contained = false;
+                break;
+            }
+            if (!contained || !inside_spanning_nets(cell, ctx->getBelLocation(cell->bel)))
+                continue;
+            cell_window[cell] = w;
+            windows.at(w).cells.push_back(cell);
+        }
+        for (auto &w : windows)
+            w.moves_left = 15 * int(w.cells.size());
+    }
+
+    // Check that a cell at loc would be strictly inside the bounding box of all the nets it connects to that span
+    // more than one window
+    bool inside_spanning_nets(const CellInfo *cell, Loc loc)
+    {
+        for (const auto &port : cell->ports) {
+            NetInfo *pn = port.second.net;
+            if (pn == nullptr || net_window.at(pn->udata) != -1)
+                continue;
+            const BoundingBox &bb = net_bounds.at(pn->udata);
+            if (loc.x <= bb.x0 || loc.x >= bb.x1 || loc.y <= bb.y0 || loc.y >= bb.y1)
+                return false;
+        }
+        return true;
+    }
+
+    // Find a random Bel of the correct type for a cell within its window, or BelId() if none was found after a few
+    // attempts
+    BelId random_bel_in_window(CellInfo *cell, AnnealWindow &w)
+    {
+        Loc curr_loc = ctx->getBelLocation(cell->bel);
+        int x0 = std::max({curr_loc.x - diameter, w.x0, 0}), x1 = std::min(curr_loc.x + diameter, w.x1);
+        int y0 = std::max({curr_loc.y - diameter, w.y0, 0}), y1 = std::min(curr_loc.y + diameter, w.y1);
+
+        FastBels::FastBelsData *bel_data;
+        fast_bels.getBelsForCellType(cell->type, &bel_data);
+
+        for (int attempt = 0; attempt < 10; attempt++) {
+            int nx = x0 + w.rng.rng(x1 - x0 + 1);
+            int ny = y0 + w.rng.rng(y1 - y0 + 1);
+            if (nx >= int(bel_data->size()))
+                continue;
+            if (ny >= int(bel_data->at(nx).size()))
+                continue;
+            const auto &fb = bel_data->at(nx).at(ny);
+            if (fb.size() == 0)
+                continue;
+            BelId bel = fb.at(w.rng.rng(int(fb.size())));
+            if (!cell->testRegion(bel))
+                continue;
+            if (locked_bels.find(bel) != locked_bels.end())
+                continue;
+            return bel;
+        }
+        return BelId();
+    }
+
+    // Propose and evaluate a move for a window, called from the worker threads. As binding isn't thread safe, the
+    // cost of the move is evaluated by changing the cell locations only; this is safe because nothing outside of the
+    // window can observe the locations of its cells, or the cost data of its nets and arcs.
+    void propose_window_move(AnnealWindow &w, int w_idx, MoveChangeData &mc)
+    {
+        static const double epsilon = 1e-20;
+        CellInfo *cell = w.cells.at(w.next_cell++ % w.cells.size());
+        BelId old_bel = cell->bel;
+        BelId new_bel = random_bel_in_window(cell, w);
+        if (new_bel == BelId() || new_bel == old_bel)
+            return;
+        if (!ctx->isValidBelForCellType(cell->type, new_bel))
+            return;
+        auto fnd_moved = w.moved_bels.find(new_bel);
+        CellInfo *other_cell = (fnd_moved != w.moved_bels.end()) ? fnd_moved->second : ctx->getBoundBelCell(new_bel);
+        if (other_cell != nullptr) {
+            auto fnd = cell_window.find(other_cell);
+            if (fnd == cell_window.end() || fnd->second != w_idx)
+                return;
+            if (!ctx->isValidBelForCellType(other_cell->type, old_bel))
+                return;
+            if (!inside_spanning_nets(other_cell, ctx->getBelLocation(old_bel)))
+                return;
+        }
+        if (!inside_spanning_nets(cell, ctx->getBelLocation(new_bel)))
+            return;
+
+        mc.reset(this);
+        cell->bel = new_bel;
+        if (other_cell != nullptr)
+            other_cell->bel = old_bel;
+        add_move_cell(mc, cell, old_bel);
+        if (other_cell != nullptr)
+            add_move_cell(mc, other_cell, new_bel);
+        compute_cost_changes(mc);
+
+        double delta = lambda * (mc.timing_delta / std::max<double>(last_timing_cost, epsilon)) +
+                       (1 - lambda) * (double(mc.wirelen_delta) / std::max<double>(last_wirelen_cost, epsilon));
+        w.n_proposed++;
+        if (delta < 0 || (temp > 1e-8 && (w.rng.rng() / float(0x3fffffff)) <= std::exp(-delta / temp))) {
+            w.bound_bel.emplace(cell, old_bel);
+            if (other_cell != nullptr)
+                w.bound_bel.emplace(other_cell, new_bel);
+            w.moved_bels[new_bel] = cell;
+            w.moved_bels[old_bel] = other_cell;
+            w.moves.push_back(WindowMove{cell, other_cell, old_bel, new_bel});
+            for (const auto &bc : mc.bounds_changed_nets_x) {
+                net_bounds[bc] = mc.new_net_bounds[bc];
+                w.changed_nets.push_back(bc);
+            }
+            for (const auto &bc : mc.bounds_changed_nets_y) {
+                net_bounds[bc] = mc.new_net_bounds[bc];
+                w.changed_nets.push_back(bc);
+            }
+            for (size_t i = 0; i < mc.new_arc_costs.size(); i++) {
+                const auto &tc = mc.new_arc_costs.at(i);
+                net_arc_tcost[tc.first.first].at(tc.first.second) = tc.second;
+                net_arc_delay[tc.first.first].at(tc.first.second) = mc.new_arc_delays.at(i);
+                w.changed_arcs.push_back(tc.first);
+            }
+            w.wirelen_delta += mc.wirelen_delta;
+            w.timing_delta += mc.timing_delta;
+        } else {
+            cell->bel = old_bel;
+            if (other_cell != nullptr)
+                other_cell->bel = new_bel;
+        }
+    }
+
+    // Bind and check the legality of the moves accepted by a window in order. If a move turns out to be illegal it is
+    // undone, along with any later moves that no longer apply, and the costs of the window's nets are recomputed from
+    // the resulting placement
+    void commit_window_moves(AnnealWindow &w)
+    {
+        n_move += w.n_proposed;
+        w.n_proposed = 0;
+        if (w.moves.empty())
+            return;
+        // Go back to the locations that are actually bound, then replay the moves
+        for (const auto &bb : w.bound_bel)
+            bb.first->bel = bb.second;
+        bool undone = false;
+        for (const auto &m : w.moves) {
+            if (m.cell->bel != m.old_bel || ctx->getBoundBelCell(m.new_bel) != m.other_cell) {
+                undone = true;
+                continue;
+            }
+            ctx->unbindBel(m.old_bel);
+            if (m.other_cell != nullptr)
+                ctx->unbindBel(m.new_bel);
+            ctx->bindBel(m.new_bel, m.cell, STRENGTH_WEAK);
+            if (m.other_cell != nullptr)
+                ctx->bindBel(m.old_bel, m.other_cell, STRENGTH_WEAK);
+            if (!ctx->isBelLocationValid(m.new_bel) || !ctx->isBelLocationValid(m.old_bel)) {
+                ctx->unbindBel(m.new_bel);
+                if (m.other_cell != nullptr) {
+                    ctx->unbindBel(m.old_bel);
+                    ctx->bindBel(m.new_bel, m.other_cell, STRENGTH_WEAK);
+                }
+                ctx->bindBel(m.old_bel, m.cell, STRENGTH_WEAK);
+                // Illegal moves aren't counted by the serial annealer either
+                n_move--;
+                undone = true;
+                continue;
+            }
+            n_accept++;
+        }
+        curr_wirelen_cost += w.wirelen_delta;
+        curr_timing_cost += w.timing_delta;
+        if (undone) {
+            for (auto n : w.changed_nets) {
+                BoundingBox bb = get_net_bounds(net_by_udata.at(n));
+                curr_wirelen_cost += bb.hpwl(cfg) - net_bounds[n].hpwl(cfg);
+                net_bounds[n] = bb;
+            }
+            for (const auto &arc : w.changed_arcs) {
+                double delay = get_arc_delay(net_by_udata.at(arc.first), arc.second);
+                double cost = get_timing_cost(arc.first, arc.second, delay);
+                curr_timing_cost += cost - net_arc_tcost[arc.first].at(arc.second);
+                net_arc_tcost[arc.first].at(arc.second) = cost;
+                net_arc_delay[arc.first].at(arc.second) = delay;
+            }
+        }
+        // The incremental bounds of every MoveChangeData must be kept in sync with net_bounds
+        for (auto n : w.changed_nets) {
+            moveChange.new_net_bounds[n] = net_bounds[n];
+            for (auto &mc : window_move_change)
+                mc.new_net_bounds[n] = net_bounds[n];
+        }
+        w.moves.clear();
+        w.bound_bel.clear();
+        w.moved_bels.clear();
+        w.changed_nets.clear();
+        w.changed_arcs.clear();
+        w.wirelen_delta = 0;
+        w.timing_delta = 0;
+    }
+
+    // Run the moves of all windows. Each round, every window proposes a batch of moves in parallel, and then the
+    // accepted moves are committed serially in window order so that the result doesn't depend on the number of threads
+    void run_window_moves()
+    {
+        if (windows.empty())
+            return;
+        int n_threads = std::max(1, std::min<int>(cfg.threads, int(windows.size())));
+#ifndef NPNR_DISABLE_THREADS
+        boost::barrier barrier(n_threads);
+#endif
+        auto sync = [&]() {
+#ifndef NPNR_DISABLE_THREADS
+            if (n_threads > 1)
+                barrier.wait();
+#endif
+        };
+        auto worker = [&](int tid) {
+            while (true) {
+                bool more = false;
+                for (int i = tid; i < int(windows.size()); i += n_threads) {
+                    auto &w = windows.at(i);
+                    for (int m = 0; m < window_batch_size && w.moves_left > 0; m++, w.moves_left--)
+                        propose_window_move(w, i, window_move_change.at(tid));
+                }
+                sync();
+                if (tid == 0)
+                    for (auto &w : windows)
+                        commit_window_moves(w);
+                // Only read after the barrier, so all threads agree on whether there is another round
+                for (auto &w : windows)
+                    more |= (w.moves_left > 0);
+                sync();
+                if (!more)
+                    break;
+            }
+        };
+#ifndef NPNR_DISABLE_THREADS
+        std::vector<boost::thread> workers;
+        for (int i = 1; i < n_threads; i++)
+            workers.emplace_back([&worker, i]() { worker(i); });
+        worker(0);
+        for (auto &w : workers)
+            w.join();
+#else
+        worker(0);
+#endif
+    }
+
     // Build the cell port -> user index
     void build_port_index()
     {
@@ -1147,11 +1547,11 @@ class SAPlacer
     // Simple routeability driven placement
     const int large_cell_thresh = 50;
     int total_net_share = 0;
-    std::vector<std::vector<std::unordered_map<IdString, int>>> nets_by_tile;
+    std::vector<std::vector<std::unordered_map<decltype(NetInfo::udata), int>>> nets_by_tile;
     void setup_nets_by_tile()
     {
         total_net_share = 0;
-        nets_by_tile.resize(max_x + 1, std::vector<std::unordered_map<IdString, int>>(max_y + 1));
+        nets_by_tile.resize(max_x + 1, std::vector<std::unordered_map<decltype(NetInfo::udata), int>>(max_y + 1));
         for (auto cell : sorted(ctx->cells)) {
             CellInfo *ci = cell.second;
             if (int(ci->ports.size()) > large_cell_thresh)
@@ -1163,7 +1563,7 @@ class SAPlacer
                     continue;
                 if (port.second.net->driver.cell == nullptr || ctx->getBelGlobalBuf(port.second.net->driver.cell->bel))
                     continue;
-                int &s = nbt[port.second.net->name];
+                int &s = nbt[port.second.net->udata];
                 if (s > 0)
                     ++total_net_share;
                 ++s;
@@ -1184,12 +1584,12 @@ class SAPlacer
                 continue;
             if (port.second.net->driver.cell == nullptr || ctx->getBelGlobalBuf(port.second.net->driver.cell->bel))
                 continue;
-            int &o = nbt_old[port.second.net->name];
+            int &o = nbt_old[port.second.net->udata];
             --o;
             NPNR_ASSERT(o >= 0);
             if (o > 0)
                 ++loss;
-            int &n = nbt_new[port.second.net->name];
+            int &n = nbt_new[port.second.net->udata];
             if (n > 0)
                 ++gain;
             ++n;
@@ -1205,10 +1605,27 @@ class SAPlacer
         return lambda * curr_timing_cost + (1 - lambda) * curr_wirelen_cost - cfg.netShareWeight * total_net_share;
     }
 
+    const int min_window_size = 8;
+    // Moves proposed by each window before the windows are synchronised and their moves committed
+    const int window_batch_size = 32;
+    std::vector<AnnealWindow> windows;
+    // Window of each cell that is moved by windowed annealing in the current temperature step
+    std::unordered_map<const CellInfo *, int> cell_window;
+    // Window containing all pins of each net, -1 if it spans more than one window or -2 if it is ignored for costing
+    std::vector<int> net_window;
+    // Incremental cost data for each windowed annealing thread
+    std::vector<MoveChangeData> window_move_change;
+
     // Map nets to their bounding box (so we can skip recompute for moves that do not exceed the bounds
     std::vector<BoundingBox> net_bounds;
     // Map net arcs to their timing cost (criticality * delay ns)
     std::vector<std::vector<double>> net_arc_tcost;
+    // Map net arcs to their predicted delay (ns) at the current placement, and their timing weight
+    std::vector<std::vector<double>> net_arc_delay, net_arc_weight;
+    // Whether ignore_net() was true for each net at the last setup_costs, and whether its driver is ignored for timing
+    std::vector<bool> net_ignored, net_timing_ignored;
+    // Whether net_bounds and net_arc_delay match the current placement
+    bool cost_cache_valid = false;
 
     // Fast lookup for cell port to net user index
     std::unordered_map<const PortInfo *, size_t> fast_port_to_user;
@@ -1249,6 +1666,11 @@ Placer1Cfg::Placer1Cfg(Context *ctx)
     slack_redist_iter = ctx->setting<int>("slack_redist_iter");
     hpwl_scale_x = 1;
     hpwl_scale_y = 1;
+#ifdef NPNR_DISABLE_THREADS
+    threads = 1;
+#else
+    threads = std::max(1, ctx->setting<int>("placer1/threads", 1));
+#endif
 }
 
 bool placer1(Context *ctx, Placer1Cfg cfg)
@@ -35,6 +35,8 @@ struct Placer1Cfg
     bool timing_driven;
     int slack_redist_iter;
     int hpwl_scale_x, hpwl_scale_y;
+    // Number of threads for windowed parallel annealing, 1 for the original serial annealer
+    int threads;
 };
 
 extern bool placer1(Context *ctx, Placer1Cfg cfg);
@@ -36,8 +36,13 @@
 #include "placer_heap.h"
 #include <Eigen/Core>
 #include <Eigen/IterativeLinearSolvers>
+#include <atomic>
 #include <boost/optional.hpp>
+#ifndef NPNR_DISABLE_THREADS
+#include <boost/thread/barrier.hpp>
+#endif
 #include <chrono>
+#include <cmath>
 #include <deque>
 #include <fstream>
 #include <numeric>
@@ -47,6 +52,7 @@
 #include "fast_bels.h"
 #include "log.h"
 #include "nextpnr.h"
+#include "parallel.h"
 #include "place_common.h"
 #include "placer1.h"
 #include "scope_lock.h"
@@ -99,12 +105,27 @@ template <typename T> struct EquationSystem
 
     void add_rhs(int row, T val) { rhs[row] += val; }
 
-    void solve(std::vector<T> &x, float tolerance)
+    void solve(std::vector<T> &x, float tolerance, PlacerHeapCfg::SolverBackend backend, int threads)
     {
-        using namespace Eigen;
         if (x.empty())
             return;
         NPNR_ASSERT(x.size() == A.size());
+        if (backend == PlacerHeapCfg::SOLVER_EIGEN) {
+            solve_eigen(x, tolerance);
+        } else {
+            bool same_pattern = build_csr();
+            if (backend == PlacerHeapCfg::SOLVER_IC0)
+                factorise_ic0(same_pattern);
+            solve_pcg(x, tolerance, backend == PlacerHeapCfg::SOLVER_IC0, threads);
+        }
+        // for (int i = 0; i < int(x.size()); i++)
+        //    log_info("x[%d] = %f\n", i, x.at(i));
+    }
+
+  private:
+    void solve_eigen(std::vector<T> &x, float tolerance)
+    {
+        using namespace Eigen;
 
         VectorXd vx(x.size()), vb(rhs.size());
         SparseMatrix<T> mat(A.size(), A.size());
@@ -129,8 +150,252 @@ template <typename T> struct EquationSystem
         VectorXd xr = solver.compute(mat).solveWithGuess(vb, vx);
         for (int i = 0; i < int(x.size()); i++)
             x.at(i) = xr[i];
-        // for (int i = 0; i < int(x.size()); i++)
-        //    log_info("x[%d] = %f\n", i, x.at(i));
+    }
+
+    // The matrix in compressed sparse row form, and the incomplete Cholesky factor L (lower triangle, diagonal last
+    // in each row). These, and the solver vectors, are members so their storage is reused between solves; the sparsity
+    // pattern (row_start, col_idx, l_start and l_col) is only rebuilt when the connectivity changes
+    std::vector<int> row_start, col_idx, l_start, l_col;
+    std::vector<T> values, diag, l_val;
+    std::vector<T> r, z, p, q;
+
+    // Copy A into the CSR arrays, returning true if the sparsity pattern was the same as for the last solve
+    bool build_csr()
+    {
+        // The matrix is symmetric, so the columns of A can be used directly as rows
+        int n = int(A.size());
+        bool same_pattern = (int(row_start.size()) == n + 1);
+        for (int i = 0; same_pattern && i < n; i++) {
+            const auto &Ai = A.at(i);
+            int start = row_start.at(i);
+            if (int(Ai.size()) != row_start.at(i + 1) - start) {
+                same_pattern = false;
+                break;
+            }
+            for (int j = 0; j < int(Ai.size()); j++) {
+                if (col_idx.at(start + j) != Ai.at(j).first) {
+                    same_pattern = false;
+                    break;
+                }
+            }
+        }
+        if (!same_pattern) {
+            row_start.clear();
+            col_idx.clear();
+            for (int i = 0; i < n; i++) {
+                row_start.push_back(int(col_idx.size()));
+                for (auto &el : A.at(i))
+                    col_idx.push_back(el.first);
+            }
+            row_start.push_back(int(col_idx.size()));
+        }
+        values.resize(col_idx.size());
+        diag.assign(n, T());
+        for (int i = 0; i < n; i++) {
+            int e = row_start.at(i);
+            for (auto &el : A.at(i)) {
+                values.at(e++) = el.second;
+                if (el.first == i)
+                    diag.at(i) = el.second;
+            }
+        }
+        return same_pattern;
+    }
+
+    // Zero fill-in incomplete Cholesky factorisation. Cells in groups without any fixed connections give a singular
+    // matrix, so pivots that vanish are replaced by the original diagonal rather than failing
+    void factorise_ic0(bool same_pattern)
+    {
+        int n = int(A.size());
+        if (!same_pattern || l_start.empty()) {
+            l_start.clear();
+            l_col.clear();
+            for (int i = 0; i < n; i++) {
+                l_start.push_back(int(l_col.size()));
+                for (int e = row_start.at(i); e < row_start.at(i + 1) && col_idx.at(e) < i; e++)
+                    l_col.push_back(col_idx.at(e));
+                l_col.push_back(i);
+            }
+            l_start.push_back(int(l_col.size()));
+        }
+        // The lower triangle of each row is a prefix of the row in the CSR matrix, followed by the diagonal
+        l_val.resize(l_col.size());
+        for (int i = 0; i < n; i++) {
+            int row_diag = l_start.at(i + 1) - 1;
+            for (int e = l_start.at(i), f = row_start.at(i); e < row_diag; e++, f++)
+                l_val.at(e) = values.at(f);
+            l_val.at(row_diag) = diag.at(i);
+        }
+
+        for (int i = 0; i < n; i++) {
+            int row_diag = l_start.at(i + 1) - 1;
+            T sum_sq = T();
+            for (int e = l_start.at(i); e < row_diag; e++) {
+                int k = l_col.at(e);
+                // Dot product of the already factorised parts of rows i and k, over the columns left of k
+                T s = l_val.at(e);
+                int a = l_start.at(i), b = l_start.at(k), b_end = l_start.at(k + 1) - 1;
+                while (a < e && b < b_end) {
+                    if (l_col.at(a) < l_col.at(b)) {
+                        a++;
+                    } else if (l_col.at(a) > l_col.at(b)) {
+                        b++;
+                    } else {
+                        s -= l_val.at(a++) * l_val.at(b++);
+                    }
+                }
+                l_val.at(e) = s / l_val.at(b_end);
+                sum_sq += l_val.at(e) * l_val.at(e);
+            }
+            T pivot = l_val.at(row_diag) - sum_sq;
+            T orig = diag.at(i);
+            if (pivot > orig * T(1e-10))
+                l_val.at(row_diag) = std::sqrt(pivot);
+            else
+                l_val.at(row_diag) = (orig > T()) ? std::sqrt(orig) : T(1);
+        }
+    }
+
+    // Solve L L^T z = r. This is inherently serial
+    void apply_ic0()
+    {
+        int n = int(A.size());
+        for (int i = 0; i < n; i++) {
+            T s = r.at(i);
+            int row_diag = l_start.at(i + 1) - 1;
+            for (int e = l_start.at(i); e < row_diag; e++)
+                s -= l_val.at(e) * z.at(l_col.at(e));
+            z.at(i) = s / l_val.at(row_diag);
+        }
+        for (int i = n - 1; i >= 0; i--) {
+            int row_diag = l_start.at(i + 1) - 1;
+            z.at(i) /= l_val.at(row_diag);
+            for (int e = l_start.at(i); e < row_diag; e++)
+                z.at(l_col.at(e)) -= l_val.at(e) * z.at(i);
+        }
+    }
+
+    // Preconditioned conjugate gradient, with the same stopping criteria as Eigen's ConjugateGradient. Rows are
+    // split into fixed size blocks that are shared out between threads; dot products are summed per block and then
+    // over blocks in order, so the result doesn't depend on the number of threads
+    void solve_pcg(std::vector<T> &x, float tolerance, bool use_ic0, int threads)
+    {
+        const int block_size = 4096;
+        int n = int(A.size());
+        int n_blocks = (n + block_size - 1) / block_size;
+        r.resize(n);
+        z.resize(n);
+        p.resize(n);
+        q.resize(n);
+        std::vector<T> bb_sums(n_blocks), pq_sums(n_blocks), rr_sums(n_blocks), rz_sums(n_blocks);
+        auto total = [&](const std::vector<T> &sums) {
+            T t = T();
+            for (auto s : sums)
+                t += s;
+            return t;
+        };
+        auto apply_jacobi = [&](int i) { z.at(i) = r.at(i) / ((diag.at(i) == T()) ? T(1) : diag.at(i)); };
+        // Not worth the synchronisation overhead for small systems
+        int n_threads = (n >= 8 * block_size) ? std::max(1, std::min(threads, n_blocks)) : 1;
+#ifndef NPNR_DISABLE_THREADS
+        boost::barrier barrier(n_threads);
+#endif
+        auto sync = [&]() {
+#ifndef NPNR_DISABLE_THREADS
+            if (n_threads > 1)
+                barrier.wait();
+#endif
+        };
+
+        auto worker = [&](int tid) {
+            int block_begin = (tid * n_blocks) / n_threads, block_end = ((tid + 1) * n_blocks) / n_threads;
+            // Call func(i) for all my rows, and store the sum of the returned values per block
+            auto for_rows = [&](std::vector<T> &sums, auto func) {
+                for (int blk = block_begin; blk < block_end; blk++) {
+                    T sum = T();
+                    for (int i = blk * block_size; i < std::min(n, (blk + 1) * block_size); i++)
+                        sum += func(i);
+                    sums.at(blk) = sum;
+                }
+            };
+            auto for_rows_nosum = [&](auto func) {
+                for (int i = std::min(n, block_begin * block_size); i < std::min(n, block_end * block_size); i++)
+                    func(i);
+            };
+            // Compute z = M^-1 r and the partial sums of r.z; r must be up to date for all rows
+            auto precondition = [&]() {
+                if (use_ic0) {
+                    if (tid == 0)
+                        apply_ic0();
+                    sync();
+                    for_rows(rz_sums, [&](int i) { return r.at(i) * z.at(i); });
+                } else {
+                    for_rows(rz_sums, [&](int i) {
+                        apply_jacobi(i);
+                        return r.at(i) * z.at(i);
+                    });
+                }
+            };
+
+            for_rows(bb_sums, [&](int i) {
+                T ax = T();
+                for (int e = row_start.at(i); e < row_start.at(i + 1); e++)
+                    ax += values.at(e) * x.at(col_idx.at(e));
+                r.at(i) = rhs.at(i) - ax;
+                return rhs.at(i) * rhs.at(i);
+            });
+            for_rows(rr_sums, [&](int i) { return r.at(i) * r.at(i); });
+            sync();
+            T rhs_norm2 = total(bb_sums);
+            if (rhs_norm2 == T()) {
+                for_rows_nosum([&](int i) { x.at(i) = T(); });
+                return;
+            }
+            T threshold = T(tolerance) * T(tolerance) * rhs_norm2;
+            if (total(rr_sums) < threshold)
+                return;
+            precondition();
+            for_rows_nosum([&](int i) { p.at(i) = z.at(i); });
+            sync();
+            T abs_new = total(rz_sums);
+            for (int iter = 0; iter < 2 * n; iter++) {
+                for_rows(pq_sums, [&](int i) {
+                    T ap = T();
+                    for (int e = row_start.at(i); e < row_start.at(i + 1); e++)
+                        ap += values.at(e) * p.at(col_idx.at(e));
+                    q.at(i) = ap;
+                    return p.at(i) * ap;
+                });
+                sync();
+                T alpha = abs_new / total(pq_sums);
+                for_rows(rr_sums, [&](int i) {
+                    x.at(i) += alpha * p.at(i);
+                    r.at(i) -= alpha * q.at(i);
+                    return r.at(i) * r.at(i);
+                });
+                sync();
+                if (total(rr_sums) < threshold)
+                    break;
+                precondition();
+                sync();
+                T abs_old = abs_new;
+                abs_new = total(rz_sums);
+                T beta = abs_new / abs_old;
+                for_rows_nosum([&](int i) { p.at(i) = z.at(i) + beta * p.at(i); });
+                sync();
+            }
+        };
+
+#ifndef NPNR_DISABLE_THREADS
+        std::vector<boost::thread> workers;
+        for (int i = 1; i < n_threads; i++)
+            workers.emplace_back([&worker, i]() { worker(i); });
+        worker(0);
+        for (auto &w : workers)
+            w.join();
+#else
+        worker(0);
+#endif
     }
 };
 
@@ -145,6 +410,16 @@ class HeAPPlacer
         Eigen::initParallel();
         tmg.setup_only = true;
         tmg.setup();
+
+        decltype(CellInfo::udata) n = 0;
+        for (auto &cell : ctx->cells) {
+            cell.second->udata = n++;
+            cell_by_udata.push_back(cell.second.get());
+        }
+        cell_locs.resize(n);
+        solve_row.resize(n, dont_solve);
+        chain_root.resize(n, nullptr);
+        chain_size.resize(n, 0);
     }
 
     bool place()
@@ -152,32 +427,14 @@ class HeAPPlacer
         auto startt = std::chrono::high_resolution_clock::now();
 
         ScopeLock<Context> lock(ctx);
-        place_constraints();
-        build_fast_bels();
-        seed_placement();
-        update_all_chains();
-        wirelen_t hpwl = total_hpwl();
-        log_info("Creating initial analytic placement for %d cells, random placement wirelen = %d.\n",
-                 int(place_cells.size()), int(hpwl));
-        for (int i = 0; i < 4; i++) {
-            setup_solve_cells();
-            auto solve_startt = std::chrono::high_resolution_clock::now();
-#ifdef NPNR_DISABLE_THREADS
-            build_solve_direction(false, -1);
-            build_solve_direction(true, -1);
-#else
-            boost::thread xaxis([&]() { build_solve_direction(false, -1); });
-            build_solve_direction(true, -1);
-            xaxis.join();
-#endif
-            auto solve_endt = std::chrono::high_resolution_clock::now();
-            solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
-
-            update_all_chains();
-
-            hpwl = total_hpwl();
-            log_info("    at initial placer iter %d, wirelen = %d\n", i, int(hpwl));
-        }
+        seed_initial_placement();
+        // With multilevel placement, the flat solve starts from the placement of the clustered netlist, so needs fewer
+        // iterations
+        int flat_iters = 4;
+        if (cfg.multilevel && multilevel_initial_placement())
+            flat_iters = 2;
+        for (int i = 0; i < flat_iters; i++)
+            initial_solve(i);
 
         wirelen_t solved_hpwl = 0, spread_hpwl = 0, legal_hpwl = 0, best_hpwl = std::numeric_limits<wirelen_t>::max();
         int iter = 0, stalled = 0;
@@ -286,9 +543,11 @@ class HeAPPlacer
                 ++stalled;
             }
             for (auto &cl : cell_locs) {
-                cl.second.legal_x = cl.second.x;
-                cl.second.legal_y = cl.second.y;
+                cl.legal_x = cl.x;
+                cl.legal_y = cl.y;
             }
+            if (cfg.congestionDriven)
+                update_congestion();
             ctx->yield();
             ++iter;
         }
@@ -307,6 +566,46 @@ class HeAPPlacer
             ctx->bindBel(bel, cell, strength);
         }
 
+        return finish_placement(startt, lock);
+    }
+
+  private:
+    friend class HeAPSession;
+
+    // Place constrained cells and make a random initial placement of the others
+    void seed_initial_placement()
+    {
+        place_constraints();
+        build_fast_bels();
+        seed_placement();
+        update_all_chains();
+        log_info("Creating initial analytic placement for %d cells, random placement wirelen = %d.\n",
+                 int(place_cells.size()), int(total_hpwl()));
+    }
+
+    // Solve the unconstrained quadratic placement of all cells, without any spreading
+    void initial_solve(int iter)
+    {
+        setup_solve_cells();
+        auto solve_startt = std::chrono::high_resolution_clock::now();
+#ifdef NPNR_DISABLE_THREADS
+        build_solve_direction(false, -1);
+        build_solve_direction(true, -1);
+#else
+        boost::thread xaxis([&]() { build_solve_direction(false, -1); });
+        build_solve_direction(true, -1);
+        xaxis.join();
+#endif
+        auto solve_endt = std::chrono::high_resolution_clock::now();
+        solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
+
+        update_all_chains();
+        log_info("    at initial placer iter %d, wirelen = %d\n", iter, int(total_hpwl()));
+    }
+
+    // Check the final placement, then run detailed placement
+    bool finish_placement(std::chrono::high_resolution_clock::time_point startt, ScopeLock<Context> &lock)
+    {
         for (auto cell : sorted(ctx->cells)) {
             if (cell.second->bel == BelId())
                 log_error("Found unbound cell %s\n", cell.first.c_str(ctx));
@@ -338,6 +637,8 @@ class HeAPPlacer
         log_info("HeAP Placer Time: %.02fs\n", std::chrono::duration<double>(endtt - startt).count());
         log_info("  of which solving equations: %.02fs\n", solve_time);
         log_info("  of which spreading cells: %.02fs\n", cl_time);
+        if (global_time > 0)
+            log_info("  of which global placement: %.02fs\n", global_time);
         log_info("  of which strict legalisation: %.02fs\n", sl_time);
 
         ctx->check();
@@ -347,10 +648,13 @@ class HeAPPlacer
             return false;
         }
 
+        // Only report once refinement has finished, so that the estimate is for the final placement
+        if (cfg.congestionDriven || !cfg.congestionMap.empty())
+            report_congestion();
+
         return true;
     }
 
-  private:
     Context *ctx;
     PlacerHeapCfg cfg;
 
@@ -377,7 +681,13 @@ class HeAPPlacer
         double rawx, rawy;
         bool locked, global;
     };
-    std::unordered_map<IdString, CellLocation> cell_locs;
+    // All cells, indexed densely by their udata for the duration of placement; the per-cell state below is kept in flat
+    // vectors using the same index, so the hot loops don't need to hash cell names
+    std::vector<CellInfo *> cell_by_udata;
+    std::vector<CellLocation> cell_locs;
+    // RUDY routing demand at each location, and the factor by which spreading capacity is reduced there for
+    // congestion-driven placement (empty if not yet computed)
+    std::vector<std::vector<float>> rudy, cong_inflation;
     // The set of cells that we will actually place. This excludes locked cells and children cells of macros/chains
     // (only the root of each macro is placed.)
     std::vector<CellInfo *> place_cells;
@@ -386,16 +696,22 @@ class HeAPPlacer
     // cells of a certain type)
     std::vector<CellInfo *> solve_cells;
 
-    // For cells in a chain, this is the ultimate root cell of the chain (sometimes this is not constr_parent
-    // where chains are within chains
-    std::unordered_map<IdString, CellInfo *> chain_root;
-    std::unordered_map<IdString, int> chain_size;
+    typedef decltype(CellInfo::udata) cell_udata_t;
+    cell_udata_t dont_solve = std::numeric_limits<cell_udata_t>::max();
 
-    // The offset from chain_root to a cell in the chain
-    std::unordered_map<IdString, std::pair<int, int>> cell_offsets;
+    // The row of each cell in the equation being solved, or dont_solve. Children of chains share the row of their root
+    std::vector<cell_udata_t> solve_row;
+
+    // For cells in a chain, this is the ultimate root cell of the chain (sometimes this is not constr_parent
+    // where chains are within chains; nullptr for cells that aren't in a chain
+    std::vector<CellInfo *> chain_root;
+    // The number of cells in the chain for each placed cell, zero for other cells
+    std::vector<int> chain_size;
 
     // Performance counting
     double solve_time = 0, cl_time = 0, sl_time = 0;
+    // Time spent in another global placer using HeAPSession
+    double global_time = 0;
 
     // Place cells with the BEL attribute set to constrain them
     void place_constraints()
@@ -495,8 +811,9 @@ class HeAPPlacer
     // Build and solve in one direction
     void build_solve_direction(bool yaxis, int iter)
     {
+        // Kept between iterations, so the solver can reuse its storage
+        EquationSystem<double> esx(solve_cells.size(), solve_cells.size());
         for (int i = 0; i < 5; i++) {
-            EquationSystem<double> esx(solve_cells.size(), solve_cells.size());
             build_equations(esx, yaxis, iter);
             solve_equations(esx, yaxis);
         }
@@ -545,10 +862,10 @@ class HeAPPlacer
             CellInfo *ci = cell.second;
             if (ci->bel != BelId()) {
                 Loc loc = ctx->getBelLocation(ci->bel);
-                cell_locs[cell.first].x = loc.x;
-                cell_locs[cell.first].y = loc.y;
-                cell_locs[cell.first].locked = true;
-                cell_locs[cell.first].global = ctx->getBelGlobalBuf(ci->bel);
+                cell_locs.at(ci->udata).x = loc.x;
+                cell_locs.at(ci->udata).y = loc.y;
+                cell_locs.at(ci->udata).locked = true;
+                cell_locs.at(ci->udata).global = ctx->getBelGlobalBuf(ci->bel);
             } else if (ci->constr_parent == nullptr) {
                 bool placed = false;
                 int attempt_count = 0;
@@ -587,10 +904,10 @@ class HeAPPlacer
                     }
 
                     Loc loc = ctx->getBelLocation(bel);
-                    cell_locs[cell.first].x = loc.x;
-                    cell_locs[cell.first].y = loc.y;
-                    cell_locs[cell.first].locked = false;
-                    cell_locs[cell.first].global = ctx->getBelGlobalBuf(bel);
+                    cell_locs.at(ci->udata).x = loc.x;
+                    cell_locs.at(ci->udata).y = loc.y;
+                    cell_locs.at(ci->udata).locked = false;
+                    cell_locs.at(ci->udata).global = ctx->getBelGlobalBuf(bel);
 
                     // FIXME
                     if (has_connectivity(cell.second) && !cfg.ioBufTypes.count(ci->type)) {
@@ -600,7 +917,7 @@ class HeAPPlacer
                     } else {
                         ctx->bindBel(bel, ci, STRENGTH_STRONG);
                         if (ctx->isBelLocationValid(bel)) {
-                            cell_locs[cell.first].locked = true;
+                            cell_locs.at(ci->udata).locked = true;
                             placed = true;
                             bels_used.insert(bel);
                         } else {
@@ -618,54 +935,242 @@ class HeAPPlacer
     {
         int row = 0;
         solve_cells.clear();
-        // First clear the udata of all cells
-        for (auto cell : sorted(ctx->cells))
-            cell.second->udata = dont_solve;
+        // First clear the row of all cells
+        std::fill(solve_row.begin(), solve_row.end(), dont_solve);
         // Then update cells to be placed, which excludes cell children
         for (auto cell : place_cells) {
             if (buckets && !buckets->count(ctx->getBelBucketForCellType(cell->type)))
                 continue;
-            cell->udata = row++;
+            solve_row.at(cell->udata) = row++;
             solve_cells.push_back(cell);
         }
-        // Finally, update the udata of children
-        for (auto chained : chain_root)
-            ctx->cells.at(chained.first)->udata = chained.second->udata;
+        // Finally, update the row of children
+        update_chain_rows();
         return row;
     }
 
     // Update the location of all children of a chain
     void update_chain(CellInfo *cell, CellInfo *root)
     {
-        const auto &base = cell_locs[cell->name];
+        const auto &base = cell_locs.at(cell->udata);
         for (auto child : cell->constr_children) {
             // FIXME: Improve handling of heterogeneous chains
             if (child->type == root->type)
-                chain_size[root->name]++;
+                chain_size.at(root->udata)++;
             if (child->constr_x != child->UNCONSTR)
-                cell_locs[child->name].x = std::max(0, std::min(max_x, base.x + child->constr_x));
+                cell_locs.at(child->udata).x = std::max(0, std::min(max_x, base.x + child->constr_x));
             else
-                cell_locs[child->name].x = base.x; // better handling of UNCONSTR?
+                cell_locs.at(child->udata).x = base.x; // better handling of UNCONSTR?
             if (child->constr_y != child->UNCONSTR)
-                cell_locs[child->name].y = std::max(0, std::min(max_y, base.y + child->constr_y));
+                cell_locs.at(child->udata).y = std::max(0, std::min(max_y, base.y + child->constr_y));
             else
-                cell_locs[child->name].y = base.y; // better handling of UNCONSTR?
-            chain_root[child->name] = root;
+                cell_locs.at(child->udata).y = base.y; // better handling of UNCONSTR?
+            chain_root.at(child->udata) = root;
             if (!child->constr_children.empty())
                 update_chain(child, root);
         }
     }
 
+    // Give the children of chains the same row as their root
+    void update_chain_rows()
+    {
+        for (size_t i = 0; i < cell_by_udata.size(); i++)
+            if (chain_root.at(i) != nullptr)
+                solve_row.at(i) = solve_row.at(chain_root.at(i)->udata);
+    }
+
     // Update all chains
     void update_all_chains()
     {
         for (auto cell : place_cells) {
-            chain_size[cell->name] = 1;
+            chain_size.at(cell->udata) = 1;
             if (!cell->constr_children.empty())
                 update_chain(cell, cell);
         }
     }
 
+    // A level of the multilevel clustering: the cluster each entry of place_cells belongs to, and the first entry of
+    // place_cells in each cluster, which is used as the cluster's variable in the solve
+    struct ClusterLevel
+    {
+        std::vector<int> cluster_of;
+        std::vector<int> first_cell;
+    };
+
+    // Coarsen the netlist by repeatedly merging pairs of tightly connected clusters, starting from the placed cells
+    // (so chains are already clustered by chain_root). Returns the levels from finest to coarsest, not including the
+    // flat netlist
+    std::vector<ClusterLevel> build_cluster_levels()
+    {
+        std::vector<int> place_idx(cell_by_udata.size(), -1);
+        for (int i = 0; i < int(place_cells.size()); i++)
+            place_idx.at(place_cells.at(i)->udata) = i;
+        auto get_place_idx = [&](CellInfo *cell) {
+            CellInfo *root = chain_root.at(cell->udata);
+            return place_idx.at((root != nullptr) ? root->udata : cell->udata);
+        };
+        // Large nets say little about which cells belong together, so are ignored for clustering
+        const int max_net_size = 32;
+        std::vector<std::vector<int>> net_cells;
+        for (auto net : sorted(ctx->nets)) {
+            NetInfo *ni = net.second;
+            if (ni->driver.cell == nullptr || ni->users.empty() || int(ni->users.size()) >= max_net_size)
+                continue;
+            if (cell_locs.at(ni->driver.cell->udata).global)
+                continue;
+            std::vector<int> cells;
+            foreach_port(ni, [&](PortRef &port, int user_idx) {
+                int idx = get_place_idx(port.cell);
+                if (idx != -1)
+                    cells.push_back(idx);
+            });
+            if (cells.size() >= 2)
+                net_cells.push_back(std::move(cells));
+        }
+
+        std::vector<ClusterLevel> levels;
+        std::vector<int> cluster_of(place_cells.size());
+        std::iota(cluster_of.begin(), cluster_of.end(), 0);
+        int n_clusters = int(place_cells.size());
+        std::vector<int> cluster_size(n_clusters);
+        for (int i = 0; i < n_clusters; i++)
+            cluster_size.at(i) = chain_size.at(place_cells.at(i)->udata);
+        while (int(levels.size()) < cfg.clusterMaxLevels && n_clusters > cfg.clusterMinCount) {
+            // Connection weights between clusters, using the clique net model
+            std::vector<std::unordered_map<int, double>> conn(n_clusters);
+            std::vector<int> net_clusters;
+            for (auto &cells : net_cells) {
+                net_clusters.clear();
+                for (int c : cells)
+                    net_clusters.push_back(cluster_of.at(c));
+                std::sort(net_clusters.begin(), net_clusters.end());
+                net_clusters.erase(std::unique(net_clusters.begin(), net_clusters.end()), net_clusters.end());
+                if (net_clusters.size() < 2)
+                    continue;
+                double weight = 1.0 / (net_clusters.size() - 1);
+                for (int a : net_clusters)
+                    for (int b : net_clusters)
+                        if (a != b)
+                            conn.at(a)[b] += weight;
+            }
+            // The region constraint of each cluster; clusters with different constraints are never merged
+            std::vector<Region *> cluster_region(n_clusters);
+            for (int i = 0; i < int(place_cells.size()); i++)
+                cluster_region.at(cluster_of.at(i)) = place_cells.at(i)->region;
+            // Greedily pair each cluster with its most strongly connected unmatched neighbour, normalised by size so
+            // cluster sizes stay balanced
+            std::vector<int> match(n_clusters, -1);
+            int n_merged = 0;
+            for (int a = 0; a < n_clusters; a++) {
+                if (match.at(a) != -1)
+                    continue;
+                int best = -1;
+                double best_score = 0;
+                for (auto &nb : conn.at(a)) {
+                    int b = nb.first;
+                    if (match.at(b) != -1 || cluster_region.at(a) != cluster_region.at(b) ||
+                        cluster_size.at(a) + cluster_size.at(b) > cfg.clusterMaxSize)
+                        continue;
+                    double score = nb.second / (cluster_size.at(a) + cluster_size.at(b));
+                    if (score > best_score || (score == best_score && b < best)) {
+                        best = b;
+                        best_score = score;
+                    }
+                }
+                match.at(a) = (best == -1) ? a : best;
+                if (best != -1) {
+                    match.at(best) = a;
+                    ++n_merged;
+                }
+            }
+            // Stop once coarsening is no longer effective
+            if (n_merged < 0.1 * n_clusters)
+                break;
+            // Renumber clusters in order of their first cell
+            ClusterLevel level;
+            std::vector<int> new_id(n_clusters, -1);
+            std::vector<int> new_size;
+            level.cluster_of.resize(place_cells.size());
+            for (int i = 0; i < int(place_cells.size()); i++) {
+                int old = cluster_of.at(i), pair = std::min(old, match.at(old));
+                if (new_id.at(pair) == -1) {
+                    new_id.at(pair) = int(level.first_cell.size());
+                    level.first_cell.push_back(i);
+                    new_size.push_back(cluster_size.at(old) +
+                                       ((match.at(old) != old) ? cluster_size.at(match.at(old)) : 0));
+                }
+                level.cluster_of.at(i) = new_id.at(pair);
+            }
+            cluster_of = level.cluster_of;
+            cluster_size = new_size;
+            n_clusters = int(level.first_cell.size());
+            levels.push_back(std::move(level));
+        }
+        return levels;
+    }
+
+    // Setup the clusters of a level to be solved, with one row per cluster
+    void setup_cluster_solve_cells(const ClusterLevel &level)
+    {
+        solve_cells.clear();
+        std::fill(solve_row.begin(), solve_row.end(), dont_solve);
+        for (int i = 0; i < int(place_cells.size()); i++)
+            solve_row.at(place_cells.at(i)->udata) = level.cluster_of.at(i);
+        for (int first : level.first_cell)
+            solve_cells.push_back(place_cells.at(first));
+        update_chain_rows();
+    }
+
+    // Move all cells to the solved location of their cluster
+    void apply_cluster_locs(const ClusterLevel &level)
+    {
+        for (int i = 0; i < int(place_cells.size()); i++) {
+            const auto &cluster_loc = cell_locs.at(solve_cells.at(level.cluster_of.at(i))->udata);
+            auto &loc = cell_locs.at(place_cells.at(i)->udata);
+            loc.x = cluster_loc.x;
+            loc.y = cluster_loc.y;
+            loc.rawx = cluster_loc.rawx;
+            loc.rawy = cluster_loc.rawy;
+        }
+    }
+
+    // Create the initial placement by solving the clustered netlist, starting from the coarsest level, with each
+    // level starting from the solution of the level above. Returns false if the netlist couldn't be coarsened
+    bool multilevel_initial_placement()
+    {
+        auto levels = build_cluster_levels();
+        if (levels.empty())
+            return false;
+        for (int l = int(levels.size()) - 1; l >= 0; l--) {
+            auto &level = levels.at(l);
+            // The coarse solves are cheap, so the coarsest level does most of the work of moving cells from their
+            // random starting positions
+            int iters = (l == int(levels.size()) - 1) ? 4 : 2;
+            for (int i = 0; i < iters; i++) {
+                setup_cluster_solve_cells(level);
+                auto solve_startt = std::chrono::high_resolution_clock::now();
+#ifndef NPNR_DISABLE_THREADS
+                if (solve_cells.size() >= 500) {
+                    boost::thread xaxis([&]() { build_solve_direction(false, -1); });
+                    build_solve_direction(true, -1);
+                    xaxis.join();
+                } else
+#endif
+                {
+                    build_solve_direction(false, -1);
+                    build_solve_direction(true, -1);
+                }
+                auto solve_endt = std::chrono::high_resolution_clock::now();
+                solve_time += std::chrono::duration<double>(solve_endt - solve_startt).count();
+                apply_cluster_locs(level);
+                update_all_chains();
+            }
+            log_info("    at clustering level %d (%d clusters), wirelen = %d\n", l + 1, int(level.first_cell.size()),
+                     int(total_hpwl()));
+        }
+        return true;
+    }
+
     // Run a function on all ports of a net - including the driver and all users
     template <typename Tf> void foreach_port(NetInfo *net, Tf func)
     {
@@ -679,9 +1184,11 @@ class HeAPPlacer
     void build_equations(EquationSystem<double> &es, bool yaxis, int iter = -1)
     {
         // Return the x or y position of a cell, depending on ydir
-        auto cell_pos = [&](CellInfo *cell) { return yaxis ? cell_locs.at(cell->name).y : cell_locs.at(cell->name).x; };
+        auto cell_pos = [&](CellInfo *cell) {
+            return yaxis ? cell_locs.at(cell->udata).y : cell_locs.at(cell->udata).x;
+        };
         auto legal_pos = [&](CellInfo *cell) {
-            return yaxis ? cell_locs.at(cell->name).legal_y : cell_locs.at(cell->name).legal_x;
+            return yaxis ? cell_locs.at(cell->udata).legal_y : cell_locs.at(cell->udata).legal_x;
         };
 
         es.reset();
@@ -692,7 +1199,7 @@ class HeAPPlacer
                 continue;
             if (ni->users.empty())
                 continue;
-            if (cell_locs.at(ni->driver.cell->name).global)
+            if (cell_locs.at(ni->driver.cell->udata).global)
                 continue;
             // Find the bounds of the net in this axis, and the ports that correspond to these bounds
             PortRef *lbport = nullptr, *ubport = nullptr;
@@ -712,19 +1219,14 @@ class HeAPPlacer
             NPNR_ASSERT(ubport != nullptr);
 
             auto stamp_equation = [&](PortRef &var, PortRef &eqn, double weight) {
-                if (eqn.cell->udata == dont_solve)
+                cell_udata_t row = solve_row.at(eqn.cell->udata);
+                if (row == dont_solve)
                     return;
-                int row = eqn.cell->udata;
-                int v_pos = cell_pos(var.cell);
-                if (var.cell->udata != dont_solve) {
-                    es.add_coeff(row, var.cell->udata, weight);
+                cell_udata_t var_row = solve_row.at(var.cell->udata);
+                if (var_row != dont_solve) {
+                    es.add_coeff(row, var_row, weight);
                 } else {
-                    es.add_rhs(row, -v_pos * weight);
-                }
-                if (cell_offsets.count(var.cell->name)) {
-                    es.add_rhs(row, -(yaxis ? cell_offsets.at(var.cell->name).second
-                                            : cell_offsets.at(var.cell->name).first) *
-                                            weight);
+                    es.add_rhs(row, -cell_pos(var.cell) * weight);
                 }
             };
 
@@ -775,23 +1277,26 @@ class HeAPPlacer
     void solve_equations(EquationSystem<double> &es, bool yaxis)
     {
         // Return the x or y position of a cell, depending on ydir
-        auto cell_pos = [&](CellInfo *cell) { return yaxis ? cell_locs.at(cell->name).y : cell_locs.at(cell->name).x; };
+        auto cell_pos = [&](CellInfo *cell) {
+            return yaxis ? cell_locs.at(cell->udata).y : cell_locs.at(cell->udata).x;
+        };
         std::vector<double> vals;
         std::transform(solve_cells.begin(), solve_cells.end(), std::back_inserter(vals), cell_pos);
-        es.solve(vals, cfg.solverTolerance);
+        // The x and y axes are usually solved at the same time, so each gets half the threads
+        es.solve(vals, cfg.solverTolerance, cfg.solver, std::max(1, cfg.threads / 2));
         for (size_t i = 0; i < vals.size(); i++)
             if (yaxis) {
-                cell_locs.at(solve_cells.at(i)->name).rawy = vals.at(i);
-                cell_locs.at(solve_cells.at(i)->name).y = std::min(max_y, std::max(0, int(vals.at(i))));
+                cell_locs.at(solve_cells.at(i)->udata).rawy = vals.at(i);
+                cell_locs.at(solve_cells.at(i)->udata).y = std::min(max_y, std::max(0, int(vals.at(i))));
                 if (solve_cells.at(i)->region != nullptr)
-                    cell_locs.at(solve_cells.at(i)->name).y =
-                            limit_to_reg(solve_cells.at(i)->region, cell_locs.at(solve_cells.at(i)->name).y, true);
+                    cell_locs.at(solve_cells.at(i)->udata).y =
+                            limit_to_reg(solve_cells.at(i)->region, cell_locs.at(solve_cells.at(i)->udata).y, true);
             } else {
-                cell_locs.at(solve_cells.at(i)->name).rawx = vals.at(i);
-                cell_locs.at(solve_cells.at(i)->name).x = std::min(max_x, std::max(0, int(vals.at(i))));
+                cell_locs.at(solve_cells.at(i)->udata).rawx = vals.at(i);
+                cell_locs.at(solve_cells.at(i)->udata).x = std::min(max_x, std::max(0, int(vals.at(i))));
                 if (solve_cells.at(i)->region != nullptr)
-                    cell_locs.at(solve_cells.at(i)->name).x =
-                            limit_to_reg(solve_cells.at(i)->region, cell_locs.at(solve_cells.at(i)->name).x, false);
+                    cell_locs.at(solve_cells.at(i)->udata).x =
+                            limit_to_reg(solve_cells.at(i)->region, cell_locs.at(solve_cells.at(i)->udata).x, false);
             }
     }
 
@@ -803,12 +1308,12 @@ class HeAPPlacer
             NetInfo *ni = net.second;
             if (ni->driver.cell == nullptr)
                 continue;
-            CellLocation &drvloc = cell_locs.at(ni->driver.cell->name);
+            CellLocation &drvloc = cell_locs.at(ni->driver.cell->udata);
             if (drvloc.global)
                 continue;
             int xmin = drvloc.x, xmax = drvloc.x, ymin = drvloc.y, ymax = drvloc.y;
             for (auto &user : ni->users) {
-                CellLocation &usrloc = cell_locs.at(user.cell->name);
+                CellLocation &usrloc = cell_locs.at(user.cell->udata);
                 xmin = std::min(xmin, usrloc.x);
                 xmax = std::max(xmax, usrloc.x);
                 ymin = std::min(ymin, usrloc.y);
@@ -819,6 +1324,215 @@ class HeAPPlacer
         return hpwl;
     }
 
+    // Estimate routing demand using RUDY (rectangular uniform wire density): the HPWL of each net is spread uniformly
+    // over the locations inside its bounding box
+    void compute_rudy()
+    {
+        // Accumulate into a 2D difference array, so each net is O(1) regardless of its size
+        std::vector<std::vector<double>> diff(max_x + 2, std::vector<double>(max_y + 2, 0));
+        for (auto net : sorted(ctx->nets)) {
+            NetInfo *ni = net.second;
+            if (ni->driver.cell == nullptr || ni->users.empty())
+                continue;
+            CellLocation &drvloc = cell_locs.at(ni->driver.cell->udata);
+            if (drvloc.global)
+                continue;
+            int xmin = drvloc.x, xmax = drvloc.x, ymin = drvloc.y, ymax = drvloc.y;
+            for (auto &user : ni->users) {
+                CellLocation &usrloc = cell_locs.at(user.cell->udata);
+                xmin = std::min(xmin, usrloc.x);
+                xmax = std::max(xmax, usrloc.x);
+                ymin = std::min(ymin, usrloc.y);
+                ymax = std::max(ymax, usrloc.y);
+            }
+            double w = xmax - xmin + 1, h = ymax - ymin + 1;
+            double density = (cfg.hpwl_scale_x * w + cfg.hpwl_scale_y * h) / (w * h);
+            diff.at(xmin).at(ymin) += density;
+            diff.at(xmax + 1).at(ymin) -= density;
+            diff.at(xmin).at(ymax + 1) -= density;
+            diff.at(xmax + 1).at(ymax + 1) += density;
+        }
+        rudy.assign(max_x + 1, std::vector<float>(max_y + 1, 0));
+        for (int x = 0; x <= max_x; x++) {
+            for (int y = 0; y <= max_y; y++) {
+                if (x > 0)
+                    diff.at(x).at(y) += diff.at(x - 1).at(y);
+                if (y > 0)
+                    diff.at(x).at(y) += diff.at(x).at(y - 1);
+                if (x > 0 && y > 0)
+                    diff.at(x).at(y) -= diff.at(x - 1).at(y - 1);
+                // Clamp rounding residue outside of all bounding boxes to zero
+                double d = diff.at(x).at(y);
+                rudy.at(x).at(y) = (d > 1e-6) ? float(d) : 0;
+            }
+        }
+    }
+
+    // Average RUDY demand over all locations with any demand at all
+    float average_rudy()
+    {
+        double total = 0;
+        int count = 0;
+        for (const auto &col : rudy)
+            for (float d : col)
+                if (d > 0) {
+                    total += d;
+                    ++count;
+                }
+        return count > 0 ? float(total / count) : 0;
+    }
+
+    // Recompute routing demand for the current (legalised) placement, and the capacity reduction of hot locations
+    // used by the spreader
+    void update_congestion()
+    {
+        compute_rudy();
+        float limit = cfg.congestionThreshold * average_rudy();
+        cong_inflation.assign(max_x + 1, std::vector<float>(max_y + 1, 1));
+        if (limit <= 0)
+            return;
+        int hot = 0;
+        for (int x = 0; x <= max_x; x++)
+            for (int y = 0; y <= max_y; y++)
+                if (rudy.at(x).at(y) > limit) {
+                    cong_inflation.at(x).at(y) = std::min(cfg.congestionMaxInflation, rudy.at(x).at(y) / limit);
+                    ++hot;
+                }
+        if (ctx->verbose)
+            log_info("    congestion estimate: %d locations above threshold\n", hot);
+    }
+
+    // Report the routing demand of the final placement, and write it as a heatmap if requested
+    void report_congestion()
+    {
+        for (auto cell : cell_by_udata) {
+            Loc loc = ctx->getBelLocation(cell->bel);
+            cell_locs.at(cell->udata).x = loc.x;
+            cell_locs.at(cell->udata).y = loc.y;
+        }
+        compute_rudy();
+        float avg = average_rudy(), peak = 0;
+        int hot = 0;
+        for (const auto &col : rudy)
+            for (float d : col) {
+                peak = std::max(peak, d);
+                if (d > cfg.congestionThreshold * avg)
+                    ++hot;
+            }
+        log_info("Routing demand estimate (RUDY): average %.2f, peak %.2f, %d locations above %.1fx average\n", avg,
+                 peak, hot, cfg.congestionThreshold);
+        if (!cfg.congestionMap.empty()) {
+            std::ofstream out(cfg.congestionMap);
+            if (!out)
+                log_error("Failed to open congestion map file '%s' for writing\n", cfg.congestionMap.c_str());
+            // Same layout as the router2 heatmaps: one row per y coordinate
+            for (int y = 0; y <= max_y; y++) {
+                for (int x = 0; x <= max_x; x++)
+                    out << rudy.at(x).at(y) << ",";
+                out << std::endl;
+            }
+        }
+    }
+
+    // Parallel pass of strict legalisation for the unconstrained cells, run once the macros have been placed. The
+    // device is split into square bins; each bin finds the nearest free bel within the bin plus a halo around it for
+    // each of the unconstrained cells whose solver location is in the bin, considering only the bels claimed by its
+    // own cells (binding isn't thread safe, so nothing is bound here). The proposals are then bound serially in bin
+    // order. Cells whose bel was already taken by a neighbouring bin, or turned out not to be valid, are left for the
+    // serial legaliser in remaining.
+    void legalise_binned(std::priority_queue<std::pair<int, IdString>> &remaining, bool require_validity)
+    {
+        int side = std::max(1, cfg.legaliseBinSize), halo = std::max(1, side / 4);
+        int nbx = max_x / side + 1, nby = max_y / side + 1;
+        std::vector<std::vector<CellInfo *>> bin_cells(nbx * nby);
+        // FastBels isn't thread safe if a cell type is missing, so fetch everything needed up front
+        std::unordered_map<IdString, FastBels::FastBelsData *> type_bels;
+        for (auto cell : solve_cells) {
+            if (is_macro_root(cell))
+                continue;
+            if (!type_bels.count(cell->type))
+                fast_bels.getBelsForCellType(cell->type, &type_bels[cell->type]);
+            const CellLocation &loc = cell_locs.at(cell->udata);
+            bin_cells.at((loc.y / side) * nbx + (loc.x / side)).push_back(cell);
+        }
+
+        std::vector<std::vector<BelId>> bin_bels(bin_cells.size());
+        for_each_parallel(cfg.threads, bin_cells.size(), [&](size_t b) {
+            const auto &cells = bin_cells.at(b);
+            auto &bels = bin_bels.at(b);
+            bels.resize(cells.size());
+            int x0 = std::max(0, int(b % nbx) * side - halo), x1 = std::min(max_x, int(b % nbx + 1) * side - 1 + halo);
+            int y0 = std::max(0, int(b / nbx) * side - halo), y1 = std::min(max_y, int(b / nbx + 1) * side - 1 + halo);
+            std::unordered_set<BelId> claimed;
+            for (size_t i = 0; i < cells.size(); i++) {
+                CellInfo *ci = cells.at(i);
+                const FastBels::FastBelsData *fb = type_bels.at(ci->type);
+                const CellLocation &loc = cell_locs.at(ci->udata);
+                BelId best_bel;
+                int best_inp_len = std::numeric_limits<int>::max();
+                // Search rings of increasing radius around the solver location, and pick the free bel with the best
+                // input wirelength in the first ring that has any
+                for (int radius = 0; best_bel == BelId() && radius <= side + halo; radius++) {
+                    for (int x = std::max(x0, loc.x - radius); x <= std::min(x1, loc.x + radius); x++) {
+                        if (x >= int(fb->size()))
+                            break;
+                        for (int y = std::max(y0, loc.y - radius); y <= std::min(y1, loc.y + radius); y++) {
+                            if (y >= int(fb->at(x).size()))
+                                break;
+                            if (std::max(std::abs(x - loc.x), std::abs(y - loc.y)) != radius)
+                                continue;
+                            for (auto bel : fb->at(x).at(y)) {
+                                if (!ci->testRegion(bel) || !ctx->checkBelAvail(bel) || claimed.count(bel))
+                                    continue;
+                                // Same metric as legalise_placement_strict
+                                int input_len = 0;
+                                for (auto &port : ci->ports) {
+                                    auto &p = port.second;
+                                    if (p.type != PORT_IN || p.net == nullptr || p.net->driver.cell == nullptr)
+                                        continue;
+                                    const CellLocation &drv_loc = cell_locs.at(p.net->driver.cell->udata);
+                                    if (drv_loc.global)
+                                        continue;
+                                    input_len += std::abs(drv_loc.x - x) + std::abs(drv_loc.y - y);
+                                }
+                                if (input_len < best_inp_len) {
+                                    best_inp_len = input_len;
+                                    best_bel = bel;
+                                }
+                                break;
+                            }
+                        }
+                    }
+                }
+                if (best_bel != BelId())
+                    claimed.insert(best_bel);
+                bels.at(i) = best_bel;
+            }
+        });
+
+        int binned = 0;
+        for (size_t b = 0; b < bin_cells.size(); b++) {
+            for (size_t i = 0; i < bin_cells.at(b).size(); i++) {
+                CellInfo *ci = bin_cells.at(b).at(i);
+                BelId bel = bin_bels.at(b).at(i);
+                if (bel != BelId() && ctx->checkBelAvail(bel)) {
+                    ctx->bindBel(bel, ci, STRENGTH_WEAK);
+                    if (!require_validity || ctx->isBelLocationValid(bel)) {
+                        Loc loc = ctx->getBelLocation(bel);
+                        cell_locs.at(ci->udata).x = loc.x;
+                        cell_locs.at(ci->udata).y = loc.y;
+                        ++binned;
+                        continue;
+                    }
+                    ctx->unbindBel(bel);
+                }
+                remaining.emplace(chain_size.at(ci->udata), ci->name);
+            }
+        }
+        if (ctx->verbose)
+            log_info("    binned legalisation placed %d/%d cells\n", binned, int(solve_cells.size()));
+    }
+
     // Strict placement legalisation, performed after the initial HeAP spreading
     void legalise_placement_strict(bool require_validity = false)
     {
@@ -827,17 +1541,37 @@ class HeAPPlacer
         // Unbind all cells placed in this solution
         for (auto cell : sorted(ctx->cells)) {
             CellInfo *ci = cell.second;
-            if (ci->bel != BelId() && (ci->udata != dont_solve ||
-                                       (chain_root.count(ci->name) && chain_root.at(ci->name)->udata != dont_solve)))
+            if (ci->bel != BelId() && solve_row.at(ci->udata) != dont_solve)
                 ctx->unbindBel(ci->bel);
         }
 
         // At the moment we don't follow the full HeAP algorithm using cuts for legalisation, instead using
         // the simple greedy largest-macro-first approach.
         std::priority_queue<std::pair<int, IdString>> remaining;
-        for (auto cell : solve_cells) {
-            remaining.emplace(chain_size[cell->name], cell->name);
+        if (cfg.parallelLegalise) {
+            // Place the macros first, so that they don't have to fit around bels already taken by single cells
+            for (auto cell : solve_cells) {
+                if (is_macro_root(cell))
+                    remaining.emplace(chain_size.at(cell->udata), cell->name);
+            }
+            legalise_queue(remaining, require_validity);
+            legalise_binned(remaining, require_validity);
+        } else {
+            for (auto cell : solve_cells) {
+                remaining.emplace(chain_size.at(cell->udata), cell->name);
+            }
         }
+        legalise_queue(remaining, require_validity);
+
+        auto endt = std::chrono::high_resolution_clock::now();
+        sl_time += std::chrono::duration<float>(endt - startt).count();
+    }
+
+    bool is_macro_root(const CellInfo *cell) const { return !cell->constr_children.empty() || cell->constr_abs_z; }
+
+    // Legalise the cells in remaining, largest macro first. Cells that are ripped up are added back to remaining.
+    void legalise_queue(std::priority_queue<std::pair<int, IdString>> &remaining, bool require_validity)
+    {
         int ripup_radius = 2;
         int total_iters = 0;
         int total_iters_noreset = 0;
@@ -893,8 +1627,8 @@ class HeAPPlacer
                 }
 
                 // Pick a random X and Y location within our search radius
-                int nx = ctx->rng(2 * rx + 1) + std::max(cell_locs.at(ci->name).x - rx, 0);
-                int ny = ctx->rng(2 * ry + 1) + std::max(cell_locs.at(ci->name).y - ry, 0);
+                int nx = ctx->rng(2 * rx + 1) + std::max(cell_locs.at(ci->udata).x - rx, 0);
+                int ny = ctx->rng(2 * ry + 1) + std::max(cell_locs.at(ci->udata).y - ry, 0);
 
                 iter++;
                 iter_at_radius++;
@@ -904,12 +1638,12 @@ class HeAPPlacer
                     while (radius < std::max(max_x, max_y)) {
                         // Keep increasing the radius until it will actually increase the number of cells we are
                         // checking (e.g. BRAM and DSP will not be in all cols/rows), so we don't waste effort
-                        for (int x = std::max(0, cell_locs.at(ci->name).x - radius);
-                             x <= std::min(max_x, cell_locs.at(ci->name).x + radius); x++) {
+                        for (int x = std::max(0, cell_locs.at(ci->udata).x - radius);
+                             x <= std::min(max_x, cell_locs.at(ci->udata).x + radius); x++) {
                             if (x >= int(fb->size()))
                                 break;
-                            for (int y = std::max(0, cell_locs.at(ci->name).y - radius);
-                                 y <= std::min(max_y, cell_locs.at(ci->name).y + radius); y++) {
+                            for (int y = std::max(0, cell_locs.at(ci->udata).y - radius);
+                                 y <= std::min(max_y, cell_locs.at(ci->udata).y + radius); y++) {
                                 if (y >= int(fb->at(x).size()))
                                     break;
                                 if (fb->at(x).at(y).size() > 0)
@@ -945,13 +1679,13 @@ class HeAPPlacer
                     CellInfo *bound = ctx->getBoundBelCell(bestBel);
                     if (bound != nullptr) {
                         ctx->unbindBel(bound->bel);
-                        remaining.emplace(chain_size[bound->name], bound->name);
+                        remaining.emplace(chain_size.at(bound->udata), bound->name);
                     }
                     ctx->bindBel(bestBel, ci, STRENGTH_WEAK);
                     placed = true;
                     Loc loc = ctx->getBelLocation(bestBel);
-                    cell_locs[ci->name].x = loc.x;
-                    cell_locs[ci->name].y = loc.y;
+                    cell_locs.at(ci->udata).x = loc.x;
+                    cell_locs.at(ci->udata).y = loc.y;
                     break;
                 }
 
@@ -992,12 +1726,10 @@ class HeAPPlacer
                                     if (p.type != PORT_IN || p.net == nullptr || p.net->driver.cell == nullptr)
                                         continue;
                                     CellInfo *drv = p.net->driver.cell;
-                                    auto drv_loc = cell_locs.find(drv->name);
-                                    if (drv_loc == cell_locs.end())
-                                        continue;
-                                    if (drv_loc->second.global)
+                                    const CellLocation &drv_loc = cell_locs.at(drv->udata);
+                                    if (drv_loc.global)
                                         continue;
-                                    input_len += std::abs(drv_loc->second.x - nx) + std::abs(drv_loc->second.y - ny);
+                                    input_len += std::abs(drv_loc.x - nx) + std::abs(drv_loc.y - ny);
                                 }
                                 if (input_len < best_inp_len) {
                                     best_inp_len = input_len;
@@ -1007,10 +1739,10 @@ class HeAPPlacer
                             } else {
                                 // It's legal, and we've tried enough. Finish.
                                 if (bound != nullptr)
-                                    remaining.emplace(chain_size[bound->name], bound->name);
+                                    remaining.emplace(chain_size.at(bound->udata), bound->name);
                                 Loc loc = ctx->getBelLocation(sz);
-                                cell_locs[ci->name].x = loc.x;
-                                cell_locs[ci->name].y = loc.y;
+                                cell_locs.at(ci->udata).x = loc.x;
+                                cell_locs.at(ci->udata).y = loc.y;
                                 placed = true;
                                 break;
                             }
@@ -1085,14 +1817,14 @@ class HeAPPlacer
                         }
                         for (auto &target : targets) {
                             Loc loc = ctx->getBelLocation(target.second);
-                            cell_locs[target.first->name].x = loc.x;
-                            cell_locs[target.first->name].y = loc.y;
+                            cell_locs.at(target.first->udata).x = loc.x;
+                            cell_locs.at(target.first->udata).y = loc.y;
                             // log_info("%s %d %d %d\n", target.first->name.c_str(ctx), loc.x, loc.y, loc.z);
                         }
                         for (auto &swap : swaps_made) {
                             // Where we have ripped up cells; add them to the queue
                             if (swap.second != nullptr)
-                                remaining.emplace(chain_size[swap.second->name], swap.second->name);
+                                remaining.emplace(chain_size.at(swap.second->udata), swap.second->name);
                         }
 
                         placed = true;
@@ -1101,8 +1833,6 @@ class HeAPPlacer
                 }
             }
         }
-        auto endt = std::chrono::high_resolution_clock::now();
-        sl_time += std::chrono::duration<float>(endt - startt).count();
     }
     // Implementation of the cut-based spreading as described in the HeAP/SimPL papers
 
@@ -1110,8 +1840,10 @@ class HeAPPlacer
     {
         if (reg == nullptr)
             return val;
-        int limit_low = dir ? constraint_region_bounds[reg->name].y0 : constraint_region_bounds[reg->name].x0;
-        int limit_high = dir ? constraint_region_bounds[reg->name].y1 : constraint_region_bounds[reg->name].x1;
+        // Called from the spreader threads, so must not insert into constraint_region_bounds
+        const BoundingBox &bounds = constraint_region_bounds.at(reg->name);
+        int limit_low = dir ? bounds.y0 : bounds.x0;
+        int limit_high = dir ? bounds.y1 : bounds.x1;
         return std::max<T>(std::min<T>(val, limit_high), limit_low);
     }
 
@@ -1171,12 +1903,13 @@ class HeAPPlacer
 #endif
             }
             expand_regions();
-            std::queue<std::pair<int, bool>> workqueue;
+            // Regions waiting to be cut, and the direction to cut them in
+            std::vector<std::pair<int, bool>> workqueue;
 #if 0
             std::vector<std::pair<double, double>> orig;
             if (ctx->debug)
                 for (auto c : p->solve_cells)
-                    orig.emplace_back(p->cell_locs[c->name].rawx, p->cell_locs[c->name].rawy);
+                    orig.emplace_back(p->cell_locs.at(c->udata).rawx, p->cell_locs.at(c->udata).rawy);
 #endif
             for (auto &r : regions) {
                 if (merged_regions.count(r.id))
@@ -1188,25 +1921,36 @@ class HeAPPlacer
                 }
 
 #endif
-                workqueue.emplace(r.id, false);
+                workqueue.emplace_back(r.id, false);
             }
+            // The regions in the work queue never overlap, so each generation of cuts is independent and is processed
+            // in parallel. New regions are then numbered and queued in work queue order, so the result doesn't
+            // depend on the number of threads
+            std::vector<boost::optional<CutResult>> results;
             while (!workqueue.empty()) {
-                auto front = workqueue.front();
-                workqueue.pop();
-                auto &r = regions.at(front.first);
-                if (std::all_of(r.cells.begin(), r.cells.end(), [](int x) { return x == 0; }))
-                    continue;
-                auto res = cut_region(r, front.second);
-                if (res) {
-                    workqueue.emplace(res->first, !front.second);
-                    workqueue.emplace(res->second, !front.second);
-                } else {
-                    // Try the other dir, in case stuck in one direction only
-                    auto res2 = cut_region(r, !front.second);
-                    if (res2) {
-                        workqueue.emplace(res2->first, front.second);
-                        workqueue.emplace(res2->second, front.second);
+                results.clear();
+                results.resize(workqueue.size());
+                for_each_parallel(p->cfg.threads, workqueue.size(), [&](size_t i) {
+                    auto &front = workqueue.at(i);
+                    const auto &r = regions.at(front.first);
+                    if (std::all_of(r.cells.begin(), r.cells.end(), [](int x) { return x == 0; }))
+                        return;
+                    results.at(i) = cut_region(r, front.second);
+                    if (results.at(i)) {
+                        results.at(i)->next_dir = !front.second;
+                    } else {
+                        // Try the other dir, in case stuck in one direction only
+                        results.at(i) = cut_region(r, !front.second);
+                        if (results.at(i))
+                            results.at(i)->next_dir = front.second;
                     }
+                });
+                workqueue.clear();
+                for (auto &res : results) {
+                    if (!res)
+                        continue;
+                    workqueue.emplace_back(add_region(res->left), res->next_dir);
+                    workqueue.emplace_back(add_region(res->right), res->next_dir);
                 }
             }
 #if 0
@@ -1216,7 +1960,7 @@ class HeAPPlacer
                     auto &c = p->solve_cells.at(i);
                     if (c->type != beltype)
                         continue;
-                    sp << orig.at(i).first << "," << orig.at(i).second << "," << p->cell_locs[c->name].rawx << "," << p->cell_locs[c->name].rawy << std::endl;
+                    sp << orig.at(i).first << "," << orig.at(i).second << "," << p->cell_locs.at(c->udata).rawx << "," << p->cell_locs.at(c->udata).rawy << std::endl;
                 }
                 std::ofstream oc("cells" + std::to_string(seq) + ".csv");
                 for (size_t y = 0; y <= p->max_y; y++) {
@@ -1248,6 +1992,8 @@ class HeAPPlacer
         std::unordered_set<int> merged_regions;
         // Cells at a location, sorted by real (not integer) x and y
         std::vector<std::vector<std::vector<CellInfo *>>> cells_at_location;
+        // Whether bel capacity is reduced at congested locations
+        bool inflate = false;
 
         int occ_at(int x, int y, int type) { return occupancy.at(x).at(y).at(type); }
 
@@ -1255,7 +2001,10 @@ class HeAPPlacer
         {
             if (x >= int(fb.at(type)->size()) || y >= int(fb.at(type)->at(x).size()))
                 return 0;
-            return int(fb.at(type)->at(x).at(y).size());
+            int bels = int(fb.at(type)->at(x).at(y).size());
+            if (inflate && bels > 0)
+                bels = std::max(1, int(bels / p->cong_inflation.at(x).at(y)));
+            return bels;
         }
 
         bool is_cell_fixed(const CellInfo &cell) const
@@ -1292,10 +2041,9 @@ class HeAPPlacer
                 }
             };
 
-            for (auto &cell_loc : p->cell_locs) {
-                IdString cell_name = cell_loc.first;
-                const CellInfo &cell = *ctx->cells.at(cell_name);
-                const CellLocation &loc = cell_loc.second;
+            for (auto ci : p->cell_by_udata) {
+                const CellInfo &cell = *ci;
+                const CellLocation &loc = p->cell_locs.at(ci->udata);
                 if (is_cell_fixed(cell)) {
                     continue;
                 }
@@ -1304,20 +2052,19 @@ class HeAPPlacer
                     continue;
                 }
 
-                occupancy.at(cell_loc.second.x).at(cell_loc.second.y).at(cell_index(cell))++;
+                occupancy.at(loc.x).at(loc.y).at(cell_index(cell))++;
 
                 // Compute ultimate extent of each chain root
-                if (p->chain_root.count(cell_name)) {
-                    set_chain_ext(p->chain_root.at(cell_name)->name, loc.x, loc.y);
-                } else if (!ctx->cells.at(cell_name)->constr_children.empty()) {
-                    set_chain_ext(cell_name, loc.x, loc.y);
+                if (p->chain_root.at(ci->udata) != nullptr) {
+                    set_chain_ext(p->chain_root.at(ci->udata)->name, loc.x, loc.y);
+                } else if (!ci->constr_children.empty()) {
+                    set_chain_ext(ci->name, loc.x, loc.y);
                 }
             }
 
-            for (auto &cell_loc : p->cell_locs) {
-                IdString cell_name = cell_loc.first;
-                const CellInfo &cell = *ctx->cells.at(cell_name);
-                const CellLocation &loc = cell_loc.second;
+            for (auto ci : p->cell_by_udata) {
+                const CellInfo &cell = *ci;
+                const CellLocation &loc = p->cell_locs.at(ci->udata);
                 if (is_cell_fixed(cell)) {
                     continue;
                 }
@@ -1328,10 +2075,10 @@ class HeAPPlacer
 
                 // Transfer chain extents to the actual chains structure
                 ChainExtent *ce = nullptr;
-                if (p->chain_root.count(cell_name)) {
-                    ce = &(cell_extents.at(p->chain_root.at(cell_name)->name));
-                } else if (!ctx->cells.at(cell_name)->constr_children.empty()) {
-                    ce = &(cell_extents.at(cell_name));
+                if (p->chain_root.at(ci->udata) != nullptr) {
+                    ce = &(cell_extents.at(p->chain_root.at(ci->udata)->name));
+                } else if (!ci->constr_children.empty()) {
+                    ce = &(cell_extents.at(ci->name));
                 }
 
                 if (ce) {
@@ -1348,7 +2095,20 @@ class HeAPPlacer
                     continue;
                 }
 
-                cells_at_location.at(p->cell_locs.at(cell->name).x).at(p->cell_locs.at(cell->name).y).push_back(cell);
+                cells_at_location.at(p->cell_locs.at(cell->udata).x).at(p->cell_locs.at(cell->udata).y).push_back(cell);
+            }
+
+            // Only reduce capacity for congestion if there is still enough space left for all cells
+            inflate = !p->cong_inflation.empty();
+            for (size_t t = 0; inflate && t < buckets.size(); t++) {
+                int cells = 0, bels = 0;
+                for (int x = 0; x <= p->max_x; x++)
+                    for (int y = 0; y <= p->max_y; y++) {
+                        cells += occ_at(x, y, t);
+                        bels += bels_at(x, y, t);
+                    }
+                if (cells > p->cfg.beta * bels)
+                    inflate = false;
             }
         }
 
@@ -1547,11 +2307,29 @@ class HeAPPlacer
         // Implementation of the recursive cut-based spreading as described in the HeAP paper
         // Note we use "left" to mean "-x/-y" depending on dir and "right" to mean "+x/+y" depending on dir
 
-        std::vector<CellInfo *> cut_cells;
+        struct CutResult
+        {
+            // The two halves of the cut region, not yet assigned an ID
+            SpreaderRegion left, right;
+            // Direction the halves should be cut in next
+            bool next_dir;
+        };
+
+        int add_region(SpreaderRegion &reg)
+        {
+            reg.id = int(regions.size());
+            for (int x = reg.x0; x <= reg.x1; x++)
+                for (int y = reg.y0; y <= reg.y1; y++)
+                    groups.at(x).at(y) = reg.id;
+            regions.push_back(reg);
+            return reg.id;
+        }
 
-        boost::optional<std::pair<int, int>> cut_region(SpreaderRegion &r, bool dir)
+        // This runs on the spreader threads, so may only modify the cells and locations inside r. The new regions are
+        // returned to run() to be added
+        boost::optional<CutResult> cut_region(const SpreaderRegion &r, bool dir)
         {
-            cut_cells.clear();
+            std::vector<CellInfo *> cut_cells;
             auto &cal = cells_at_location;
             int total_cells = 0, total_bels = 0;
             for (int x = r.x0; x <= r.x1; x++) {
@@ -1562,11 +2340,11 @@ class HeAPPlacer
                 }
             }
             for (auto &cell : cut_cells) {
-                total_cells += p->chain_size.count(cell->name) ? p->chain_size.at(cell->name) : 1;
+                total_cells += p->chain_size.at(cell->udata);
             }
             std::sort(cut_cells.begin(), cut_cells.end(), [&](const CellInfo *a, const CellInfo *b) {
-                return dir ? (p->cell_locs.at(a->name).rawy < p->cell_locs.at(b->name).rawy)
-                           : (p->cell_locs.at(a->name).rawx < p->cell_locs.at(b->name).rawx);
+                return dir ? (p->cell_locs.at(a->udata).rawy < p->cell_locs.at(b->udata).rawy)
+                           : (p->cell_locs.at(a->udata).rawx < p->cell_locs.at(b->udata).rawx);
             });
 
             if (cut_cells.size() < 2)
@@ -1575,7 +2353,7 @@ class HeAPPlacer
             int pivot_cells = 0;
             int pivot = 0;
             for (auto &cell : cut_cells) {
-                pivot_cells += p->chain_size.count(cell->name) ? p->chain_size.at(cell->name) : 1;
+                pivot_cells += p->chain_size.at(cell->udata);
                 if (pivot_cells >= total_cells / 2)
                     break;
                 pivot++;
@@ -1648,10 +2426,10 @@ class HeAPPlacer
             std::vector<int> left_bels_v(buckets.size(), 0), right_bels_v(r.bels);
             for (int i = 0; i <= pivot; i++)
                 left_cells_v.at(cell_index(*cut_cells.at(i))) +=
-                        p->chain_size.count(cut_cells.at(i)->name) ? p->chain_size.at(cut_cells.at(i)->name) : 1;
+                        p->chain_size.at(cut_cells.at(i)->udata);
             for (int i = pivot + 1; i < int(cut_cells.size()); i++)
                 right_cells_v.at(cell_index(*cut_cells.at(i))) +=
-                        p->chain_size.count(cut_cells.at(i)->name) ? p->chain_size.at(cut_cells.at(i)->name) : 1;
+                        p->chain_size.at(cut_cells.at(i)->udata);
 
             int best_tgt_cut = -1;
             double best_deltaU = std::numeric_limits<double>::max();
@@ -1717,14 +2495,14 @@ class HeAPPlacer
             };
             while (pivot > 0 && is_part_overutil(false)) {
                 auto &move_cell = cut_cells.at(pivot);
-                int size = p->chain_size.count(move_cell->name) ? p->chain_size.at(move_cell->name) : 1;
+                int size = p->chain_size.at(move_cell->udata);
                 left_cells_v.at(cell_index(*cut_cells.at(pivot))) -= size;
                 right_cells_v.at(cell_index(*cut_cells.at(pivot))) += size;
                 pivot--;
             }
             while (pivot < int(cut_cells.size()) - 1 && is_part_overutil(true)) {
                 auto &move_cell = cut_cells.at(pivot + 1);
-                int size = p->chain_size.count(move_cell->name) ? p->chain_size.at(move_cell->name) : 1;
+                int size = p->chain_size.at(move_cell->udata);
                 left_cells_v.at(cell_index(*cut_cells.at(pivot))) += size;
                 right_cells_v.at(cell_index(*cut_cells.at(pivot))) -= size;
                 pivot++;
@@ -1735,8 +2513,8 @@ class HeAPPlacer
                 int N = cells_end - cells_start;
                 if (N <= 2) {
                     for (int i = cells_start; i < cells_end; i++) {
-                        auto &pos = dir ? p->cell_locs.at(cut_cells.at(i)->name).rawy
-                                        : p->cell_locs.at(cut_cells.at(i)->name).rawx;
+                        auto &pos = dir ? p->cell_locs.at(cut_cells.at(i)->udata).rawy
+                                        : p->cell_locs.at(cut_cells.at(i)->udata).rawx;
                         pos = area_l + i * ((area_r - area_l) / N);
                     }
                     return;
@@ -1750,10 +2528,10 @@ class HeAPPlacer
                 bin_bounds.emplace_back(cells_end, area_r + 0.99);
                 for (int i = 0; i < K; i++) {
                     auto &bl = bin_bounds.at(i), br = bin_bounds.at(i + 1);
-                    double orig_left = dir ? p->cell_locs.at(cut_cells.at(bl.first)->name).rawy
-                                           : p->cell_locs.at(cut_cells.at(bl.first)->name).rawx;
-                    double orig_right = dir ? p->cell_locs.at(cut_cells.at(br.first - 1)->name).rawy
-                                            : p->cell_locs.at(cut_cells.at(br.first - 1)->name).rawx;
+                    double orig_left = dir ? p->cell_locs.at(cut_cells.at(bl.first)->udata).rawy
+                                           : p->cell_locs.at(cut_cells.at(bl.first)->udata).rawx;
+                    double orig_right = dir ? p->cell_locs.at(cut_cells.at(br.first - 1)->udata).rawy
+                                            : p->cell_locs.at(cut_cells.at(br.first - 1)->udata).rawx;
                     double m = (br.second - bl.second) / std::max(0.00001, orig_right - orig_left);
                     for (int j = bl.first; j < br.first; j++) {
                         Region *cr = cut_cells.at(j)->region;
@@ -1762,13 +2540,13 @@ class HeAPPlacer
                             double brsc = p->limit_to_reg(cr, br.second, dir);
                             double blsc = p->limit_to_reg(cr, bl.second, dir);
                             double mr = (brsc - blsc) / std::max(0.00001, orig_right - orig_left);
-                            auto &pos = dir ? p->cell_locs.at(cut_cells.at(j)->name).rawy
-                                            : p->cell_locs.at(cut_cells.at(j)->name).rawx;
+                            auto &pos = dir ? p->cell_locs.at(cut_cells.at(j)->udata).rawy
+                                            : p->cell_locs.at(cut_cells.at(j)->udata).rawx;
                             NPNR_ASSERT(pos >= orig_left && pos <= orig_right);
                             pos = blsc + mr * (pos - orig_left);
                         } else {
-                            auto &pos = dir ? p->cell_locs.at(cut_cells.at(j)->name).rawy
-                                            : p->cell_locs.at(cut_cells.at(j)->name).rawx;
+                            auto &pos = dir ? p->cell_locs.at(cut_cells.at(j)->udata).rawy
+                                            : p->cell_locs.at(cut_cells.at(j)->udata).rawx;
                             NPNR_ASSERT(pos >= orig_left && pos <= orig_right);
                             pos = bl.second + m * (pos - orig_left);
                         }
@@ -1783,44 +2561,115 @@ class HeAPPlacer
                     cells_at_location.at(x).at(y).clear();
                 }
             for (auto cell : cut_cells) {
-                auto &cl = p->cell_locs.at(cell->name);
+                auto &cl = p->cell_locs.at(cell->udata);
                 cl.x = std::min(r.x1, std::max(r.x0, int(cl.rawx)));
                 cl.y = std::min(r.y1, std::max(r.y0, int(cl.rawy)));
                 cells_at_location.at(cl.x).at(cl.y).push_back(cell);
             }
-            SpreaderRegion rl, rr;
-            rl.id = int(regions.size());
+            CutResult result;
+            SpreaderRegion &rl = result.left, &rr = result.right;
+            rl.id = -1;
             rl.x0 = r.x0;
             rl.y0 = r.y0;
             rl.x1 = dir ? r.x1 : best_tgt_cut;
             rl.y1 = dir ? best_tgt_cut : r.y1;
             rl.cells = left_cells_v;
             rl.bels = left_bels_v;
-            rr.id = int(regions.size()) + 1;
+            rr.id = -1;
             rr.x0 = dir ? r.x0 : (best_tgt_cut + 1);
             rr.y0 = dir ? (best_tgt_cut + 1) : r.y0;
             rr.x1 = r.x1;
             rr.y1 = r.y1;
             rr.cells = right_cells_v;
             rr.bels = right_bels_v;
-            regions.push_back(rl);
-            regions.push_back(rr);
-            for (int x = rl.x0; x <= rl.x1; x++)
-                for (int y = rl.y0; y <= rl.y1; y++)
-                    groups.at(x).at(y) = rl.id;
-            for (int x = rr.x0; x <= rr.x1; x++)
-                for (int y = rr.y0; y <= rr.y1; y++)
-                    groups.at(x).at(y) = rr.id;
-            return std::make_pair(rl.id, rr.id);
+            result.next_dir = dir;
+            return result;
         };
     };
-    typedef decltype(CellInfo::udata) cell_udata_t;
-    cell_udata_t dont_solve = std::numeric_limits<cell_udata_t>::max();
 };
 int HeAPPlacer::CutSpreader::seq = 0;
 
 bool placer_heap(Context *ctx, PlacerHeapCfg cfg) { return HeAPPlacer(ctx, cfg).place(); }
 
+HeAPSession::HeAPSession(Context *ctx, PlacerHeapCfg cfg)
+        : placer(std::make_unique<HeAPPlacer>(ctx, cfg)), startt(std::chrono::high_resolution_clock::now())
+{
+}
+
+HeAPSession::~HeAPSession() {}
+
+void HeAPSession::initial_placement(int solve_iters)
+{
+    placer->seed_initial_placement();
+    for (int i = 0; i < solve_iters; i++)
+        placer->initial_solve(i);
+    placer->setup_solve_cells();
+}
+
+const std::vector<CellInfo *> &HeAPSession::movable_cells() const { return placer->solve_cells; }
+
+int HeAPSession::max_x() const { return placer->max_x; }
+
+int HeAPSession::max_y() const { return placer->max_y; }
+
+void HeAPSession::get_bounds(const CellInfo *cell, int &x0, int &y0, int &x1, int &y1) const
+{
+    if (cell->region != nullptr) {
+        const auto &bounds = placer->constraint_region_bounds.at(cell->region->name);
+        x0 = bounds.x0;
+        y0 = bounds.y0;
+        x1 = bounds.x1;
+        y1 = bounds.y1;
+    } else {
+        x0 = 0;
+        y0 = 0;
+        x1 = placer->max_x;
+        y1 = placer->max_y;
+    }
+}
+
+size_t HeAPSession::get_bels_for_bucket(BelBucketId bucket, FastBels::FastBelsData **data)
+{
+    return placer->fast_bels.getBelsForBelBucket(bucket, data);
+}
+
+Loc HeAPSession::get_location(const CellInfo *cell) const
+{
+    auto &loc = placer->cell_locs.at(cell->udata);
+    return Loc(loc.x, loc.y, 0);
+}
+
+bool HeAPSession::is_global(const CellInfo *cell) const { return placer->cell_locs.at(cell->udata).global; }
+
+double HeAPSession::get_raw_x(const CellInfo *cell) const { return placer->cell_locs.at(cell->udata).rawx; }
+
+double HeAPSession::get_raw_y(const CellInfo *cell) const { return placer->cell_locs.at(cell->udata).rawy; }
+
+void HeAPSession::set_position(const CellInfo *cell, double x, double y)
+{
+    auto &loc = placer->cell_locs.at(cell->udata);
+    loc.rawx = x;
+    loc.rawy = y;
+    // Tile centres are at integer positions, so round to the nearest
+    loc.x = std::min(placer->max_x, std::max(0, int(std::floor(x + 0.5))));
+    loc.y = std::min(placer->max_y, std::max(0, int(std::floor(y + 0.5))));
+    if (cell->region != nullptr) {
+        loc.x = placer->limit_to_reg(cell->region, loc.x, false);
+        loc.y = placer->limit_to_reg(cell->region, loc.y, true);
+    }
+}
+
+bool HeAPSession::legalise_and_refine(ScopeLock<Context> &lock, double global_time)
+{
+    placer->global_time = global_time;
+    placer->update_all_chains();
+    wirelen_t global_hpwl = placer->total_hpwl();
+    placer->legalise_placement_strict(true);
+    placer->update_all_chains();
+    log_info("Legalised placement: wirelen global = %d, legal = %d\n", int(global_hpwl), int(placer->total_hpwl()));
+    return placer->finish_placement(startt, lock);
+}
+
 PlacerHeapCfg::PlacerHeapCfg(Context *ctx)
 {
     alpha = ctx->setting<float>("placerHeap/alpha");
@@ -1829,12 +2678,41 @@ PlacerHeapCfg::PlacerHeapCfg(Context *ctx)
     timingWeight = ctx->setting<int>("placerHeap/timingWeight");
     timing_driven = ctx->setting<bool>("timing_driven");
     solverTolerance = 1e-5;
+    multilevel = ctx->setting<bool>("placerHeap/multilevel", false);
+    clusterMaxSize = ctx->setting<int>("placerHeap/clusterMaxSize", 16);
+    clusterMinCount = ctx->setting<int>("placerHeap/clusterMinCount", 2000);
+    clusterMaxLevels = ctx->setting<int>("placerHeap/clusterMaxLevels", 5);
+    std::string solver_name = "eigen";
+    auto solver_setting = ctx->settings.find(ctx->id("placerHeap/solver"));
+    if (solver_setting != ctx->settings.end())
+        solver_name = solver_setting->second.as_string();
+    if (solver_name == "eigen")
+        solver = SOLVER_EIGEN;
+    else if (solver_name == "jacobi")
+        solver = SOLVER_JACOBI;
+    else if (solver_name == "ic0")
+        solver = SOLVER_IC0;
+    else
+        log_error("Unknown HeAP solver '%s', expected one of 'eigen', 'jacobi' or 'ic0'\n", solver_name.c_str());
+    parallelLegalise = ctx->setting<bool>("placerHeap/parallelLegalise", false);
+    legaliseBinSize = ctx->setting<int>("placerHeap/legaliseBinSize", 16);
+    congestionDriven = ctx->setting<bool>("placerHeap/congestionDriven", false);
+    congestionThreshold = ctx->setting<float>("placerHeap/congestionThreshold", 1.5);
+    congestionMaxInflation = ctx->setting<float>("placerHeap/congestionMaxInflation", 2.0);
+    auto cong_map_setting = ctx->settings.find(ctx->id("placerHeap/congestionMap"));
+    if (cong_map_setting != ctx->settings.end())
+        congestionMap = cong_map_setting->second.as_string();
     placeAllAtOnce = false;
 
     hpwl_scale_x = 1;
     hpwl_scale_y = 1;
     spread_scale_x = 1;
     spread_scale_y = 1;
+#ifdef NPNR_DISABLE_THREADS
+    threads = ctx->setting<int>("placerHeap/threads", 1);
+#else
+    threads = ctx->setting<int>("placerHeap/threads", std::max<int>(1, boost::thread::hardware_concurrency()));
+#endif
 }
 
 NEXTPNR_NAMESPACE_END
@@ -26,8 +26,12 @@
 
 #ifndef PLACER_HEAP_H
 #define PLACER_HEAP_H
+#include <chrono>
+#include <memory>
+#include "fast_bels.h"
 #include "log.h"
 #include "nextpnr.h"
+#include "scope_lock.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -40,10 +44,39 @@ struct PlacerHeapCfg
     float timingWeight;
     bool timing_driven;
     float solverTolerance;
+    enum SolverBackend
+    {
+        // Eigen's conjugate gradient solver, with a diagonal preconditioner
+        SOLVER_EIGEN,
+        // Built-in multithreaded conjugate gradient solver, with a diagonal preconditioner
+        SOLVER_JACOBI,
+        // Built-in multithreaded conjugate gradient solver, with an incomplete Cholesky preconditioner
+        SOLVER_IC0,
+    } solver;
     bool placeAllAtOnce;
 
+    // Create the initial placement from a clustered (coarsened) netlist, uncoarsening level by level
+    bool multilevel;
+    // Maximum number of cells in a cluster; coarsening stops at clusterMinCount clusters or clusterMaxLevels levels
+    int clusterMaxSize, clusterMinCount, clusterMaxLevels;
+
+    // After the macros have been legalised (largest first), legalise the other cells with a parallel pass over square
+    // bins of legaliseBinSize locations, leaving only conflicts between bins to the serial legaliser
+    bool parallelLegalise;
+    int legaliseBinSize;
+
+    // Congestion-driven placement: estimate routing demand with RUDY after each iteration, and reduce the spreading
+    // capacity of locations whose demand is more than congestionThreshold times the average by up to a factor of
+    // congestionMaxInflation (equivalent to inflating the area of the cells placed there)
+    bool congestionDriven;
+    float congestionThreshold, congestionMaxInflation;
+    // If not empty, the RUDY routing demand of the final placement is written to this file in CSV format
+    std::string congestionMap;
+
     int hpwl_scale_x, hpwl_scale_y;
     int spread_scale_x, spread_scale_y;
+    // Number of threads used for cut-based spreading and binned legalisation
+    int threads;
 
     // These cell types will be randomly locked to prevent singular matrices
     std::unordered_set<IdString> ioBufTypes;
@@ -53,5 +86,46 @@ struct PlacerHeapCfg
 };
 
 extern bool placer_heap(Context *ctx, PlacerHeapCfg cfg);
+
+class HeAPPlacer;
+
+// The parts of the HeAP placer that other analytic global placers (placer_static) reuse in place of its solve and
+// spread loop: the initial placement, the bels available at each location and the strict legaliser. Cells are numbered
+// densely by their udata. Positions are in tiles, with tile centres at integer values as in the HeAP equations
+class HeAPSession
+{
+  public:
+    HeAPSession(Context *ctx, PlacerHeapCfg cfg);
+    ~HeAPSession();
+
+    // Place constrained cells, then make an initial placement of the others using the given number of quadratic
+    // solves. The context must stay locked until legalise_and_refine
+    void initial_placement(int solve_iters);
+
+    // The cells positioned by the global placer: the roots of chains and the other unlocked cells
+    const std::vector<CellInfo *> &movable_cells() const;
+    int max_x() const;
+    int max_y() const;
+    // The tiles a movable cell may be placed in, from its region constraint or the whole device
+    void get_bounds(const CellInfo *cell, int &x0, int &y0, int &x1, int &y1) const;
+    size_t get_bels_for_bucket(BelBucketId bucket, FastBels::FastBelsData **data);
+
+    // Current tile of any cell, and whether it is on a global buffer bel
+    Loc get_location(const CellInfo *cell) const;
+    bool is_global(const CellInfo *cell) const;
+    double get_raw_x(const CellInfo *cell) const;
+    double get_raw_y(const CellInfo *cell) const;
+    // Move a movable cell, keeping its tile within the device and its region
+    void set_position(const CellInfo *cell, double x, double y);
+
+    // Legalise the placement of the movable cells and their chains, then check it and run detailed placement, which
+    // releases the lock. global_time is the time spent by the global placer, for the summary
+    bool legalise_and_refine(ScopeLock<Context> &lock, double global_time);
+
+  private:
+    std::unique_ptr<HeAPPlacer> placer;
+    std::chrono::high_resolution_clock::time_point startt;
+};
+
 NEXTPNR_NAMESPACE_END
 #endif
@@ -0,0 +1,660 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  Electrostatic global placement, loosely following ePlace. For each group of bel buckets that are spread together,
+ *  the cells are positive charges and the bels a uniform negative background charge. The electric field then pushes
+ *  cells out of overfilled areas and into areas with free bels. This is balanced against a smooth (weighted-average)
+ *  wirelength model, increasing the weight of the density term until the overflow is low enough for strict
+ *  legalisation.
+ */
+
+#ifdef WITH_HEAP
+
+#include "placer_static.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "log.h"
+#include "nextpnr.h"
+#include "parallel.h"
+#include "scope_lock.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+const double pi = 3.14159265358979323846;
+
+// Split [0, count) into one contiguous block per thread, so that each block can set up its scratch space once
+template <typename Tf> void for_each_block(int threads, int count, Tf func)
+{
+    int n_blocks = std::max(1, std::min(threads, count));
+    for_each_parallel(n_blocks, n_blocks, [&](size_t b) {
+        func(int(b * size_t(count) / n_blocks), int((b + 1) * size_t(count) / n_blocks));
+    });
+}
+
+// Discrete cosine transforms of a power-of-two length, computed using an FFT of the same length (Makhoul's method).
+// The plan is read-only, so transforms of different rows can run concurrently, each with its own Workspace
+struct DctPlan
+{
+    struct Workspace
+    {
+        explicit Workspace(int n) : buf(n), tmp(n) {}
+        std::vector<std::complex<double>> buf;
+        std::vector<double> tmp;
+    };
+
+    explicit DctPlan(int n) : n(n), twiddle(n / 2), shift(n), bitrev(n)
+    {
+        NPNR_ASSERT(n >= 2 && (n & (n - 1)) == 0);
+        for (int i = 0; i < n / 2; i++)
+            twiddle.at(i) = std::polar(1.0, -2 * pi * i / n);
+        for (int k = 0; k < n; k++)
+            shift.at(k) = std::polar(1.0, -pi * k / (2 * n));
+        for (int i = 0, j = 0; i < n; i++) {
+            bitrev.at(i) = j;
+            int bit = n >> 1;
+            for (; bit > 0 && (j & bit); bit >>= 1)
+                j ^= bit;
+            j |= bit;
+        }
+    }
+
+    // out[k] = sum_i in[i] * cos(pi * k * (i + 0.5) / n)
+    void dct2(Workspace &ws, const double *in, int in_stride, double *out, int out_stride) const
+    {
+        auto &buf = ws.buf;
+        for (int i = 0; i < n / 2; i++) {
+            buf[i] = in[2 * i * in_stride];
+            buf[n - 1 - i] = in[(2 * i + 1) * in_stride];
+        }
+        fft(buf, false);
+        for (int k = 0; k < n; k++)
+            out[k * out_stride] = (shift[k] * buf[k]).real();
+    }
+
+    // out[i] = sum_k in[k] * cos(pi * k * (i + 0.5) / n)
+    void dct3(Workspace &ws, const double *in, int in_stride, double *out, int out_stride) const
+    {
+        auto &buf = ws.buf;
+        double in0 = in[0];
+        for (int k = 0; k < n; k++)
+            buf[k] = std::conj(shift[k]) *
+                     std::complex<double>(in[k * in_stride], (k == 0) ? 0 : -in[(n - k) * in_stride]);
+        fft(buf, true);
+        // The inverse FFT gives in[0] + 2 * sum_{k > 0} ...
+        for (int i = 0; i < n / 2; i++) {
+            out[2 * i * out_stride] = 0.5 * (buf[i].real() + in0);
+            out[(2 * i + 1) * out_stride] = 0.5 * (buf[n - 1 - i].real() + in0);
+        }
+    }
+
+    // out[i] = sum_k in[k] * sin(pi * k * (i + 0.5) / n), using sin(pi * k * (i + 0.5) / n) =
+    // (-1)^i * cos(pi * (n - k) * (i + 0.5) / n)
+    void dst3(Workspace &ws, const double *in, int in_stride, double *out, int out_stride) const
+    {
+        auto &tmp = ws.tmp;
+        tmp[0] = 0;
+        for (int k = 1; k < n; k++)
+            tmp[k] = in[(n - k) * in_stride];
+        dct3(ws, tmp.data(), 1, out, out_stride);
+        for (int i = 1; i < n; i += 2)
+            out[i * out_stride] = -out[i * out_stride];
+    }
+
+  private:
+    int n;
+    std::vector<std::complex<double>> twiddle, shift;
+    std::vector<int> bitrev;
+
+    // In-place radix-2 FFT, without any scaling
+    void fft(std::vector<std::complex<double>> &buf, bool inverse) const
+    {
+        for (int i = 0; i < n; i++)
+            if (i < bitrev[i])
+                std::swap(buf[i], buf[bitrev[i]]);
+        for (int len = 2; len <= n; len <<= 1) {
+            int step = n / len;
+            for (int i = 0; i < n; i += len) {
+                for (int j = 0; j < len / 2; j++) {
+                    std::complex<double> w = inverse ? std::conj(twiddle[j * step]) : twiddle[j * step];
+                    std::complex<double> u = buf[i + j], v = buf[i + j + len / 2] * w;
+                    buf[i + j] = u + v;
+                    buf[i + j + len / 2] = u - v;
+                }
+            }
+        }
+    }
+};
+
+class StaticPlacer
+{
+  public:
+    StaticPlacer(Context *ctx, PlacerHeapCfg hcfg) : ctx(ctx), hcfg(hcfg), cfg(ctx), heap(ctx, hcfg) {}
+
+    bool place()
+    {
+        ScopeLock<Context> lock(ctx);
+        // A couple of unconstrained quadratic solves give a good starting point for the density based placement
+        heap.initial_placement(2);
+
+        auto startt = std::chrono::high_resolution_clock::now();
+        init_objects();
+        init_fields();
+        init_nets();
+        optimise();
+        write_locs();
+        auto endt = std::chrono::high_resolution_clock::now();
+
+        return heap.legalise_and_refine(lock, std::chrono::duration<double>(endt - startt).count());
+    }
+
+  private:
+    Context *ctx;
+    PlacerHeapCfg hcfg;
+    PlacerStaticCfg cfg;
+    HeAPSession heap;
+
+    // The objects being placed are the movable cells, with any chain children moving with their root. Positions are
+    // stored as x0, y0, x1, y1, ... in tile units, with tile x covering [x, x + 1)
+    int n_obj = 0;
+    std::vector<CellInfo *> obj_cells;
+    std::vector<double> obj_charge, obj_pins;
+    std::vector<double> lower_bound, upper_bound;
+
+    // A cell in the density model: the object it belongs to and its offset from the object's position, and its field
+    struct Charge
+    {
+        int obj = -1;
+        int field = -1;
+        double dx = 0, dy = 0;
+    };
+    // Indexed by udata; obj is -1 for fixed cells
+    std::vector<Charge> cell_charge;
+    // All cells being placed, in a deterministic order with the cells of each object together; obj_first[i] is the
+    // first cell of object i
+    std::vector<CellInfo *> placed_cells;
+    std::vector<int> obj_first;
+
+    // Density field of one group of bel buckets. Grids are indexed x * ny + y with one bin per tile
+    struct Field
+    {
+        std::vector<Charge> charges;
+        std::vector<double> capacity, density, ex, ey;
+        double total_area = 0, total_capacity = 0;
+        double overflow = 0;
+    };
+    std::vector<Field> fields;
+    int nx = 0, ny = 0;
+    std::unique_ptr<DctPlan> plan_x, plan_y;
+
+    // Pins of a net. If obj is -1 the pin is on a fixed cell at (x, y), otherwise (x, y) is the offset from obj
+    struct Pin
+    {
+        int obj;
+        double x, y;
+    };
+    std::vector<std::vector<Pin>> nets;
+    // Wirelength gradient of each pin (x then y), and wirelength of each net, so nets can be evaluated in parallel and
+    // summed in a fixed order
+    std::vector<std::vector<double>> pin_grad;
+    std::vector<double> net_wirelen;
+
+    double lambda = 0, gamma = 0;
+    // Wirelength of the last evaluated placement, for logging
+    double wirelen = 0;
+
+    static int next_pow2(int x)
+    {
+        int n = 2;
+        while (n < x)
+            n *= 2;
+        return n;
+    }
+
+    void init_objects()
+    {
+        obj_cells = heap.movable_cells();
+        n_obj = int(obj_cells.size());
+        obj_charge.resize(n_obj, 0);
+        obj_pins.resize(n_obj, 0);
+        lower_bound.resize(2 * n_obj);
+        upper_bound.resize(2 * n_obj);
+        cell_charge.resize(ctx->cells.size());
+        for (int i = 0; i < n_obj; i++) {
+            CellInfo *root = obj_cells.at(i);
+            obj_first.push_back(int(placed_cells.size()));
+            // The offsets of chain children accumulate in the same way as the HeAP placer's chain update
+            std::function<void(CellInfo *, double, double)> visit = [&](CellInfo *cell, double dx, double dy) {
+                auto &charge = cell_charge.at(cell->udata);
+                charge.obj = i;
+                charge.dx = dx;
+                charge.dy = dy;
+                placed_cells.push_back(cell);
+                for (auto child : cell->constr_children)
+                    visit(child, dx + ((child->constr_x != child->UNCONSTR) ? child->constr_x : 0),
+                          dy + ((child->constr_y != child->UNCONSTR) ? child->constr_y : 0));
+            };
+            visit(root, 0, 0);
+            // Keep within the device, and the region constraint if there is one
+            int x0, y0, x1, y1;
+            heap.get_bounds(root, x0, y0, x1, y1);
+            lower_bound.at(2 * i) = x0;
+            lower_bound.at(2 * i + 1) = y0;
+            upper_bound.at(2 * i) = x1 + 0.999;
+            upper_bound.at(2 * i + 1) = y1 + 0.999;
+        }
+        obj_first.push_back(int(placed_cells.size()));
+    }
+
+    void init_fields()
+    {
+        nx = next_pow2(heap.max_x() + 1);
+        ny = next_pow2(heap.max_y() + 1);
+        plan_x = std::make_unique<DctPlan>(nx);
+        plan_y = std::make_unique<DctPlan>(ny);
+        // Spread the same groups of buckets together as the cut-based spreader
+        std::unordered_map<BelBucketId, int> bucket_field;
+        for (const auto &group : hcfg.cellGroups) {
+            for (auto bucket : group)
+                bucket_field[bucket] = int(fields.size());
+            fields.emplace_back();
+        }
+        for (auto cell : placed_cells) {
+            BelBucketId bucket = ctx->getBelBucketForCellType(cell->type);
+            if (!bucket_field.count(bucket)) {
+                bucket_field[bucket] = int(fields.size());
+                fields.emplace_back();
+            }
+        }
+        for (auto &field : fields) {
+            field.capacity.resize(nx * ny, 0);
+            field.density.resize(nx * ny);
+            field.ex.resize(nx * ny);
+            field.ey.resize(nx * ny);
+        }
+        for (auto &bf : bucket_field) {
+            FastBels::FastBelsData *fb;
+            if (heap.get_bels_for_bucket(bf.first, &fb) == 0)
+                continue;
+            auto &field = fields.at(bf.second);
+            for (int x = 0; x < std::min(nx, int(fb->size())); x++)
+                for (int y = 0; y < std::min(ny, int(fb->at(x).size())); y++) {
+                    field.capacity.at(x * ny + y) += fb->at(x).at(y).size();
+                    field.total_capacity += fb->at(x).at(y).size();
+                }
+        }
+        for (auto cell : placed_cells) {
+            auto &charge = cell_charge.at(cell->udata);
+            charge.field = bucket_field.at(ctx->getBelBucketForCellType(cell->type));
+            auto &field = fields.at(charge.field);
+            field.charges.push_back(charge);
+            field.total_area += 1;
+            obj_charge.at(charge.obj) += 1;
+        }
+        for (auto &field : fields) {
+            if (field.total_area > field.total_capacity)
+                log_error("Electrostatic placer: %d cells but only %d bels available for them\n",
+                          int(field.total_area), int(field.total_capacity));
+        }
+    }
+
+    void init_nets()
+    {
+        for (auto net : sorted(ctx->nets)) {
+            NetInfo *ni = net.second;
+            if (ni->driver.cell == nullptr || ni->users.empty())
+                continue;
+            if (heap.is_global(ni->driver.cell))
+                continue;
+            std::vector<Pin> pins;
+            bool any_movable = false;
+            auto add_pin = [&](const PortRef &port) {
+                auto &charge = cell_charge.at(port.cell->udata);
+                if (charge.obj != -1) {
+                    pins.push_back(Pin{charge.obj, charge.dx, charge.dy});
+                    any_movable = true;
+                } else {
+                    Loc loc = heap.get_location(port.cell);
+                    pins.push_back(Pin{-1, loc.x + 0.5, loc.y + 0.5});
+                }
+            };
+            add_pin(ni->driver);
+            for (auto &usr : ni->users)
+                add_pin(usr);
+            if (!any_movable)
+                continue;
+            for (auto &pin : pins)
+                if (pin.obj != -1)
+                    obj_pins.at(pin.obj) += 1;
+            pin_grad.emplace_back(2 * pins.size());
+            nets.push_back(std::move(pins));
+        }
+        net_wirelen.resize(nets.size());
+    }
+
+    // Add the weighted-average wirelength gradient to grad, and update wirelen
+    void wirelength_gradient(const std::vector<double> &pos, std::vector<double> &grad)
+    {
+        for_each_block(hcfg.threads, int(nets.size()), [&](int first, int last) {
+            std::vector<double> pin_pos, exp_max, exp_min;
+            for (int n = first; n < last; n++) {
+                auto &net = nets.at(n);
+                auto &net_grad = pin_grad.at(n);
+                net_wirelen.at(n) = 0;
+                for (int axis = 0; axis < 2; axis++) {
+                    double scale = axis ? hcfg.hpwl_scale_y : hcfg.hpwl_scale_x;
+                    pin_pos.clear();
+                    for (auto &pin : net)
+                        pin_pos.push_back((pin.obj == -1) ? (axis ? pin.y : pin.x)
+                                                          : (pos.at(2 * pin.obj + axis) + (axis ? pin.y : pin.x)));
+                    double pmin = *std::min_element(pin_pos.begin(), pin_pos.end());
+                    double pmax = *std::max_element(pin_pos.begin(), pin_pos.end());
+                    net_wirelen.at(n) += scale * (pmax - pmin);
+                    // Exponents are shifted by the extreme positions, so they don't overflow
+                    double sum_max = 0, wsum_max = 0, sum_min = 0, wsum_min = 0;
+                    exp_max.resize(pin_pos.size());
+                    exp_min.resize(pin_pos.size());
+                    for (size_t i = 0; i < pin_pos.size(); i++) {
+                        exp_max.at(i) = std::exp((pin_pos.at(i) - pmax) / gamma);
+                        exp_min.at(i) = std::exp((pmin - pin_pos.at(i)) / gamma);
+                        sum_max += exp_max.at(i);
+                        wsum_max += pin_pos.at(i) * exp_max.at(i);
+                        sum_min += exp_min.at(i);
+                        wsum_min += pin_pos.at(i) * exp_min.at(i);
+                    }
+                    double wa_max = wsum_max / sum_max, wa_min = wsum_min / sum_min;
+                    for (size_t i = 0; i < pin_pos.size(); i++) {
+                        double g = exp_max.at(i) / sum_max * (1 + (pin_pos.at(i) - wa_max) / gamma) -
+                                   exp_min.at(i) / sum_min * (1 - (pin_pos.at(i) - wa_min) / gamma);
+                        net_grad.at(2 * i + axis) = scale * g;
+                    }
+                }
+            }
+        });
+        // Accumulate serially, so that the result doesn't depend on the thread count
+        wirelen = 0;
+        for (size_t n = 0; n < nets.size(); n++) {
+            wirelen += net_wirelen.at(n);
+            auto &net = nets.at(n);
+            for (size_t i = 0; i < net.size(); i++) {
+                int obj = net.at(i).obj;
+                if (obj == -1)
+                    continue;
+                grad.at(2 * obj) += pin_grad.at(n).at(2 * i);
+                grad.at(2 * obj + 1) += pin_grad.at(n).at(2 * i + 1);
+            }
+        }
+    }
+
+    // Bilinear weights of the four bins around a position, shared between spreading charge and sampling the field
+    template <typename Tf> void foreach_bin(double x, double y, Tf func)
+    {
+        double fx = std::min(std::max(x - 0.5, 0.0), nx - 1.0), fy = std::min(std::max(y - 0.5, 0.0), ny - 1.0);
+        int x0 = std::min(int(fx), nx - 2), y0 = std::min(int(fy), ny - 2);
+        double tx = fx - x0, ty = fy - y0;
+        func(x0 * ny + y0, (1 - tx) * (1 - ty));
+        func((x0 + 1) * ny + y0, tx * (1 - ty));
+        func(x0 * ny + y0 + 1, (1 - tx) * ty);
+        func((x0 + 1) * ny + y0 + 1, tx * ty);
+    }
+
+    // Solve Poisson's equation for the charge density of a field, giving the electric field in ex and ey. The
+    // density is expanded as sum_uv a_uv cos(w_u x) cos(w_v y); the potential then has coefficients
+    // a_uv / (w_u^2 + w_v^2), which is differentiated term by term. Each pass transforms independent rows or columns,
+    // which are split between the threads
+    void solve_field(Field &field)
+    {
+        auto &coeff = field.density;
+        for_each_block(hcfg.threads, nx, [&](int first, int last) {
+            DctPlan::Workspace ws(ny);
+            for (int x = first; x < last; x++)
+                plan_y->dct2(ws, &coeff[x * ny], 1, &coeff[x * ny], 1);
+        });
+        for_each_block(hcfg.threads, ny, [&](int first, int last) {
+            DctPlan::Workspace ws(nx);
+            for (int y = first; y < last; y++)
+                plan_x->dct2(ws, &coeff[y], ny, &coeff[y], ny);
+        });
+        for_each_block(hcfg.threads, nx, [&](int first, int last) {
+            for (int u = first; u < last; u++) {
+                double wu = pi * u / nx;
+                for (int v = 0; v < ny; v++) {
+                    double wv = pi * v / ny;
+                    double a = coeff[u * ny + v] * (4.0 / (nx * ny)) * ((u == 0) ? 0.5 : 1) * ((v == 0) ? 0.5 : 1);
+                    double psi = (u == 0 && v == 0) ? 0 : a / (wu * wu + wv * wv);
+                    field.ex[u * ny + v] = psi * wu;
+                    field.ey[u * ny + v] = psi * wv;
+                }
+            }
+        });
+        for_each_block(hcfg.threads, ny, [&](int first, int last) {
+            DctPlan::Workspace ws(nx);
+            for (int y = first; y < last; y++) {
+                plan_x->dst3(ws, &field.ex[y], ny, &field.ex[y], ny);
+                plan_x->dct3(ws, &field.ey[y], ny, &field.ey[y], ny);
+            }
+        });
+        for_each_block(hcfg.threads, nx, [&](int first, int last) {
+            DctPlan::Workspace ws(ny);
+            for (int x = first; x < last; x++) {
+                plan_y->dct3(ws, &field.ex[x * ny], 1, &field.ex[x * ny], 1);
+                plan_y->dst3(ws, &field.ey[x * ny], 1, &field.ey[x * ny], 1);
+            }
+        });
+    }
+
+    // Set grad to the gradient of the density penalty, updating the overflow of each field
+    void density_gradient(const std::vector<double> &pos, std::vector<double> &grad)
+    {
+        // Charges are deposited into each field separately, as bins are shared between the cells of a field
+        for_each_parallel(hcfg.threads, fields.size(), [&](size_t f) {
+            auto &field = fields.at(f);
+            std::fill(field.density.begin(), field.density.end(), 0);
+            for (auto &c : field.charges)
+                foreach_bin(pos.at(2 * c.obj) + c.dx, pos.at(2 * c.obj + 1) + c.dy,
+                            [&](int bin, double w) { field.density[bin] += w; });
+            field.overflow = 0;
+            double fill = field.total_area / field.total_capacity;
+            for (int i = 0; i < nx * ny; i++) {
+                field.overflow += std::max(0.0, field.density[i] - field.capacity[i]);
+                field.density[i] -= fill * field.capacity[i];
+            }
+            field.overflow /= std::max(1.0, field.total_area);
+        });
+        for (auto &field : fields)
+            solve_field(field);
+        // The field pushes charges away from dense areas, which is the negative gradient of the energy. Each object
+        // only reads the fields and writes its own gradient, so objects are split between the threads
+        for_each_block(hcfg.threads, n_obj, [&](int first, int last) {
+            for (int i = first; i < last; i++) {
+                for (int j = obj_first.at(i); j < obj_first.at(i + 1); j++) {
+                    auto &c = cell_charge.at(placed_cells.at(j)->udata);
+                    auto &field = fields.at(c.field);
+                    foreach_bin(pos.at(2 * i) + c.dx, pos.at(2 * i + 1) + c.dy, [&](int bin, double w) {
+                        grad.at(2 * i) -= w * field.ex[bin];
+                        grad.at(2 * i + 1) -= w * field.ey[bin];
+                    });
+                }
+            }
+        });
+    }
+
+    double max_overflow() const
+    {
+        double overflow = 0;
+        for (auto &field : fields)
+            overflow = std::max(overflow, field.overflow);
+        return overflow;
+    }
+
+    // Evaluate the preconditioned gradient of wirelength + lambda * density
+    void gradient(const std::vector<double> &pos, std::vector<double> &grad, std::vector<double> &wl_grad,
+                  std::vector<double> &dens_grad)
+    {
+        std::fill(wl_grad.begin(), wl_grad.end(), 0);
+        std::fill(dens_grad.begin(), dens_grad.end(), 0);
+        wirelength_gradient(pos, wl_grad);
+        density_gradient(pos, dens_grad);
+        for (int i = 0; i < 2 * n_obj; i++)
+            grad.at(i) = (wl_grad.at(i) + lambda * dens_grad.at(i)) /
+                         std::max(1.0, obj_pins.at(i / 2) + lambda * obj_charge.at(i / 2));
+    }
+
+    // Smoothing of the wirelength model, which is reduced as the placement spreads out
+    void update_gamma()
+    {
+        gamma = 8.0 * std::pow(10.0, (20.0 / 9.0) * (max_overflow() - 0.1) - 1);
+        gamma = std::max(gamma, 0.1);
+    }
+
+    void clamp(std::vector<double> &pos)
+    {
+        for (int i = 0; i < 2 * n_obj; i++)
+            pos.at(i) = std::min(std::max(pos.at(i), lower_bound.at(i)), upper_bound.at(i));
+    }
+
+    static double distance(const std::vector<double> &a, const std::vector<double> &b)
+    {
+        double d = 0;
+        for (size_t i = 0; i < a.size(); i++)
+            d += (a.at(i) - b.at(i)) * (a.at(i) - b.at(i));
+        return std::sqrt(d);
+    }
+
+    std::vector<double> pos;
+
+    void optimise()
+    {
+        pos.resize(2 * n_obj);
+        // The quadratic solve has tile centres at integer coordinates, so shift by half a tile in the same way as
+        // the fixed pins. Cells on top of each other would see the same field, so also add a small random
+        // perturbation
+        for (int i = 0; i < n_obj; i++) {
+            CellInfo *cell = obj_cells.at(i);
+            pos.at(2 * i) = heap.get_raw_x(cell) + 0.5 + (ctx->rng(1000) - 499.5) / 10000.0;
+            pos.at(2 * i + 1) = heap.get_raw_y(cell) + 0.5 + (ctx->rng(1000) - 499.5) / 10000.0;
+        }
+        clamp(pos);
+
+        std::vector<double> wl_grad(2 * n_obj), dens_grad(2 * n_obj);
+        std::vector<double> u(pos), u_prev(pos), v(pos), v_prev(2 * n_obj), g(2 * n_obj), g_prev(2 * n_obj);
+
+        // Start with the density weighted lightly compared to wirelength, then increase it every iteration
+        lambda = 0;
+        gamma = 8.0;
+        gradient(v, g, wl_grad, dens_grad);
+        update_gamma();
+        double wl_norm = 0, dens_norm = 0;
+        for (int i = 0; i < 2 * n_obj; i++) {
+            wl_norm += std::abs(wl_grad.at(i));
+            dens_norm += std::abs(dens_grad.at(i));
+        }
+        lambda = (dens_norm > 0) ? cfg.initialDensityWeight * wl_norm / dens_norm : 1;
+        gradient(v, g, wl_grad, dens_grad);
+
+        // The first step size is found from a small trial step
+        double g_max = 0;
+        for (auto x : g)
+            g_max = std::max(g_max, std::abs(x));
+        for (int i = 0; i < 2 * n_obj; i++)
+            v_prev.at(i) = v.at(i) - ((g_max > 0) ? 0.1 * g.at(i) / g_max : 0);
+        gradient(v_prev, g_prev, wl_grad, dens_grad);
+        double step = (distance(g, g_prev) > 0) ? distance(v, v_prev) / distance(g, g_prev) : 0.1;
+
+        double a = 1;
+        int iter = 0;
+        for (; iter < cfg.maxIters; iter++) {
+            // Nesterov's accelerated gradient, with the step size predicted from the local Lipschitz constant. The
+            // vector updates are linear in the number of cells and cheap next to the gradient, so stay serial
+            double g_dist = distance(g, g_prev);
+            if (iter > 0 && g_dist > 0)
+                step = distance(v, v_prev) / g_dist;
+            for (int i = 0; i < 2 * n_obj; i++)
+                u.at(i) = v.at(i) - step * g.at(i);
+            clamp(u);
+            double a_next = (1 + std::sqrt(4 * a * a + 1)) / 2;
+            v_prev = v;
+            g_prev = g;
+            for (int i = 0; i < 2 * n_obj; i++)
+                v.at(i) = u.at(i) + ((a - 1) / a_next) * (u.at(i) - u_prev.at(i));
+            clamp(v);
+            u_prev = u;
+            a = a_next;
+
+            lambda *= cfg.densityWeightGrowth;
+            gradient(v, g, wl_grad, dens_grad);
+            update_gamma();
+            if (iter % 50 == 0)
+                log_info("    at electrostatic iter %d, wirelen = %d, overflow = %.3f\n", iter, int(wirelen),
+                         max_overflow());
+            if (max_overflow() < cfg.targetOverflow)
+                break;
+        }
+        log_info("    finished electrostatic placement after %d iterations, wirelen = %d, overflow = %.3f\n", iter,
+                 int(wirelen), max_overflow());
+        pos = u;
+    }
+
+    void write_locs()
+    {
+        // Back to the HeAP coordinates, with tile centres at integer positions
+        for (int i = 0; i < n_obj; i++)
+            heap.set_position(obj_cells.at(i), pos.at(2 * i) - 0.5, pos.at(2 * i + 1) - 0.5);
+    }
+};
+
+} // namespace
+
+bool placer_static(Context *ctx, PlacerHeapCfg cfg) { return StaticPlacer(ctx, cfg).place(); }
+
+PlacerStaticCfg::PlacerStaticCfg(Context *ctx)
+{
+    targetOverflow = ctx->setting<float>("placerStatic/targetOverflow", 0.1);
+    initialDensityWeight = ctx->setting<float>("placerStatic/initialDensityWeight", 0.01);
+    densityWeightGrowth = ctx->setting<float>("placerStatic/densityWeightGrowth", 1.05);
+    maxIters = ctx->setting<int>("placerStatic/maxIters", 2000);
+}
+
+NEXTPNR_NAMESPACE_END
+
+#else
+
+#include "log.h"
+#include "nextpnr.h"
+#include "placer_static.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+bool placer_static(Context *ctx, PlacerHeapCfg cfg)
+{
+    log_error("nextpnr was built without the electrostatic placer\n");
+    return false;
+}
+
+PlacerStaticCfg::PlacerStaticCfg(Context *ctx) {}
+
+NEXTPNR_NAMESPACE_END
+
+#endif
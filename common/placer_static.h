@@ -0,0 +1,45 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  [[cite]] ePlace
+ *  ePlace: Electrostatics-Based Placement Using Fast Fourier Transform and Nesterov's Method, Lu et al.
+ */
+
+#ifndef PLACER_STATIC_H
+#define PLACER_STATIC_H
+#include "log.h"
+#include "nextpnr.h"
+#include "placer_heap.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct PlacerStaticCfg
+{
+    PlacerStaticCfg(Context *ctx);
+
+    // Stop once the overflow of all bel buckets is below targetOverflow. The density weight starts at
+    // initialDensityWeight relative to wirelength and is multiplied by densityWeightGrowth every iteration
+    float targetOverflow, initialDensityWeight, densityWeightGrowth;
+    int maxIters;
+};
+
+// Electrostatic global placement, followed by the strict legalisation and detailed placement of the HeAP placer. The
+// HeAP configuration supplies the arch-specific cell groups, wirelength scales and thread count
+extern bool placer_static(Context *ctx, PlacerHeapCfg cfg);
+
+NEXTPNR_NAMESPACE_END
+#endif
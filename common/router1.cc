@@ -111,17 +111,71 @@ struct Router1
     std::unordered_map<arc_key, std::unordered_set<WireId>, arc_key::Hash> arc_to_wires;
     std::unordered_set<arc_key, arc_key::Hash> queued_arcs;
 
+    // Per-wire state is kept in flat arrays if the arch provides dense wire indices, and in hash maps otherwise
+    bool dense_wires;
     std::unordered_map<WireId, QueuedWire> visited;
+    std::vector<QueuedWire> dense_visited;
+    std::vector<int> dirty_visited;
     std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> queue;
 
     std::unordered_map<WireId, int> wireScores;
+    std::vector<int> dense_wire_scores;
     std::unordered_map<NetInfo *, int> netScores;
 
     int arcs_with_ripup = 0;
     int arcs_without_ripup = 0;
     bool ripup_flag;
 
-    Router1(Context *ctx, const Router1Cfg &cfg) : ctx(ctx), cfg(cfg) {}
+    Router1(Context *ctx, const Router1Cfg &cfg) : ctx(ctx), cfg(cfg)
+    {
+        int wire_count = ctx->getWireCount();
+        dense_wires = wire_count > 0;
+        if (dense_wires) {
+            dense_visited.resize(wire_count);
+            dense_wire_scores.resize(wire_count, 0);
+        }
+    }
+
+    const QueuedWire *find_visited(WireId wire) const
+    {
+        if (dense_wires) {
+            const QueuedWire &qw = dense_visited[ctx->getWireIndex(wire)];
+            return qw.wire == WireId() ? nullptr : &qw;
+        } else {
+            auto fnd = visited.find(wire);
+            return fnd == visited.end() ? nullptr : &fnd->second;
+        }
+    }
+
+    void set_visited(const QueuedWire &qw)
+    {
+        if (dense_wires) {
+            int idx = ctx->getWireIndex(qw.wire);
+            if (dense_visited[idx].wire == WireId())
+                dirty_visited.push_back(idx);
+            dense_visited[idx] = qw;
+        } else {
+            visited[qw.wire] = qw;
+        }
+    }
+
+    void clear_visited()
+    {
+        for (int idx : dirty_visited)
+            dense_visited[idx].wire = WireId();
+        dirty_visited.clear();
+        visited.clear();
+    }
+
+    int &wire_score(WireId wire) { return dense_wires ? dense_wire_scores[ctx->getWireIndex(wire)] : wireScores[wire]; }
+
+    int get_wire_score(WireId wire) const
+    {
+        if (dense_wires)
+            return dense_wire_scores[ctx->getWireIndex(wire)];
+        auto fnd = wireScores.find(wire);
+        return fnd == wireScores.end() ? 0 : fnd->second;
+    }
 
     void arc_queue_insert(const arc_key &arc, WireId src_wire, WireId dst_wire)
     {
@@ -205,7 +259,7 @@ struct Router1
                 log("        unbind wire %s\n", ctx->nameOfWire(w));
 
             ctx->unbindWire(w);
-            wireScores[w]++;
+            wire_score(w)++;
         }
 
         ripup_flag = true;
@@ -239,7 +293,7 @@ struct Router1
                 log("      unbind wire %s\n", ctx->nameOfWire(w));
 
             ctx->unbindWire(w);
-            wireScores[w]++;
+            wire_score(w)++;
         }
 
         ripup_flag = true;
@@ -273,7 +327,7 @@ struct Router1
                 log("      unbind wire %s\n", ctx->nameOfWire(w));
 
             ctx->unbindWire(w);
-            wireScores[w]++;
+            wire_score(w)++;
         }
 
         ripup_flag = true;
@@ -506,7 +560,7 @@ struct Router1
             std::priority_queue<QueuedWire, std::vector<QueuedWire>, QueuedWire::Greater> new_queue;
             queue.swap(new_queue);
         }
-        visited.clear();
+        clear_visited();
 
         // A* main loop
 
@@ -529,7 +583,7 @@ struct Router1
             qw.randtag = ctx->rng();
 
             queue.push(qw);
-            visited[qw.wire] = qw;
+            set_visited(qw);
         }
 
         while (visitCnt++ < maxVisitCnt && !queue.empty()) {
@@ -611,16 +665,12 @@ struct Router1
                         conflictWireNet = nullptr;
 
                     if (conflictWireWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictWireWire);
-                        if (scores_it != wireScores.end())
-                            next_penalty += scores_it->second * cfg.wireRipupPenalty;
+                        next_penalty += get_wire_score(conflictWireWire) * cfg.wireRipupPenalty;
                         next_penalty += cfg.wireRipupPenalty;
                     }
 
                     if (conflictPipWire != WireId()) {
-                        auto scores_it = wireScores.find(conflictPipWire);
-                        if (scores_it != wireScores.end())
-                            next_penalty += scores_it->second * cfg.wireRipupPenalty;
+                        next_penalty += get_wire_score(conflictPipWire) * cfg.wireRipupPenalty;
                         next_penalty += cfg.wireRipupPenalty;
                     }
 
@@ -647,10 +697,10 @@ struct Router1
                 if ((best_score >= 0) && (next_score - next_bonus - cfg.estimatePrecision > best_score))
                     continue;
 
-                auto old_visited_it = visited.find(next_wire);
-                if (old_visited_it != visited.end()) {
-                    delay_t old_delay = old_visited_it->second.delay;
-                    delay_t old_score = old_delay + old_visited_it->second.penalty;
+                const QueuedWire *old_visited = find_visited(next_wire);
+                if (old_visited != nullptr) {
+                    delay_t old_delay = old_visited->delay;
+                    delay_t old_score = old_delay + old_visited->penalty;
                     NPNR_ASSERT(old_score >= 0);
 
                     if (next_score + ctx->getDelayEpsilon() >= old_score)
@@ -661,7 +711,7 @@ struct Router1
                         log("Found better route to %s. Old vs new delay estimate: %.3f (%.3f) %.3f (%.3f)\n",
                             ctx->nameOfWire(next_wire),
                             ctx->getDelayNS(old_score),
-                            ctx->getDelayNS(old_visited_it->second.delay),
+                            ctx->getDelayNS(old_visited->delay),
                             ctx->getDelayNS(next_score),
                             ctx->getDelayNS(next_delay));
 #endif
@@ -692,7 +742,7 @@ struct Router1
                         ctx->getDelayNS(next_delay));
 #endif
 
-                visited[next_qw.wire] = next_qw;
+                set_visited(next_qw);
                 queue.push(next_qw);
 
                 if (next_wire == dst_wire) {
@@ -705,16 +755,17 @@ struct Router1
         if (ctx->debug)
             log("  total number of visited nodes: %d\n", visitCnt);
 
-        if (visited.count(dst_wire) == 0) {
+        const QueuedWire *dst_visited = find_visited(dst_wire);
+        if (dst_visited == nullptr) {
             if (ctx->debug)
                 log("  no route found for this arc\n");
             return false;
         }
 
         if (ctx->debug) {
-            log("  final route delay:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].delay));
-            log("  final route penalty: %8.2f\n", ctx->getDelayNS(visited[dst_wire].penalty));
-            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(visited[dst_wire].bonus));
+            log("  final route delay:   %8.2f\n", ctx->getDelayNS(dst_visited->delay));
+            log("  final route penalty: %8.2f\n", ctx->getDelayNS(dst_visited->penalty));
+            log("  final route bonus:   %8.2f\n", ctx->getDelayNS(dst_visited->bonus));
             log("  arc budget:      %12.2f\n", ctx->getDelayNS(net_info->users[user_idx].budget));
         }
 
@@ -726,7 +777,7 @@ struct Router1
         delay_t accumulated_path_delay = 0;
         delay_t last_path_delay_delta = 0;
         while (1) {
-            auto pip = visited[cursor].pip;
+            auto pip = find_visited(cursor)->pip;
 
             if (ctx->debug) {
                 delay_t path_delay_delta = ctx->estimateDelay(cursor, dst_wire) - accumulated_path_delay;
@@ -29,8 +29,11 @@
 #include "router2.h"
 
 #include <algorithm>
+#include <atomic>
 #include <boost/container/flat_map.hpp>
+#include <boost/container/small_vector.hpp>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <fstream>
 #include <queue>
@@ -78,30 +81,44 @@ struct Router2
         float total() const { return cost + togo_cost; }
     };
 
+    // Per-wire state is split by access pattern into three parallel arrays indexed by flat wire index, so that
+    // the inner loop of the search doesn't drag cold data through the cache
+
+    // Mostly static data, set up at the start of routing
     struct PerWireData
     {
         // nextpnr
         WireId w;
-        // net --> number of arcs; driving pip
-        boost::container::flat_map<int, std::pair<int, PipId>> bound_nets;
-        // Historical congestion cost
-        float hist_cong_cost = 1.0;
-        // Wire is unavailable as locked to another arc
-        bool unavailable = false;
         // This wire has to be used for this net
         int reserved_net = -1;
         // The notional location of the wire, to guarantee thread safety
         int16_t x = 0, y = 0;
-        // Visit data
-        struct
-        {
-            bool dirty = false, visited = false;
-            PipId pip;
-            WireScore score;
-        } visit;
+        // Wire is unavailable as locked to another arc
+        bool unavailable = false;
+    };
+
+    // Occupancy and congestion data
+    struct PerWireUsage
+    {
+        // net --> number of arcs; driving pip
+        // Nearly all wires are used by at most one net, so store the first one inline
+        boost::container::flat_map<int, std::pair<int, PipId>, std::less<int>,
+                                   boost::container::small_vector<std::pair<int, std::pair<int, PipId>>, 1>>
+                bound_nets;
+        // Historical congestion cost
+        float hist_cong_cost = 1.0;
+    };
+
+    // Search data. A wire counts as visited if its stamp matches that of the current search of the thread that
+    // owns it, so resetting between searches is just a matter of taking a new stamp
+    struct PerWireVisit
+    {
+        uint32_t stamp = 0;
+        PipId pip;
+        WireScore score;
     };
 
-    float present_wire_cost(const PerWireData &w, int net_uid)
+    float present_wire_cost(const PerWireUsage &w, int net_uid)
     {
         int other_sources = int(w.bound_nets.size());
         if (w.bound_nets.count(net_uid))
@@ -174,7 +191,7 @@ struct Router2
                     nets.at(i).bb.x0 = std::min(nets.at(i).bb.x0, ad.bb.x0);
                     nets.at(i).bb.x1 = std::max(nets.at(i).bb.x1, ad.bb.x1);
                     nets.at(i).bb.y0 = std::min(nets.at(i).bb.y0, ad.bb.y0);
-                    nets.at(i).bb.y1 = std::max(nets.at(i).bb.x1, ad.bb.y1);
+                    nets.at(i).bb.y1 = std::max(nets.at(i).bb.y1, ad.bb.y1);
                 }
                 // Add location to centroid sum
                 Loc usr_loc = ctx->getBelLocation(usr.cell->bel);
@@ -183,8 +200,14 @@ struct Router2
             }
             nets.at(i).hpwl = std::max(
                     std::abs(nets.at(i).bb.y1 - nets.at(i).bb.y0) + std::abs(nets.at(i).bb.x1 - nets.at(i).bb.x0), 1);
-            nets.at(i).cx /= int(ni->users.size() + 1);
-            nets.at(i).cy /= int(ni->users.size() + 1);
+            if (nets.at(i).bb.x0 > nets.at(i).bb.x1) {
+                // No routable arcs, so the net has no meaningful centre
+                nets.at(i).cx = -1;
+                nets.at(i).cy = -1;
+            } else {
+                nets.at(i).cx /= int(ni->users.size() + 1);
+                nets.at(i).cy /= int(ni->users.size() + 1);
+            }
             if (ctx->debug)
                 log_info("%s: bb=(%d, %d)->(%d, %d) c=(%d, %d) hpwl=%d\n", ctx->nameOf(ni), nets.at(i).bb.x0,
                          nets.at(i).bb.y0, nets.at(i).bb.x1, nets.at(i).bb.y1, nets.at(i).cx, nets.at(i).cy,
@@ -193,23 +216,96 @@ struct Router2
         }
     }
 
+    // Map from arch wire to index into flat_wires. If the arch provides dense wire indices, this is a flat array
+    // indexed by them; otherwise a hash map has to be used
+    bool dense_wires = false;
+    std::vector<int> dense_wire_to_idx;
     HashTables::HashMap<WireId, int> wire_to_idx;
     std::vector<PerWireData> flat_wires;
+    std::vector<PerWireUsage> wire_usage;
+    std::vector<PerWireVisit> wire_visit;
+
+    int wire_index(WireId w) const
+    {
+        if (dense_wires)
+            return dense_wire_to_idx[ctx->getWireIndex(w)];
+        else
+            return wire_to_idx.at(w);
+    }
+
+    PerWireData &wire_data(WireId w) { return flat_wires[wire_index(w)]; }
+    PerWireUsage &usage_data(WireId w) { return wire_usage[wire_index(w)]; }
 
-    PerWireData &wire_data(WireId w) { return flat_wires[wire_to_idx.at(w)]; }
+    // Flattened (CSR) snapshot of the downhill routing graph, indexed by flat wire index. The pips downhill of
+    // wire i are downhill_pips[downhill_start[i]] to downhill_pips[downhill_start[i+1]-1]. This avoids the Arch
+    // API iterators, pip location and delay lookups, and the wire index lookup in the inner loop of the search
+    struct DownhillPip
+    {
+        PipId pip;
+        // Flat index of the destination wire
+        int dst;
+        // Max delay of the pip plus that of its destination wire
+        delay_t delay;
+        int16_t x, y;
+    };
+    bool flat_graph = false;
+    std::vector<int> downhill_start;
+    std::vector<DownhillPip> downhill_pips;
+
+    void setup_flat_graph()
+    {
+        int pip_count = ctx->getPipCount();
+        if (cfg.flat_graph_max_pips <= 0 || pip_count > cfg.flat_graph_max_pips)
+            return;
+        downhill_start.reserve(flat_wires.size() + 1);
+        if (pip_count > 0)
+            downhill_pips.reserve(pip_count);
+        for (auto &wd : flat_wires) {
+            downhill_start.push_back(int(downhill_pips.size()));
+            for (auto pip : ctx->getPipsDownhill(wd.w)) {
+                DownhillPip dh;
+                dh.pip = pip;
+                WireId dst = ctx->getPipDstWire(pip);
+                dh.dst = wire_index(dst);
+                dh.delay = ctx->getPipDelay(pip).maxDelay() + ctx->getWireDelay(dst).maxDelay();
+                Loc pl = ctx->getPipLocation(pip);
+                dh.x = pl.x;
+                dh.y = pl.y;
+                downhill_pips.push_back(dh);
+            }
+            if (int(downhill_pips.size()) > cfg.flat_graph_max_pips) {
+                // Only possible for arches without a pip count; give up and use the Arch API
+                log_info("    device has more than %d pips, not flattening routing graph.\n", cfg.flat_graph_max_pips);
+                std::vector<int>().swap(downhill_start);
+                std::vector<DownhillPip>().swap(downhill_pips);
+                return;
+            }
+        }
+        downhill_start.push_back(int(downhill_pips.size()));
+        flat_graph = true;
+        log_info("    flattened routing graph: %d wires, %d pips, %.02f MiB\n", int(flat_wires.size()),
+                 int(downhill_pips.size()),
+                 (downhill_start.capacity() * sizeof(int) + downhill_pips.capacity() * sizeof(DownhillPip)) /
+                         (1024.0 * 1024.0));
+    }
 
     void setup_wires()
     {
         // Set up per-wire structures, so that MT parts don't have to do any memory allocation
         // This is possibly quite wasteful and not cache-optimal; further consideration necessary
+        int wire_count = ctx->getWireCount();
+        dense_wires = wire_count > 0;
+        if (dense_wires)
+            dense_wire_to_idx.resize(wire_count, -1);
         for (auto wire : ctx->getWires()) {
             PerWireData pwd;
+            PerWireUsage pwu;
             pwd.w = wire;
             NetInfo *bound = ctx->getBoundWireNet(wire);
             if (bound != nullptr) {
                 auto iter = bound->wires.find(wire);
                 if (iter != bound->wires.end()) {
-                    pwd.bound_nets[bound->udata] = std::make_pair(0, bound->wires.at(wire).pip);
+                    pwu.bound_nets[bound->udata] = std::make_pair(0, bound->wires.at(wire).pip);
                     if (bound->wires.at(wire).strength == STRENGTH_PLACER) {
                         pwd.reserved_net = bound->udata;
                     } else if (bound->wires.at(wire).strength > STRENGTH_PLACER) {
@@ -222,9 +318,16 @@ struct Router2
             pwd.x = (wire_loc.x0 + wire_loc.x1) / 2;
             pwd.y = (wire_loc.y0 + wire_loc.y1) / 2;
 
-            wire_to_idx[wire] = int(flat_wires.size());
+            if (dense_wires)
+                dense_wire_to_idx.at(ctx->getWireIndex(wire)) = int(flat_wires.size());
+            else
+                wire_to_idx[wire] = int(flat_wires.size());
             flat_wires.push_back(pwd);
+            wire_usage.push_back(pwu);
         }
+        wire_visit.resize(flat_wires.size());
+
+        setup_flat_graph();
 
         for (auto net_pair : sorted(ctx->nets)) {
             auto *net = net_pair.second;
@@ -288,7 +391,8 @@ struct Router2
         // Backwards routing
         std::queue<int> backwards_queue;
 
-        std::vector<int> dirty_wires;
+        // Stamp of the current search, see PerWireVisit
+        uint32_t visit_stamp = 0;
 
         // Thread bounding box
         ArcBounds bb;
@@ -324,7 +428,7 @@ struct Router2
 
     void bind_pip_internal(NetInfo *net, size_t user, int wire, PipId pip)
     {
-        auto &b = flat_wires.at(wire).bound_nets[net->udata];
+        auto &b = wire_usage.at(wire).bound_nets[net->udata];
         ++b.first;
         if (b.first == 1) {
             b.second = pip;
@@ -335,11 +439,12 @@ struct Router2
 
     void unbind_pip_internal(NetInfo *net, size_t user, WireId wire)
     {
-        auto &b = wire_data(wire).bound_nets.at(net->udata);
+        auto &wu = usage_data(wire);
+        auto &b = wu.bound_nets.at(net->udata);
         --b.first;
         NPNR_ASSERT(b.first >= 0);
         if (b.first == 0) {
-            wire_data(wire).bound_nets.erase(net->udata);
+            wu.bound_nets.erase(net->udata);
         }
     }
 
@@ -351,20 +456,41 @@ struct Router2
         WireId src = nets.at(net->udata).src_wire;
         WireId cursor = ad.sink_wire;
         while (cursor != src) {
-            auto &wd = wire_data(cursor);
-            PipId pip = wd.bound_nets.at(net->udata).second;
+            PipId pip = usage_data(cursor).bound_nets.at(net->udata).second;
             unbind_pip_internal(net, user, cursor);
             cursor = ctx->getPipSrcWire(pip);
         }
         ad.routed = false;
     }
 
-    float score_wire_for_arc(NetInfo *net, size_t user, size_t phys_pin, WireId wire, PipId pip)
+    // Delay of the current routing of a net user, as the worst of its physical pins; or the predicted delay if any of
+    // its arcs are unrouted
+    delay_t get_user_delay(NetInfo *net, size_t user)
+    {
+        auto &nd = nets.at(net->udata);
+        delay_t max_delay = 0;
+        for (auto &ad : nd.arcs.at(user)) {
+            if (!ad.routed)
+                return ctx->predictDelay(net, net->users.at(user));
+            delay_t delay = 0;
+            WireId cursor = ad.sink_wire;
+            while (cursor != nd.src_wire) {
+                PipId pip = usage_data(cursor).bound_nets.at(net->udata).second;
+                delay += ctx->getPipDelay(pip).maxDelay() + ctx->getWireDelay(cursor).maxDelay();
+                cursor = ctx->getPipSrcWire(pip);
+            }
+            max_delay = std::max(max_delay, delay + ctx->getWireDelay(nd.src_wire).maxDelay());
+        }
+        return max_delay;
+    }
+
+    // pip_delay is the max delay of the pip plus that of the wire it drives; pl is the location of the pip
+    float score_wire_for_arc(NetInfo *net, size_t user, size_t phys_pin, int wire, PipId pip, delay_t pip_delay,
+                             Loc pl)
     {
-        auto &wd = wire_data(wire);
+        auto &wd = wire_usage[wire];
         auto &nd = nets.at(net->udata);
-        float base_cost = ctx->getDelayNS(ctx->getPipDelay(pip).maxDelay() + ctx->getWireDelay(wire).maxDelay() +
-                                          ctx->getDelayEpsilon());
+        float base_cost = ctx->getDelayNS(pip_delay + ctx->getDelayEpsilon());
         float present_cost = present_wire_cost(wd, net->udata);
         float hist_cost = wd.hist_cong_cost;
         float bias_cost = 0;
@@ -381,7 +507,6 @@ struct Router2
             }
         }
         if (pip != PipId()) {
-            Loc pl = ctx->getPipLocation(pip);
             bias_cost = cfg.bias_cost_factor * (base_cost / int(net->users.size())) *
                         ((std::abs(pl.x - nd.cx) + std::abs(pl.y - nd.cy)) / float(nd.hpwl));
         }
@@ -390,12 +515,12 @@ struct Router2
 
     float get_togo_cost(NetInfo *net, size_t user, int wire, WireId sink, delay_t *delay)
     {
-        auto &wd = flat_wires[wire];
+        auto &wu = wire_usage[wire];
         int source_uses = 0;
-        if (wd.bound_nets.count(net->udata))
-            source_uses = wd.bound_nets.at(net->udata).first;
+        if (wu.bound_nets.count(net->udata))
+            source_uses = wu.bound_nets.at(net->udata).first;
         // FIXME: timing/wirelength balance?
-        *delay = ctx->estimateDelay(wd.w, sink);
+        *delay = ctx->estimateDelay(flat_wires[wire].w, sink);
         return (ctx->getDelayNS(*delay) / (1 + source_uses)) + cfg.ipin_cost_adder;
     }
 
@@ -404,11 +529,11 @@ struct Router2
         auto &ad = nets.at(net->udata).arcs.at(usr).at(phys_pin);
         WireId src_wire = nets.at(net->udata).src_wire;
         WireId cursor = ad.sink_wire;
-        while (wire_data(cursor).bound_nets.count(net->udata)) {
-            auto &wd = wire_data(cursor);
-            if (wd.bound_nets.size() != 1)
+        while (usage_data(cursor).bound_nets.count(net->udata)) {
+            auto &wu = usage_data(cursor);
+            if (wu.bound_nets.size() != 1)
                 return false;
-            auto &uh = wd.bound_nets.at(net->udata).second;
+            auto &uh = wu.bound_nets.at(net->udata).second;
             if (uh == PipId())
                 break;
             cursor = ctx->getPipSrcWire(uh);
@@ -424,9 +549,8 @@ struct Router2
         WireId src = nets.at(net->udata).src_wire;
         WireId cursor = ad.sink_wire;
         while (cursor != src) {
-            size_t wire_idx = wire_to_idx.at(cursor);
-            auto &wd = flat_wires.at(wire_idx);
-            PipId pip = wd.bound_nets.at(net->udata).second;
+            size_t wire_idx = wire_index(cursor);
+            PipId pip = wire_usage.at(wire_idx).bound_nets.at(net->udata).second;
             bind_pip_internal(net, usr, wire_idx, pip);
             cursor = ctx->getPipSrcWire(pip);
         }
@@ -490,28 +614,30 @@ struct Router2
         }
     }
 
-    void reset_wires(ThreadContext &t)
+    // Source of unique visit stamps, shared between threads. Stamp 0 is never handed out, so that freshly
+    // initialised wires are unvisited
+    std::atomic<uint32_t> last_visit_stamp{0};
+
+    void reset_wires(ThreadContext &t) { t.visit_stamp = ++last_visit_stamp; }
+
+    // Must only be called when no threads are routing
+    void check_visit_stamps()
     {
-        for (auto w : t.dirty_wires) {
-            flat_wires[w].visit.visited = false;
-            flat_wires[w].visit.dirty = false;
-            flat_wires[w].visit.pip = PipId();
-            flat_wires[w].visit.score = WireScore();
-        }
-        t.dirty_wires.clear();
+        if (last_visit_stamp < 0x80000000U)
+            return;
+        for (auto &v : wire_visit)
+            v.stamp = 0;
+        last_visit_stamp = 0;
     }
 
     void set_visited(ThreadContext &t, int wire, PipId pip, WireScore score)
     {
-        auto &v = flat_wires.at(wire).visit;
-        if (!v.dirty)
-            t.dirty_wires.push_back(wire);
-        v.dirty = true;
-        v.visited = true;
+        auto &v = wire_visit.at(wire);
+        v.stamp = t.visit_stamp;
         v.pip = pip;
         v.score = score;
     }
-    bool was_visited(int wire) { return flat_wires.at(wire).visit.visited; }
+    bool was_visited(ThreadContext &t, int wire) { return wire_visit.at(wire).stamp == t.visit_stamp; }
 
     ArcRouteResult route_arc(ThreadContext &t, NetInfo *net, size_t i, size_t phys_pin, bool is_mt, bool is_bb = true)
     {
@@ -528,8 +654,8 @@ struct Router2
         if (dst_wire == WireId())
             ARC_LOG_ERR("No wire found for port %s on destination cell %s.\n", ctx->nameOf(usr.port),
                         ctx->nameOf(usr.cell));
-        int src_wire_idx = wire_to_idx.at(src_wire);
-        int dst_wire_idx = wire_to_idx.at(dst_wire);
+        int src_wire_idx = wire_index(src_wire);
+        int dst_wire_idx = wire_index(dst_wire);
         // Check if arc was already done _in this iteration_
         if (t.processed_sinks.count(dst_wire))
             return ARC_SUCCESS;
@@ -542,6 +668,7 @@ struct Router2
             std::queue<int> new_queue;
             t.backwards_queue.swap(new_queue);
         }
+        reset_wires(t);
         // First try strongly iteration-limited routing backwards BFS
         // this will deal with certain nets faster than forward A*
         // and comes at a minimal performance cost for the others
@@ -550,40 +677,40 @@ struct Router2
         int backwards_iter = 0;
         int backwards_limit =
                 ctx->getBelGlobalBuf(net->driver.cell->bel) ? cfg.global_backwards_max_iter : cfg.backwards_max_iter;
-        t.backwards_queue.push(wire_to_idx.at(dst_wire));
+        t.backwards_queue.push(wire_index(dst_wire));
         while (!t.backwards_queue.empty() && backwards_iter < backwards_limit) {
             int cursor = t.backwards_queue.front();
             t.backwards_queue.pop();
-            auto &cwd = flat_wires[cursor];
+            auto &cwu = wire_usage[cursor];
             PipId cpip;
-            if (cwd.bound_nets.count(net->udata)) {
+            if (cwu.bound_nets.count(net->udata)) {
                 // If we can tack onto existing routing; try that
                 // Only do this if the existing routing is uncontented; however
                 int cursor2 = cursor;
                 bool bwd_merge_fail = false;
-                while (flat_wires.at(cursor2).bound_nets.count(net->udata)) {
-                    if (flat_wires.at(cursor2).bound_nets.size() > 1) {
+                while (wire_usage.at(cursor2).bound_nets.count(net->udata)) {
+                    if (wire_usage.at(cursor2).bound_nets.size() > 1) {
                         bwd_merge_fail = true;
                         break;
                     }
-                    PipId p = flat_wires.at(cursor2).bound_nets.at(net->udata).second;
+                    PipId p = wire_usage.at(cursor2).bound_nets.at(net->udata).second;
                     if (p == PipId())
                         break;
-                    cursor2 = wire_to_idx.at(ctx->getPipSrcWire(p));
+                    cursor2 = wire_index(ctx->getPipSrcWire(p));
                 }
                 if (!bwd_merge_fail && cursor2 == src_wire_idx) {
                     // Found a path to merge to existing routing; backwards
                     cursor2 = cursor;
-                    while (flat_wires.at(cursor2).bound_nets.count(net->udata)) {
-                        PipId p = flat_wires.at(cursor2).bound_nets.at(net->udata).second;
+                    while (wire_usage.at(cursor2).bound_nets.count(net->udata)) {
+                        PipId p = wire_usage.at(cursor2).bound_nets.at(net->udata).second;
                         if (p == PipId())
                             break;
-                        cursor2 = wire_to_idx.at(ctx->getPipSrcWire(p));
+                        cursor2 = wire_index(ctx->getPipSrcWire(p));
                         set_visited(t, cursor2, p, WireScore());
                     }
                     break;
                 }
-                cpip = cwd.bound_nets.at(net->udata).second;
+                cpip = cwu.bound_nets.at(net->udata).second;
             }
             bool did_something = false;
             for (auto uh : ctx->getPipsUphill(flat_wires[cursor].w)) {
@@ -592,15 +719,16 @@ struct Router2
                     continue;
                 if (cpip != PipId() && cpip != uh)
                     continue; // don't allow multiple pips driving a wire with a net
-                int next = wire_to_idx.at(ctx->getPipSrcWire(uh));
-                if (was_visited(next))
+                int next = wire_index(ctx->getPipSrcWire(uh));
+                if (was_visited(t, next))
                     continue; // skip wires that have already been visited
                 auto &wd = flat_wires[next];
                 if (wd.unavailable)
                     continue;
                 if (wd.reserved_net != -1 && wd.reserved_net != net->udata)
                     continue;
-                if (wd.bound_nets.size() > 1 || (wd.bound_nets.size() == 1 && !wd.bound_nets.count(net->udata)))
+                auto &wu = wire_usage[next];
+                if (wu.bound_nets.size() > 1 || (wu.bound_nets.size() == 1 && !wu.bound_nets.count(net->udata)))
                     continue; // never allow congestion in backwards routing
                 if (!thread_test_wire(t, wd))
                     continue; // thread safety issue
@@ -611,18 +739,18 @@ struct Router2
                 ++backwards_iter;
         }
         // Check if backwards routing succeeded in reaching source
-        if (was_visited(src_wire_idx)) {
+        if (was_visited(t, src_wire_idx)) {
             ROUTE_LOG_DBG("   Routed (backwards): ");
             int cursor_fwd = src_wire_idx;
             bind_pip_internal(net, i, src_wire_idx, PipId());
-            while (was_visited(cursor_fwd)) {
-                auto &v = flat_wires.at(cursor_fwd).visit;
-                cursor_fwd = wire_to_idx.at(ctx->getPipDstWire(v.pip));
+            while (was_visited(t, cursor_fwd)) {
+                auto &v = wire_visit.at(cursor_fwd);
+                cursor_fwd = wire_index(ctx->getPipDstWire(v.pip));
                 bind_pip_internal(net, i, cursor_fwd, v.pip);
                 if (ctx->debug) {
-                    auto &wd = flat_wires.at(cursor_fwd);
-                    ROUTE_LOG_DBG("      wire: %s (curr %d hist %f)\n", ctx->nameOfWire(wd.w),
-                                  int(wd.bound_nets.size()) - 1, wd.hist_cong_cost);
+                    auto &wu = wire_usage.at(cursor_fwd);
+                    ROUTE_LOG_DBG("      wire: %s (curr %d hist %f)\n", ctx->nameOfWire(flat_wires.at(cursor_fwd).w),
+                                  int(wu.bound_nets.size()) - 1, wu.hist_cong_cost);
                 }
             }
             NPNR_ASSERT(cursor_fwd == dst_wire_idx);
@@ -674,87 +802,98 @@ struct Router2
             ROUTE_LOG_DBG("current wire %s\n", ctx->nameOfWire(d.w));
 #endif
             // Explore all pips downhill of cursor
-            for (auto dh : ctx->getPipsDownhill(d.w)) {
+            auto explore_pip = [&](PipId dh, int next_idx, delay_t dh_delay, Loc pl) {
                 // Skip pips outside of box in bounding-box mode
 #if 0
                 ROUTE_LOG_DBG("trying pip %s\n", ctx->nameOfPip(dh));
 #endif
 #if 0
                 int wire_intent = ctx->wireIntent(curr.wire);
-                if (is_bb && !hit_test_pip(ad.bb, ctx->getPipLocation(dh)) && wire_intent != ID_PSEUDO_GND && wire_intent != ID_PSEUDO_VCC)
-                    continue;
+                if (is_bb && !hit_test_pip(ad.bb, pl) && wire_intent != ID_PSEUDO_GND && wire_intent != ID_PSEUDO_VCC)
+                    return;
 #else
-                if (is_bb && !hit_test_pip(ad.bb, ctx->getPipLocation(dh)))
-                    continue;
+                if (is_bb && !hit_test_pip(ad.bb, pl))
+                    return;
                 if (!ctx->checkPipAvailForNet(dh, net)) {
                     ROUTE_LOG_DBG("Skipping pip %s because it is bound to net '%s' not net '%s'\n", ctx->nameOfPip(dh),
                                   ctx->getBoundPipNet(dh) != nullptr ? ctx->getBoundPipNet(dh)->name.c_str(ctx)
                                                                      : "<not a net>",
                                   net->name.c_str(ctx));
-                    continue;
+                    return;
                 }
 #endif
                 // Evaluate score of next wire
-                WireId next = ctx->getPipDstWire(dh);
-                int next_idx = wire_to_idx.at(next);
-                if (was_visited(next_idx)) {
+                if (was_visited(t, next_idx)) {
                     // Don't expand the same node twice.
-                    continue;
+                    return;
                 }
+                auto &nwd = flat_wires.at(next_idx);
 #if 1
                 if (debug_arc)
-                    ROUTE_LOG_DBG("   src wire %s\n", ctx->nameOfWire(next));
+                    ROUTE_LOG_DBG("   src wire %s\n", ctx->nameOfWire(nwd.w));
 #endif
-                auto &nwd = flat_wires.at(next_idx);
                 if (nwd.unavailable)
-                    continue;
+                    return;
                 if (nwd.reserved_net != -1 && nwd.reserved_net != net->udata)
-                    continue;
-                if (nwd.bound_nets.count(net->udata) && nwd.bound_nets.at(net->udata).second != dh)
-                    continue;
+                    return;
+                auto &nwu = wire_usage[next_idx];
+                if (nwu.bound_nets.count(net->udata) && nwu.bound_nets.at(net->udata).second != dh)
+                    return;
                 if (!thread_test_wire(t, nwd))
-                    continue; // thread safety issue
+                    return; // thread safety issue
                 WireScore next_score;
-                next_score.cost = curr.score.cost + score_wire_for_arc(net, i, phys_pin, next, dh);
-                next_score.delay =
-                        curr.score.delay + ctx->getPipDelay(dh).maxDelay() + ctx->getWireDelay(next).maxDelay();
+                next_score.cost = curr.score.cost + score_wire_for_arc(net, i, phys_pin, next_idx, dh, dh_delay, pl);
+                next_score.delay = curr.score.delay + dh_delay;
                 next_score.togo_cost = cfg.estimate_weight * get_togo_cost(net, i, next_idx, dst_wire, &forward);
                 ROUTE_LOG_DBG(
                         "src_wire = %s -> next %s -> dst_wire = %s (backward: %s, forward: %s, sum: %s, cost = %f, "
                         "togo_cost = %f, total = %f), dt = %02fs\n",
-                        ctx->nameOfWire(src_wire), ctx->nameOfWire(next), ctx->nameOfWire(dst_wire),
+                        ctx->nameOfWire(src_wire), ctx->nameOfWire(nwd.w), ctx->nameOfWire(dst_wire),
                         std::to_string(next_score.delay).c_str(), std::to_string(forward).c_str(),
                         std::to_string(next_score.delay + forward).c_str(), next_score.cost, next_score.togo_cost,
                         next_score.cost + next_score.togo_cost,
                         std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - arc_start).count());
-                const auto &v = nwd.visit;
-                if (!v.visited || (v.score.total() > next_score.total())) {
+                if (!was_visited(t, next_idx) || (wire_visit[next_idx].score.total() > next_score.total())) {
                     ++explored;
 #if 0
-                    ROUTE_LOG_DBG("exploring wire %s cost %f togo %f\n", ctx->nameOfWire(next), next_score.cost,
+                    ROUTE_LOG_DBG("exploring wire %s cost %f togo %f\n", ctx->nameOfWire(nwd.w), next_score.cost,
                                   next_score.togo_cost);
 #endif
                     // Add wire to queue if it meets criteria
-                    t.queue.push(QueuedWire(next_idx, dh, ctx->getPipLocation(dh), next_score, t.rng.rng()));
+                    t.queue.push(QueuedWire(next_idx, dh, pl, next_score, t.rng.rng()));
                     set_visited(t, next_idx, dh, next_score);
-                    if (next == dst_wire) {
+                    if (next_idx == dst_wire_idx) {
                         toexplore = std::min(toexplore, iter + 5);
                         must_drain_queue = false;
                     }
                 }
+            };
+            if (flat_graph) {
+                for (int j = downhill_start[curr.wire], j_end = downhill_start[curr.wire + 1]; j < j_end; j++) {
+                    const auto &dh = downhill_pips[j];
+                    explore_pip(dh.pip, dh.dst, dh.delay, Loc(dh.x, dh.y, 0));
+                }
+            } else {
+                for (auto dh : ctx->getPipsDownhill(d.w)) {
+                    WireId next = ctx->getPipDstWire(dh);
+                    explore_pip(dh, wire_index(next),
+                                ctx->getPipDelay(dh).maxDelay() + ctx->getWireDelay(next).maxDelay(),
+                                ctx->getPipLocation(dh));
+                }
             }
         }
-        if (was_visited(dst_wire_idx)) {
+        if (was_visited(t, dst_wire_idx)) {
             ROUTE_LOG_DBG("   Routed (explored %d wires): ", explored);
             int cursor_bwd = dst_wire_idx;
-            while (was_visited(cursor_bwd)) {
-                auto &v = flat_wires.at(cursor_bwd).visit;
+            while (was_visited(t, cursor_bwd)) {
+                auto &v = wire_visit.at(cursor_bwd);
                 bind_pip_internal(net, i, cursor_bwd, v.pip);
                 if (ctx->debug) {
-                    auto &wd = flat_wires.at(cursor_bwd);
-                    ROUTE_LOG_DBG("      wire: %s (curr %d hist %f share %d)\n", ctx->nameOfWire(wd.w),
-                                  int(wd.bound_nets.size()) - 1, wd.hist_cong_cost,
-                                  wd.bound_nets.count(net->udata) ? wd.bound_nets.at(net->udata).first : 0);
+                    auto &wu = wire_usage.at(cursor_bwd);
+                    ROUTE_LOG_DBG("      wire: %s (curr %d hist %f share %d)\n",
+                                  ctx->nameOfWire(flat_wires.at(cursor_bwd).w), int(wu.bound_nets.size()) - 1,
+                                  wu.hist_cong_cost,
+                                  wu.bound_nets.count(net->udata) ? wu.bound_nets.at(net->udata).first : 0);
                 }
                 if (v.pip == PipId()) {
                     NPNR_ASSERT(cursor_bwd == src_wire_idx);
@@ -762,7 +901,7 @@ struct Router2
                 }
                 ROUTE_LOG_DBG("         pip: %s (%d, %d)\n", ctx->nameOfPip(v.pip), ctx->getPipLocation(v.pip).x,
                               ctx->getPipLocation(v.pip).y);
-                cursor_bwd = wire_to_idx.at(ctx->getPipSrcWire(v.pip));
+                cursor_bwd = wire_index(ctx->getPipSrcWire(v.pip));
             }
             t.processed_sinks.insert(dst_wire);
             ad.routed = true;
@@ -859,7 +998,7 @@ struct Router2
         overused_wires = 0;
         total_wire_use = 0;
         failed_nets.clear();
-        for (auto &wire : flat_wires) {
+        for (auto &wire : wire_usage) {
             total_wire_use += int(wire.bound_nets.size());
             int overuse = int(wire.bound_nets.size()) - 1;
             if (overuse > 0) {
@@ -921,13 +1060,13 @@ struct Router2
                     break;
                 }
             }
-            auto &wd = wire_data(cursor);
-            if (!wd.bound_nets.count(net->udata)) {
+            auto &wu = usage_data(cursor);
+            if (!wu.bound_nets.count(net->udata)) {
                 log("Failure details:\n");
                 log("    Cursor: %s\n", ctx->nameOfWire(cursor));
                 log_error("Internal error; incomplete route tree for arc %d of net %s.\n", usr_idx, ctx->nameOf(net));
             }
-            auto &p = wd.bound_nets.at(net->udata).second;
+            auto &p = wu.bound_nets.at(net->udata).second;
             if (!ctx->checkPipAvail(p)) {
                 NetInfo *bound_net = ctx->getBoundPipNet(p);
                 if (bound_net != net) {
@@ -1006,7 +1145,7 @@ struct Router2
     {
         std::vector<std::vector<int>> hm_xy;
         int max_x = 0, max_y = 0;
-        for (auto &wd : flat_wires) {
+        for (auto &wd : wire_usage) {
             int val = int(wd.bound_nets.size()) - (congestion ? 1 : 0);
             if (wd.bound_nets.empty())
                 continue;
@@ -1039,51 +1178,123 @@ struct Router2
             out << std::endl;
         }
     }
-    int mid_x = 0, mid_y = 0;
+    // Routing is parallelised by recursively bisecting the device into a binary tree of regions. Each net is
+    // assigned to the smallest region that contains its bounding box (plus margin); regions that don't overlap
+    // can be routed concurrently and a region is only routed once all of its subregions are done. Nets in the
+    // root region cross the top-level split and are routed serially.
+    struct PartitionNode
+    {
+        ArcBounds bb;
+        int parent = -1;
+        int depth = 0;
+        std::vector<int> children;
+    };
+    std::vector<PartitionNode> partition;
+    int partition_leaves = 0;
 
-    void partition_nets()
+    bool net_fits_region(const ArcBounds &region, const ArcBounds &nb)
     {
-        // Create a histogram of positions in X and Y positions
+        // Device edges don't need a margin, as routing can't leave the device anyway
+        const int inf = std::numeric_limits<int>::max();
+        return (region.x0 == 0 || nb.x0 >= region.x0 + cfg.bb_margin_x) &&
+               (region.x1 == inf || nb.x1 <= region.x1 - cfg.bb_margin_x) &&
+               (region.y0 == 0 || nb.y0 >= region.y0 + cfg.bb_margin_y) &&
+               (region.y1 == inf || nb.y1 <= region.y1 - cfg.bb_margin_y);
+    }
+
+    int find_net_region(int net)
+    {
+        auto &nd = nets.at(net);
+        int node = 0;
+        // Nets without a centre weren't considered when splitting, so keep them in the root region
+        if (nd.cx == -1)
+            return node;
+        while (true) {
+            int next = -1;
+            for (int c : partition.at(node).children)
+                if (net_fits_region(partition.at(c).bb, nd.bb)) {
+                    next = c;
+                    break;
+                }
+            if (next == -1)
+                return node;
+            node = next;
+        }
+    }
+
+    void split_region(int node, const std::vector<int> &region_nets, int max_depth)
+    {
+        if (partition.at(node).depth >= max_depth || region_nets.size() < 2) {
+            ++partition_leaves;
+            return;
+        }
+        // Create a histogram of net centres in X and Y, and split along the axis with the larger spread
         std::map<int, int> cxs, cys;
-        for (auto &n : nets) {
-            if (n.cx != -1)
-                ++cxs[n.cx];
-            if (n.cy != -1)
-                ++cys[n.cy];
+        for (int n : region_nets) {
+            ++cxs[nets.at(n).cx];
+            ++cys[nets.at(n).cy];
         }
-        // 4-way split for now
-        int accum_x = 0, accum_y = 0;
-        int halfway = int(nets.size()) / 2;
-        for (auto &p : cxs) {
-            if (accum_x < halfway && (accum_x + p.second) >= halfway)
-                mid_x = p.first;
-            accum_x += p.second;
+        bool split_y = (cys.rbegin()->first - cys.begin()->first) > (cxs.rbegin()->first - cxs.begin()->first);
+        auto &hist = split_y ? cys : cxs;
+        int accum = 0, mid = hist.begin()->first;
+        int halfway = int(region_nets.size()) / 2;
+        for (auto &p : hist) {
+            if (accum < halfway && (accum + p.second) >= halfway)
+                mid = p.first;
+            accum += p.second;
         }
-        for (auto &p : cys) {
-            if (accum_y < halfway && (accum_y + p.second) >= halfway)
-                mid_y = p.first;
-            accum_y += p.second;
+        // Don't create a split that leaves one side empty
+        if (mid >= hist.rbegin()->first) {
+            ++partition_leaves;
+            return;
         }
-        if (ctx->verbose) {
-            log_info("    x splitpoint: %d\n", mid_x);
-            log_info("    y splitpoint: %d\n", mid_y);
+        ArcBounds lo = partition.at(node).bb, hi = partition.at(node).bb;
+        if (split_y) {
+            lo.y1 = mid;
+            hi.y0 = mid + 1;
+        } else {
+            lo.x1 = mid;
+            hi.x0 = mid + 1;
         }
-        std::vector<int> bins(5, 0);
-        for (auto &n : nets) {
-            if (n.bb.x0 < mid_x && n.bb.x1 < mid_x && n.bb.y0 < mid_y && n.bb.y1 < mid_y)
-                ++bins[0]; // TL
-            else if (n.bb.x0 >= mid_x && n.bb.x1 >= mid_x && n.bb.y0 < mid_y && n.bb.y1 < mid_y)
-                ++bins[1]; // TR
-            else if (n.bb.x0 < mid_x && n.bb.x1 < mid_x && n.bb.y0 >= mid_y && n.bb.y1 >= mid_y)
-                ++bins[2]; // BL
-            else if (n.bb.x0 >= mid_x && n.bb.x1 >= mid_x && n.bb.y0 >= mid_y && n.bb.y1 >= mid_y)
-                ++bins[3]; // BR
-            else
-                ++bins[4]; // cross-boundary
+        std::vector<int> lo_nets, hi_nets;
+        for (int n : region_nets)
+            ((split_y ? nets.at(n).cy : nets.at(n).cx) <= mid ? lo_nets : hi_nets).push_back(n);
+        for (auto child : {std::make_pair(lo, &lo_nets), std::make_pair(hi, &hi_nets)}) {
+            int idx = int(partition.size());
+            partition.emplace_back();
+            partition.back().bb = child.first;
+            partition.back().parent = node;
+            partition.back().depth = partition.at(node).depth + 1;
+            partition.at(node).children.push_back(idx);
+            split_region(idx, *child.second, max_depth);
+        }
+    }
+
+    void partition_nets()
+    {
+        int max_depth = 0;
+        while ((1 << max_depth) < cfg.regions)
+            ++max_depth;
+        partition.clear();
+        partition_leaves = 0;
+        partition.emplace_back();
+        partition.back().bb = ArcBounds(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+        std::vector<int> all_nets;
+        for (int i = 0; i < int(nets.size()); i++)
+            if (nets.at(i).cx != -1)
+                all_nets.push_back(i);
+        split_region(0, all_nets, max_depth);
+        if (ctx->verbose) {
+            log_info("    partitioned device into %d regions (%d leaves)\n", int(partition.size()), partition_leaves);
+            std::vector<int> bins(partition.size(), 0);
+            for (int i = 0; i < int(nets.size()); i++)
+                ++bins.at(find_net_region(i));
+            for (int i = 0; i < int(partition.size()); i++) {
+                auto &p = partition.at(i);
+                log_info("        region %d (%d, %d) -> (%d, %d) depth=%d N=%d\n", i, p.bb.x0, p.bb.y0, p.bb.x1,
+                         p.bb.y1, p.depth, bins.at(i));
+            }
         }
-        if (ctx->verbose)
-            for (int i = 0; i < 5; i++)
-                log_info("        bin %d N=%d\n", i, bins[i]);
     }
 
     void router_thread(ThreadContext &t, bool is_mt)
@@ -1095,8 +1306,84 @@ struct Router2
         }
     }
 
+    // Route all non-root regions, children before parents. Each worker prefers regions from its own queue and
+    // steals from the others once that is empty; as concurrently routed regions never overlap and each region
+    // has its own RNG, the result is independent of which worker routes which region.
+    void route_regions(std::vector<ThreadContext> &tcs)
+    {
+        std::vector<int> pending(partition.size(), 0);
+        for (size_t i = 1; i < partition.size(); i++)
+            ++pending.at(partition.at(i).parent);
+#ifdef NPNR_DISABLE_THREADS
+        // Post-order walk, so all subregions are routed before their parent
+        std::vector<int> order;
+        std::vector<std::pair<int, bool>> stack{{0, false}};
+        while (!stack.empty()) {
+            auto top = stack.back();
+            stack.pop_back();
+            if (top.second) {
+                order.push_back(top.first);
+                continue;
+            }
+            stack.emplace_back(top.first, true);
+            for (int c : partition.at(top.first).children)
+                stack.emplace_back(c, false);
+        }
+        for (int node : order)
+            if (node != 0)
+                router_thread(tcs.at(node), /*is_mt=*/false);
+#else
+        int n_workers = std::max(1, std::min(cfg.threads, partition_leaves));
+        std::vector<std::deque<int>> queues(n_workers);
+        int next_queue = 0;
+        for (size_t i = 1; i < partition.size(); i++)
+            if (pending.at(i) == 0)
+                queues.at(next_queue++ % n_workers).push_back(int(i));
+        int remaining = int(partition.size()) - 1;
+        std::mutex sched_mutex;
+        std::condition_variable sched_cv;
+        auto worker = [&](int w) {
+            std::unique_lock<std::mutex> lock(sched_mutex);
+            while (true) {
+                int node = -1;
+                if (!queues.at(w).empty()) {
+                    node = queues.at(w).back();
+                    queues.at(w).pop_back();
+                }
+                for (int k = 1; k < n_workers && node == -1; k++) {
+                    auto &victim = queues.at((w + k) % n_workers);
+                    if (!victim.empty()) {
+                        node = victim.front();
+                        victim.pop_front();
+                    }
+                }
+                if (node == -1) {
+                    if (remaining == 0)
+                        break;
+                    sched_cv.wait(lock);
+                    continue;
+                }
+                lock.unlock();
+                router_thread(tcs.at(node), /*is_mt=*/true);
+                lock.lock();
+                --remaining;
+                int parent = partition.at(node).parent;
+                if (parent != 0 && --pending.at(parent) == 0)
+                    queues.at(w).push_back(parent);
+                sched_cv.notify_all();
+            }
+        };
+        std::vector<boost::thread> threads;
+        for (int w = 0; w < n_workers; w++)
+            threads.emplace_back([&worker, w]() { worker(w); });
+        for (auto &t : threads)
+            t.join();
+#endif
+    }
+
     void do_route()
     {
+        check_visit_stamps();
         // Don't multithread if fewer than 200 nets (heuristic)
         if (route_queue.size() < 200) {
             ThreadContext st;
@@ -1107,103 +1394,24 @@ struct Router2
             }
             return;
         }
-        const int Nq = 4, Nv = 2, Nh = 2;
-        const int N = Nq + Nv + Nh;
-        std::vector<ThreadContext> tcs(N + 1);
-        for (auto &th : tcs) {
-            th.rng.rngseed(ctx->rng64());
-        }
-        int le_x = mid_x - cfg.bb_margin_x;
-        int rs_x = mid_x + cfg.bb_margin_x;
-        int le_y = mid_y - cfg.bb_margin_y;
-        int rs_y = mid_y + cfg.bb_margin_y;
-        // Set up thread bounding boxes
-        tcs.at(0).bb = ArcBounds(0, 0, mid_x, mid_y);
-        tcs.at(1).bb = ArcBounds(mid_x + 1, 0, std::numeric_limits<int>::max(), le_y);
-        tcs.at(2).bb = ArcBounds(0, mid_y + 1, mid_x, std::numeric_limits<int>::max());
-        tcs.at(3).bb =
-                ArcBounds(mid_x + 1, mid_y + 1, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(4).bb = ArcBounds(0, 0, std::numeric_limits<int>::max(), mid_y);
-        tcs.at(5).bb = ArcBounds(0, mid_y + 1, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(6).bb = ArcBounds(0, 0, mid_x, std::numeric_limits<int>::max());
-        tcs.at(7).bb = ArcBounds(mid_x + 1, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        tcs.at(8).bb = ArcBounds(0, 0, std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-
-        for (auto n : route_queue) {
-            auto &nd = nets.at(n);
-            auto ni = nets_by_udata.at(n);
-            int bin = N;
-            // Quadrants
-            if (nd.bb.x0 < le_x && nd.bb.x1 < le_x && nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = 0;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x && nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = 1;
-            else if (nd.bb.x0 < le_x && nd.bb.x1 < le_x && nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = 2;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x && nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = 3;
-            // Vertical split
-            else if (nd.bb.y0 < le_y && nd.bb.y1 < le_y)
-                bin = Nq + 0;
-            else if (nd.bb.y0 >= rs_y && nd.bb.y1 >= rs_y)
-                bin = Nq + 1;
-            // Horizontal split
-            else if (nd.bb.x0 < le_x && nd.bb.x1 < le_x)
-                bin = Nq + Nv + 0;
-            else if (nd.bb.x0 >= rs_x && nd.bb.x1 >= rs_x)
-                bin = Nq + Nv + 1;
-            tcs.at(bin).route_nets.push_back(ni);
+        std::vector<ThreadContext> tcs(partition.size());
+        for (size_t i = 0; i < partition.size(); i++) {
+            tcs.at(i).rng.rngseed(ctx->rng64());
+            tcs.at(i).bb = partition.at(i).bb;
         }
+        for (auto n : route_queue)
+            tcs.at(find_net_region(n)).route_nets.push_back(nets_by_udata.at(n));
         if (ctx->verbose)
-            log_info("%d/%d nets not multi-threadable\n", int(tcs.at(N).route_nets.size()), int(route_queue.size()));
-#ifdef NPNR_DISABLE_THREADS
-        // Singlethreaded routing - quadrants
-        for (int i = 0; i < Nq; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
-        // Vertical splits
-        for (int i = Nq; i < Nq + Nv; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
-        // Horizontal splits
-        for (int i = Nq + Nv; i < Nq + Nv + Nh; i++) {
-            router_thread(tcs.at(i), /*is_mt=*/false);
-        }
-#else
-        // Multithreaded part of routing - quadrants
-        std::vector<boost::thread> threads;
-        for (int i = 0; i < Nq; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
-        }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
-        // Vertical splits
-        for (int i = Nq; i < Nq + Nv; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
-        }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
-        // Horizontal splits
-        for (int i = Nq + Nv; i < Nq + Nv + Nh; i++) {
-            threads.emplace_back([this, &tcs, i]() { router_thread(tcs.at(i), /*is_mt=*/true); });
-        }
-        for (auto &t : threads)
-            t.join();
-        threads.clear();
-#endif
-        // Singlethreaded part of routing - nets that cross partitions
+            log_info("%d/%d nets not multi-threadable\n", int(tcs.at(0).route_nets.size()), int(route_queue.size()));
+        route_regions(tcs);
+        // Singlethreaded part of routing - nets that cross the top-level split
         // or don't fit within bounding box
-        for (auto st_net : tcs.at(N).route_nets)
-            route_net(tcs.at(N), st_net, false);
+        for (auto st_net : tcs.at(0).route_nets)
+            route_net(tcs.at(0), st_net, false);
         // Failed nets
-        for (int i = 0; i < N; i++)
+        for (size_t i = 1; i < tcs.size(); i++)
             for (auto fail : tcs.at(i).failed_nets)
-                route_net(tcs.at(N), fail, false);
+                route_net(tcs.at(0), fail, false);
     }
 
     void operator()()
@@ -1230,10 +1438,10 @@ struct Router2
         do {
             ctx->sorted_shuffle(route_queue);
 
-            if (timing_driven && (int(route_queue.size()) > (int(nets_by_udata.size()) / 50))) {
-                // Heuristic: reduce runtime by skipping STA in the case of a "long tail" of a few
-                // congested nodes
-                tmg.run();
+            if (timing_driven) {
+                // Only the nets rerouted in the last iteration have changed delays, so an incremental update is cheap
+                // enough to refresh criticality every iteration
+                tmg.run_incremental();
                 for (auto n : route_queue) {
                     NetInfo *ni = nets_by_udata.at(n);
                     auto &net = nets.at(n);
@@ -1255,6 +1463,22 @@ struct Router2
             }
 #endif
             do_route();
+            if (timing_driven) {
+                for (auto n : route_queue) {
+                    NetInfo *ni = nets_by_udata.at(n);
+#ifdef ARCH_ECP5
+                    if (ni->is_global)
+                        continue;
+#endif
+                    if (ni->driver.cell == nullptr || ni->driver.cell->bel == BelId())
+                        continue;
+                    for (size_t i = 0; i < ni->users.size(); i++) {
+                        if (ni->users.at(i).cell->bel == BelId())
+                            continue;
+                        tmg.set_route_delay(CellPortKey(ni->users.at(i)), DelayPair(get_user_delay(ni, i)));
+                    }
+                }
+            }
             route_queue.clear();
             update_congestion();
 #if 0
@@ -1320,6 +1544,13 @@ Router2Cfg::Router2Cfg(Context *ctx)
     curr_cong_mult = ctx->setting<float>("router2/currCongWeightMult", 2.0f);
     estimate_weight = ctx->setting<float>("router2/estimateWeight", 1.75f);
     perf_profile = ctx->setting<bool>("router2/perfProfile", false);
+#ifdef NPNR_DISABLE_THREADS
+    threads = ctx->setting<int>("router2/threads", 1);
+#else
+    threads = ctx->setting<int>("router2/threads", std::max<int>(1, boost::thread::hardware_concurrency()));
+#endif
+    regions = ctx->setting<int>("router2/regions", 16);
+    flat_graph_max_pips = ctx->setting<int>("router2/flatGraphMaxPips", 50000000);
 }
 
 NEXTPNR_NAMESPACE_END
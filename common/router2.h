@@ -49,6 +49,18 @@ struct Router2Cfg
 
     // Print additional performance profiling information
     bool perf_profile = false;
+
+    // Number of worker threads used for routing nets that fit within a region
+    int threads;
+    // Target number of leaf regions for the recursive bisection of the device.
+    // The assignment of nets to regions depends only on this value, so results
+    // are deterministic for a given seed and region count. The default is fixed
+    // rather than derived from the thread count so results don't depend on the host
+    int regions;
+
+    // Upper limit on the number of pips for which a flattened copy of the downhill routing graph is built
+    // at startup. Above this, the Arch API is queried directly during search to save memory; 0 disables it
+    int flat_graph_max_pips;
 };
 
 void router2(Context *ctx, const Router2Cfg &cfg);
@@ -0,0 +1,441 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "router_lookahead.h"
+
+#include <boost/filesystem.hpp>
+#ifndef NPNR_DISABLE_THREADS
+#include <boost/thread.hpp>
+#endif
+#include <boost/uuid/detail/sha1.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <queue>
+#include <sstream>
+#include <unordered_map>
+
+#include "log.h"
+#include "nextpnr.h"
+#include "util.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+namespace {
+
+// Bump whenever the file format or the way the table is built changes
+static constexpr uint32_t lookahead_version = 1;
+
+struct LookaheadFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t delay_size;
+    int32_t radius;
+    int32_t num_classes;
+    int32_t num_wires;
+    int32_t padding;
+    // Fingerprint of the routing graph and build parameters, as a null-terminated hex string
+    char key[48];
+};
+
+static_assert(sizeof(LookaheadFileHeader) % 8 == 0, "lookahead file header must not need padding");
+
+static const char lookahead_magic[8] = {'N', 'P', 'N', 'R', 'L', 'K', 'A', 'H'};
+
+size_t align8(size_t x) { return (x + 7) & ~size_t(7); }
+
+// Get the (centre) location of a wire, consistent with router2
+std::pair<int, int> wire_location(const Context *ctx, WireId wire)
+{
+    ArcBounds bb = ctx->getRouteBoundingBox(wire, wire);
+    return std::make_pair((bb.x0 + bb.x1) / 2, (bb.y0 + bb.y1) / 2);
+}
+
+std::string default_cache_dir()
+{
+    const char *xdg_cache = std::getenv("XDG_CACHE_HOME");
+    if (xdg_cache != nullptr && xdg_cache[0] != '\0')
+        return std::string(xdg_cache) + "/nextpnr";
+    const char *home = std::getenv("HOME");
+    if (home != nullptr && home[0] != '\0')
+        return std::string(home) + "/.cache/nextpnr";
+    return "";
+}
+
+} // namespace
+
+std::string RouterLookahead::fingerprint(const Context *ctx, int samples, int max_explore) const
+{
+    // Hashing the whole routing graph would take about as long as just building the lookahead; so hash its size
+    // and the connectivity and delays of a subset of wires. This is enough to catch a different device, speed grade
+    // or chipdb version.
+    boost::uuids::detail::sha1 hasher;
+    auto add = [&](int32_t x) { hasher.process_bytes(&x, sizeof(x)); };
+    std::string arch = ctx->archId().str(ctx) + "/" + ctx->archArgsToId(ctx->archArgs()).str(ctx);
+    hasher.process_bytes(arch.data(), arch.size());
+    add(lookahead_version);
+    add(sizeof(delay_t));
+    add(radius);
+    add(samples);
+    add(max_explore);
+    add(ctx->getWireCount());
+    add(ctx->getPipCount());
+    int i = 0;
+    for (auto wire : ctx->getWires()) {
+        if ((i++ % 61) != 0)
+            continue;
+        add(ctx->getWireIndex(wire));
+        delay_t wire_delay = ctx->getWireDelay(wire).maxDelay();
+        hasher.process_bytes(&wire_delay, sizeof(delay_t));
+        for (auto pip : ctx->getPipsDownhill(wire)) {
+            add(ctx->getPipIndex(pip));
+            add(ctx->getWireIndex(ctx->getPipDstWire(pip)));
+            delay_t pip_delay = ctx->getPipDelay(pip).maxDelay();
+            hasher.process_bytes(&pip_delay, sizeof(delay_t));
+        }
+    }
+    boost::uuids::detail::sha1::digest_type digest;
+    hasher.get_digest(digest);
+    std::ostringstream buf;
+    for (int j = 0; j < 5; ++j)
+        buf << std::hex << std::setfill('0') << std::setw(8) << digest[j];
+    return buf.str();
+}
+
+void RouterLookahead::build(const Context *ctx, int samples, int max_explore, int threads)
+{
+    auto build_start = std::chrono::high_resolution_clock::now();
+    int wire_count = ctx->getWireCount();
+    int width = 2 * radius + 1;
+
+    // Assign wires to classes; and pick the wires closest to the centre of the device as samples, so that as much
+    // of the window as possible falls inside the device
+    int max_x = 0, max_y = 0;
+    wires_data.resize(wire_count);
+    for (auto wire : ctx->getWires()) {
+        auto loc = wire_location(ctx, wire);
+        max_x = std::max(max_x, loc.first);
+        max_y = std::max(max_y, loc.second);
+    }
+    int centre_x = max_x / 2, centre_y = max_y / 2;
+
+    std::unordered_map<IdString, int> class_idx;
+    // Candidate sample wires, ordered by distance to the centre
+    std::vector<std::vector<std::pair<int, WireId>>> class_samples;
+    for (auto wire : ctx->getWires()) {
+        IdStringList name = ctx->getWireName(wire);
+        IdString basename = name[name.size() - 1];
+        auto fnd = class_idx.find(basename);
+        int cls;
+        if (fnd == class_idx.end()) {
+            cls = int(class_samples.size());
+            class_idx[basename] = cls;
+            class_samples.emplace_back();
+        } else {
+            cls = fnd->second;
+        }
+        auto loc = wire_location(ctx, wire);
+        WireEntry &entry = wires_data.at(ctx->getWireIndex(wire));
+        entry.cls = cls;
+        entry.x = loc.first;
+        entry.y = loc.second;
+        // Keep the closest few to the centre as samples
+        auto &cs = class_samples.at(cls);
+        int dist = std::abs(loc.first - centre_x) + std::abs(loc.second - centre_y);
+        if (int(cs.size()) < samples || dist < cs.back().first) {
+            auto pos = std::upper_bound(
+                    cs.begin(), cs.end(), dist,
+                    [](int d, const std::pair<int, WireId> &s) { return d < s.first; });
+            cs.insert(pos, std::make_pair(dist, wire));
+            if (int(cs.size()) > samples)
+                cs.pop_back();
+        }
+    }
+    num_classes = int(class_samples.size());
+
+    const delay_t unknown = -1;
+    table_data.assign(size_t(num_classes) * class_stride(), unknown);
+    penalty_data.assign(num_classes, 0);
+
+    // Explore the routing graph from each sample wire, Dijkstra-style, keeping the lowest delay seen at each offset.
+    // Classes are independent, so they are split between threads, each with its own scratch state
+    struct QueuedWire
+    {
+        delay_t delay;
+        int idx;
+        WireId wire;
+        bool operator>(const QueuedWire &other) const { return delay > other.delay; }
+    };
+    struct ThreadState
+    {
+        std::priority_queue<QueuedWire, std::vector<QueuedWire>, std::greater<QueuedWire>> queue;
+        std::vector<uint32_t> visit_stamp;
+        std::vector<delay_t> visit_delay;
+        uint32_t stamp = 0;
+    };
+
+    auto process_class = [&](int cls, ThreadState &ts) {
+        delay_t *cls_table = table_data.data() + size_t(cls) * class_stride();
+        for (auto &sample : class_samples.at(cls)) {
+            ++ts.stamp;
+            int src_idx = ctx->getWireIndex(sample.second);
+            const WireEntry &src = wires_data.at(src_idx);
+            ts.queue.push(QueuedWire{0, src_idx, sample.second});
+            ts.visit_stamp[src_idx] = ts.stamp;
+            ts.visit_delay[src_idx] = 0;
+            int explored = 0;
+            while (!ts.queue.empty()) {
+                QueuedWire curr = ts.queue.top();
+                ts.queue.pop();
+                if (curr.delay > ts.visit_delay[curr.idx])
+                    continue; // stale entry
+                const WireEntry &cw = wires_data.at(curr.idx);
+                int dx = cw.x - src.x, dy = cw.y - src.y;
+                delay_t &entry = cls_table[(dy + radius) * width + (dx + radius)];
+                if (entry == unknown || curr.delay < entry)
+                    entry = curr.delay;
+                if (++explored >= max_explore)
+                    continue; // just drain the queue
+                for (auto pip : ctx->getPipsDownhill(curr.wire)) {
+                    WireId next = ctx->getPipDstWire(pip);
+                    int next_idx = ctx->getWireIndex(next);
+                    const WireEntry &nw = wires_data.at(next_idx);
+                    if (std::abs(nw.x - src.x) > radius || std::abs(nw.y - src.y) > radius)
+                        continue;
+                    delay_t next_delay =
+                            curr.delay + ctx->getPipDelay(pip).maxDelay() + ctx->getWireDelay(next).maxDelay();
+                    if (ts.visit_stamp[next_idx] == ts.stamp && ts.visit_delay[next_idx] <= next_delay)
+                        continue;
+                    ts.visit_stamp[next_idx] = ts.stamp;
+                    ts.visit_delay[next_idx] = next_delay;
+                    ts.queue.push(QueuedWire{next_delay, next_idx, next});
+                }
+            }
+        }
+
+        // Use the average delay per tile for extrapolation and to fill holes
+        double total_slope = 0;
+        int slope_count = 0;
+        for (int dy = -radius; dy <= radius; dy++)
+            for (int dx = -radius; dx <= radius; dx++) {
+                delay_t d = cls_table[(dy + radius) * width + (dx + radius)];
+                if (d == unknown || (dx == 0 && dy == 0))
+                    continue;
+                total_slope += double(d) / (std::abs(dx) + std::abs(dy));
+                ++slope_count;
+            }
+        if (slope_count == 0) {
+            // Wires that don't lead anywhere (e.g. cell inputs); let the arch estimate handle them
+            penalty_data.at(cls) = -1;
+            return;
+        }
+        penalty_data.at(cls) = delay_t(total_slope / slope_count);
+        // Fill in offsets that weren't reached from their already known neighbours
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int y = 0; y < width; y++)
+                for (int x = 0; x < width; x++) {
+                    delay_t &d = cls_table[y * width + x];
+                    if (d != unknown)
+                        continue;
+                    delay_t best = unknown;
+                    auto check = [&](int nx, int ny) {
+                        if (nx < 0 || ny < 0 || nx >= width || ny >= width)
+                            return;
+                        delay_t nd = cls_table[ny * width + nx];
+                        if (nd != unknown && (best == unknown || nd < best))
+                            best = nd;
+                    };
+                    check(x - 1, y);
+                    check(x + 1, y);
+                    check(x, y - 1);
+                    check(x, y + 1);
+                    if (best != unknown) {
+                        d = best + penalty_data.at(cls);
+                        changed = true;
+                    }
+                }
+        }
+    };
+
+    auto worker = [&](int tid, int n_threads) {
+        ThreadState ts;
+        ts.visit_stamp.resize(wire_count, 0);
+        ts.visit_delay.resize(wire_count, 0);
+        for (int cls = tid; cls < num_classes; cls += n_threads)
+            process_class(cls, ts);
+    };
+#ifdef NPNR_DISABLE_THREADS
+    worker(0, 1);
+#else
+    int n_threads = std::max(1, std::min(threads, num_classes));
+    std::vector<boost::thread> workers;
+    for (int i = 1; i < n_threads; i++)
+        workers.emplace_back([&worker, i, n_threads]() { worker(i, n_threads); });
+    worker(0, n_threads);
+    for (auto &w : workers)
+        w.join();
+#endif
+
+    // Classes without any data are marked in the per-wire entries, so there is only one check at lookup time
+    for (auto &w : wires_data)
+        if (penalty_data.at(w.cls) < 0)
+            w.cls = -1;
+
+    wires = wires_data.data();
+    penalty = penalty_data.data();
+    table = table_data.data();
+
+    log_info("    built lookahead for %d wire classes in %.02fs\n", num_classes,
+             std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - build_start).count());
+}
+
+bool RouterLookahead::read_cache(const Context *ctx, const std::string &filename, const std::string &key)
+{
+    if (!boost::filesystem::exists(filename))
+        return false;
+    try {
+        cache_file.open(filename);
+    } catch (...) {
+        return false;
+    }
+    if (!cache_file.is_open())
+        return false;
+    const char *data = cache_file.data();
+    size_t size = cache_file.size();
+    if (size < sizeof(LookaheadFileHeader))
+        return false;
+    LookaheadFileHeader hdr;
+    std::memcpy(&hdr, data, sizeof(hdr));
+    if (std::memcmp(hdr.magic, lookahead_magic, sizeof(lookahead_magic)) != 0 || hdr.version != lookahead_version ||
+        hdr.delay_size != sizeof(delay_t) || hdr.radius != radius || hdr.num_wires != ctx->getWireCount() ||
+        key != std::string(hdr.key, strnlen(hdr.key, sizeof(hdr.key))))
+        return false;
+    num_classes = hdr.num_classes;
+    size_t wires_offset = align8(sizeof(LookaheadFileHeader));
+    size_t penalty_offset = align8(wires_offset + sizeof(WireEntry) * size_t(hdr.num_wires));
+    size_t table_offset = align8(penalty_offset + sizeof(delay_t) * size_t(num_classes));
+    size_t end = table_offset + sizeof(delay_t) * size_t(num_classes) * class_stride();
+    if (size != end)
+        return false;
+    wires = reinterpret_cast<const WireEntry *>(data + wires_offset);
+    penalty = reinterpret_cast<const delay_t *>(data + penalty_offset);
+    table = reinterpret_cast<const delay_t *>(data + table_offset);
+    return true;
+}
+
+void RouterLookahead::write_cache(const Context *ctx, const std::string &filename, const std::string &key) const
+{
+    LookaheadFileHeader hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, lookahead_magic, sizeof(lookahead_magic));
+    hdr.version = lookahead_version;
+    hdr.delay_size = sizeof(delay_t);
+    hdr.radius = radius;
+    hdr.num_classes = num_classes;
+    hdr.num_wires = ctx->getWireCount();
+    NPNR_ASSERT(key.size() < sizeof(hdr.key));
+    std::memcpy(hdr.key, key.data(), key.size());
+
+    // Write to a temporary file first and then rename it, so concurrent runs never see a partial file
+    std::string tmp_filename;
+    try {
+        tmp_filename = boost::filesystem::unique_path(filename + ".%%%%-%%%%.tmp").string();
+        boost::filesystem::create_directories(boost::filesystem::path(filename).parent_path());
+        std::ofstream out(tmp_filename, std::ios::binary);
+        if (!out)
+            throw std::runtime_error("failed to open file");
+        auto write_padded = [&](const void *ptr, size_t size) {
+            out.write(reinterpret_cast<const char *>(ptr), size);
+            static const char zeros[8] = {0};
+            out.write(zeros, align8(size) - size);
+        };
+        write_padded(&hdr, sizeof(hdr));
+        write_padded(wires, sizeof(WireEntry) * size_t(hdr.num_wires));
+        write_padded(penalty, sizeof(delay_t) * size_t(num_classes));
+        out.write(reinterpret_cast<const char *>(table), sizeof(delay_t) * size_t(num_classes) * class_stride());
+        out.close();
+        if (!out)
+            throw std::runtime_error("failed to write file");
+        boost::filesystem::rename(tmp_filename, filename);
+    } catch (const std::exception &e) {
+        log_warning("Failed to write router lookahead cache '%s': %s\n", filename.c_str(), e.what());
+        boost::system::error_code ec;
+        if (!tmp_filename.empty())
+            boost::filesystem::remove(tmp_filename, ec);
+    }
+}
+
+void RouterLookahead::init(Context *ctx)
+{
+    if (ready)
+        return;
+    if (ctx->getWireCount() == 0) {
+        log_warning("Router lookahead requires dense wire indices, which this architecture does not provide.\n");
+        return;
+    }
+    radius = ctx->setting<int>("router/lookahead/radius", 12);
+    int samples = ctx->setting<int>("router/lookahead/samples", 2);
+    int max_explore = ctx->setting<int>("router/lookahead/maxExplore", 20000);
+#ifdef NPNR_DISABLE_THREADS
+    int threads = 1;
+#else
+    int threads =
+            ctx->setting<int>("router/lookahead/threads", std::max<int>(1, boost::thread::hardware_concurrency()));
+#endif
+    std::string cache_dir = str_or_default(ctx->settings, ctx->id("router/lookahead/cacheDir"), default_cache_dir());
+    bool rebuild = ctx->setting<bool>("router/lookahead/rebuild", false);
+
+    log_info("Setting up router lookahead...\n");
+    std::string key = fingerprint(ctx, samples, max_explore);
+    std::string filename;
+    if (!cache_dir.empty())
+        filename = cache_dir + "/" + ctx->archId().str(ctx) + "-" + ctx->archArgsToId(ctx->archArgs()).str(ctx) +
+                   "-" + key + ".lookahead";
+
+    if (!filename.empty() && !rebuild && read_cache(ctx, filename, key)) {
+        log_info("    loaded lookahead for %d wire classes from '%s'\n", num_classes, filename.c_str());
+    } else {
+        if (cache_file.is_open())
+            cache_file.close();
+        build(ctx, samples, max_explore, threads);
+        if (!filename.empty()) {
+            write_cache(ctx, filename, key);
+            // Use the mapped copy, so the memory for the one we built can be freed
+            if (read_cache(ctx, filename, key)) {
+                std::vector<WireEntry>().swap(wires_data);
+                std::vector<delay_t>().swap(penalty_data);
+                std::vector<delay_t>().swap(table_data);
+            } else {
+                if (cache_file.is_open())
+                    cache_file.close();
+                wires = wires_data.data();
+                penalty = penalty_data.data();
+                table = table_data.data();
+            }
+        }
+    }
+    ready = true;
+}
+
+NEXTPNR_NAMESPACE_END
@@ -0,0 +1,103 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef ROUTER_LOOKAHEAD_H
+#define ROUTER_LOOKAHEAD_H
+
+#include <algorithm>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "nextpnr_namespaces.h"
+#include "nextpnr_types.h"
+
+NEXTPNR_NAMESPACE_BEGIN
+
+struct Context;
+
+// A routing delay lookahead that works for any arch implementing dense wire indices.
+//
+// Wires are grouped into classes by the last element of their name (e.g. all the "H06E0102" wires of an ECP5
+// device form one class). For each class, the routing graph is explored from a few sample wires to find the
+// minimum delay to reach any wire at each (dx, dy) offset within a window; offsets outside of the window are
+// extrapolated using the average delay per tile of the class.
+//
+// Building the table is fairly expensive, so it is cached on disk keyed by a fingerprint of the routing graph and
+// memory-mapped when reused.
+struct RouterLookahead
+{
+    // Load the lookahead from the cache, or build (and cache) it if there isn't a valid one
+    void init(Context *ctx);
+
+    bool is_ready() const { return ready; }
+
+    // Takes the dense indices of the source and destination wire. Returns false if there is no data for the source
+    // wire, in which case the arch should fall back to its own estimate
+    bool estimateDelay(int src_index, int dst_index, delay_t &delay) const
+    {
+        if (!ready)
+            return false;
+        const WireEntry &s = wires[src_index], &d = wires[dst_index];
+        if (s.cls < 0)
+            return false;
+        int dx = d.x - s.x, dy = d.y - s.y;
+        int cdx = std::min(std::max(dx, -radius), radius), cdy = std::min(std::max(dy, -radius), radius);
+        delay = table[size_t(s.cls) * class_stride() + (cdy + radius) * (2 * radius + 1) + (cdx + radius)] +
+                penalty[s.cls] * (std::abs(dx - cdx) + std::abs(dy - cdy));
+        return true;
+    }
+
+  private:
+    // This layout is shared with the cache file, so must not contain any padding
+    struct WireEntry
+    {
+        // Index of wire class, -1 if no data was found
+        int32_t cls;
+        // Location of the wire
+        int16_t x, y;
+    };
+
+    bool ready = false;
+    int radius = 0;
+    int num_classes = 0;
+
+    // These point either into the owned vectors below, or into the memory-mapped cache file
+    const WireEntry *wires = nullptr;
+    const delay_t *penalty = nullptr;
+    const delay_t *table = nullptr;
+
+    std::vector<WireEntry> wires_data;
+    std::vector<delay_t> penalty_data, table_data;
+    boost::iostreams::mapped_file_source cache_file;
+
+    static_assert(sizeof(WireEntry) == 8, "WireEntry must not contain padding");
+
+    size_t class_stride() const { return size_t(2 * radius + 1) * size_t(2 * radius + 1); }
+
+    std::string fingerprint(const Context *ctx, int samples, int max_explore) const;
+    void build(const Context *ctx, int samples, int max_explore, int threads);
+    bool read_cache(const Context *ctx, const std::string &filename, const std::string &key);
+    void write_cache(const Context *ctx, const std::string &filename, const std::string &key) const;
+};
+
+NEXTPNR_NAMESPACE_END
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <vector>
+#include "design_utils.h"
+#include "gtest/gtest.h"
+#include "nextpnr.h"
+#include "log.h"
+
+USING_NEXTPNR_NAMESPACE
+
+class DesignUtilsTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        ctx = new Context(chipArgs);
+        net = ctx->createNet(ctx->id("net"));
+        for (int i = 0; i < 5; i++) {
+            CellInfo *cell = ctx->createCell(ctx->id(stringf("cell%d", i)), ctx->id("BUF"));
+            cell->addInput(ctx->id("I"));
+            connect_port(ctx, net, cell, ctx->id("I"));
+            cells.push_back(cell);
+        }
+    }
+
+    virtual void TearDown() { delete ctx; }
+
+    // Every user's port must record its own index in the user list
+    void check_user_idx()
+    {
+        for (int i = 0; i < int(net->users.size()); i++) {
+            const PortRef &user = net->users.at(i);
+            const PortInfo &port = user.cell->ports.at(user.port);
+            EXPECT_EQ(port.net, net);
+            EXPECT_EQ(port.user_idx, i);
+        }
+    }
+
+    ArchArgs chipArgs;
+    Context *ctx;
+    NetInfo *net;
+    std::vector<CellInfo *> cells;
+};
+
+TEST_F(DesignUtilsTest, connect_records_index)
+{
+    ASSERT_EQ(net->users.size(), size_t(5));
+    check_user_idx();
+}
+
+TEST_F(DesignUtilsTest, disconnect_swaps_last_user)
+{
+    disconnect_port(ctx, cells.at(1), ctx->id("I"));
+    ASSERT_EQ(net->users.size(), size_t(4));
+    // The last user is moved into the freed slot
+    EXPECT_EQ(net->users.at(1).cell, cells.at(4));
+    EXPECT_EQ(cells.at(1)->ports.at(ctx->id("I")).net, nullptr);
+    EXPECT_EQ(cells.at(1)->ports.at(ctx->id("I")).user_idx, -1);
+    check_user_idx();
+
+    disconnect_port(ctx, cells.at(0), ctx->id("I"));
+    disconnect_port(ctx, cells.at(2), ctx->id("I"));
+    ASSERT_EQ(net->users.size(), size_t(2));
+    check_user_idx();
+
+    // Disconnecting the last user doesn't move anything
+    disconnect_port(ctx, net->users.back().cell, ctx->id("I"));
+    ASSERT_EQ(net->users.size(), size_t(1));
+    check_user_idx();
+}
+
+TEST_F(DesignUtilsTest, remove_users_if_refreshes_index)
+{
+    net->remove_users_if([&](const PortRef &user) { return user.cell == cells.at(0) || user.cell == cells.at(2); });
+    ASSERT_EQ(net->users.size(), size_t(3));
+    EXPECT_EQ(net->users.at(0).cell, cells.at(1));
+    check_user_idx();
+
+    disconnect_port(ctx, cells.at(1), ctx->id("I"));
+    ASSERT_EQ(net->users.size(), size_t(2));
+    check_user_idx();
+}
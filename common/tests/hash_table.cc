@@ -0,0 +1,194 @@
+/*
+ *  nextpnr -- Next Generation Place and Route
+ *
+ *  Copyright (C) 2026  The nextpnr Authors
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "hash_table.h"
+
+USING_NEXTPNR_NAMESPACE
+
+namespace {
+
+// Puts every key in the same home slot, to exercise linear probing and backward-shift deletion
+struct CollidingHash
+{
+    std::size_t operator()(int) const { return 0; }
+};
+
+// A fixed but scrambled insertion order
+std::vector<int> scrambled_keys(int n)
+{
+    std::vector<int> keys;
+    for (int i = 0; i < n; i++)
+        keys.push_back((i * 7919) % n);
+    return keys;
+}
+
+template <typename Container> std::vector<int> dict_keys(const Container &d)
+{
+    std::vector<int> keys;
+    for (auto &kv : d)
+        keys.push_back(kv.first);
+    return keys;
+}
+
+} // namespace
+
+TEST(HashTableTest, insertion_order)
+{
+    auto keys = scrambled_keys(1000);
+    dict<int, std::string> d;
+    pool<int> p;
+    for (int k : keys) {
+        d[k] = std::to_string(k);
+        p.insert(k);
+    }
+    ASSERT_EQ(dict_keys(d), keys);
+    ASSERT_EQ(std::vector<int>(p.begin(), p.end()), keys);
+
+    // Re-inserting an existing key keeps its position
+    ASSERT_FALSE(d.emplace(keys.front(), "x").second);
+    ASSERT_FALSE(p.insert(keys.front()).second);
+    ASSERT_EQ(dict_keys(d), keys);
+    ASSERT_EQ(d.at(keys.front()), std::to_string(keys.front()));
+
+    // An erased and re-inserted key moves to the end
+    d.erase(keys.front());
+    d[keys.front()] = "again";
+    std::vector<int> expected(keys.begin() + 1, keys.end());
+    expected.push_back(keys.front());
+    ASSERT_EQ(dict_keys(d), expected);
+}
+
+TEST(HashTableTest, erase_during_iteration)
+{
+    dict<int, int> d;
+    pool<int> p;
+    for (int i = 0; i < 100; i++) {
+        d[i] = i * 2;
+        p.insert(i);
+    }
+    for (auto it = d.begin(); it != d.end();) {
+        if (it->first % 3 == 0)
+            it = d.erase(it);
+        else
+            ++it;
+    }
+    for (auto it = p.begin(); it != p.end();) {
+        if (*it % 3 == 0)
+            it = p.erase(it);
+        else
+            ++it;
+    }
+    // Erasing an element other than the current one doesn't disturb the iteration either
+    std::vector<int> visited;
+    for (auto it = d.begin(); it != d.end(); ++it) {
+        visited.push_back(it->first);
+        d.erase(it->first + 1);
+    }
+
+    std::vector<int> expected;
+    for (int i = 0; i < 100; i++)
+        if (i % 3 != 0)
+            expected.push_back(i);
+    ASSERT_EQ(std::vector<int>(p.begin(), p.end()), expected);
+    expected.clear();
+    for (int i = 0; i < 100; i++)
+        if (i % 3 == 1)
+            expected.push_back(i);
+    ASSERT_EQ(visited, expected);
+    ASSERT_EQ(dict_keys(d), expected);
+    ASSERT_EQ(d.size(), expected.size());
+    for (int k : expected)
+        ASSERT_EQ(d.at(k), k * 2);
+}
+
+TEST(HashTableTest, compaction)
+{
+    // Churn through many more keys than are ever live at once; erased entries must be compacted away rather than
+    // accumulating, and the survivors must keep their relative order and remain findable
+    dict<int, int> d;
+    for (int i = 0; i < 16; i++)
+        d[i] = i;
+    std::size_t baseline = d.memory_usage();
+    for (int i = 16; i < 100000; i++) {
+        d.erase(i - 16);
+        d[i] = i;
+        ASSERT_EQ(d.size(), 16u);
+    }
+    ASSERT_LE(d.memory_usage(), 4 * baseline);
+    std::vector<int> expected;
+    for (int i = 100000 - 16; i < 100000; i++)
+        expected.push_back(i);
+    ASSERT_EQ(dict_keys(d), expected);
+    for (int k : expected)
+        ASSERT_EQ(d.at(k), k);
+    ASSERT_EQ(d.count(100000 - 17), 0u);
+}
+
+TEST(HashTableTest, rehash_growth)
+{
+    dict<int, int> d;
+    dict<int, int, CollidingHash> colliding;
+    for (int i = 0; i < 20000; i++) {
+        d[i * 64] = i;
+        if (i < 500)
+            colliding[i] = i;
+        // Check earlier keys survive each time the lookup table doubles
+        if ((i & (i - 1)) == 0) {
+            for (int j = 0; j <= i; j++)
+                ASSERT_EQ(d.at(j * 64), j);
+        }
+    }
+    ASSERT_EQ(d.size(), 20000u);
+    ASSERT_EQ(d.count(1), 0u);
+    ASSERT_EQ(colliding.size(), 500u);
+
+    // Backward-shift deletion must keep the remaining entries of a probe chain reachable
+    for (int i = 0; i < 500; i += 2)
+        colliding.erase(i);
+    for (int i = 0; i < 500; i++)
+        ASSERT_EQ(colliding.count(i), size_t(i % 2));
+}
+
+TEST(HashTableTest, reference_stability)
+{
+    dict<int, std::string> d;
+    d.reserve(1000);
+    std::vector<std::string *> refs;
+    for (int i = 0; i < 100; i++)
+        refs.push_back(&d[i]);
+    for (int i = 0; i < 100; i++)
+        *refs.at(i) = std::to_string(i);
+    // Inserting up to the reserved size doesn't move elements
+    for (int i = 100; i < 1000; i++)
+        d[i] = std::to_string(i);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(refs.at(i), &d.at(i));
+        ASSERT_EQ(*refs.at(i), std::to_string(i));
+    }
+    // Erasing one element leaves references to the others intact
+    for (int i = 0; i < 100; i += 2)
+        d.erase(i);
+    for (int i = 1; i < 100; i += 2) {
+        ASSERT_EQ(refs.at(i), &d.at(i));
+        ASSERT_EQ(*refs.at(i), std::to_string(i));
+    }
+}
@@ -20,10 +20,15 @@
 
 #include "timing.h"
 #include <algorithm>
-#include <boost/range/adaptor/reversed.hpp>
-#include <deque>
+#include <atomic>
+#ifndef NPNR_DISABLE_THREADS
+#include <boost/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#endif
 #include <map>
+#include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include "log.h"
 #include "util.h"
@@ -32,6 +37,11 @@ NEXTPNR_NAMESPACE_BEGIN
 
 void TimingAnalyser::setup()
 {
+#ifdef NPNR_DISABLE_THREADS
+    threads = 1;
+#else
+    threads = ctx->setting<int>("timing/threads", std::max<int>(1, boost::thread::hardware_concurrency()));
+#endif
     init_ports();
     get_cell_delays();
     topo_sort();
@@ -49,55 +59,219 @@ void TimingAnalyser::run()
     compute_criticality();
 }
 
+void TimingAnalyser::set_route_delay(CellPortKey port, DelayPair value)
+{
+    port_id_t p = port_index(port);
+    auto &pd = ports.at(p);
+    if (pd.route_delay.min_delay == value.min_delay && pd.route_delay.max_delay == value.max_delay)
+        return;
+    pd.route_delay = value;
+    if (!pd.dirty) {
+        pd.dirty = true;
+        dirty_ports.push_back(p);
+    }
+}
+
+void TimingAnalyser::run_incremental()
+{
+    if (dirty_ports.empty())
+        return;
+    // Arrival times change in the fan-out cone of the changed sinks; required times in the fan-in cone of their
+    // drivers
+    std::vector<port_id_t> fwd_cone, bwd_cone;
+    auto visit_fwd = [&](port_id_t next) {
+        auto &next_pd = ports.at(next);
+        if (next_pd.in_fwd_cone)
+            return;
+        next_pd.in_fwd_cone = true;
+        fwd_cone.push_back(next);
+    };
+    auto visit_bwd = [&](port_id_t next) {
+        auto &next_pd = ports.at(next);
+        if (next_pd.in_bwd_cone)
+            return;
+        next_pd.in_bwd_cone = true;
+        bwd_cone.push_back(next);
+    };
+    for (auto p : dirty_ports) {
+        auto &pd = ports.at(p);
+        pd.dirty = false;
+        visit_fwd(p);
+        if (pd.net != nullptr && pd.net->driver.cell != nullptr)
+            visit_bwd(port_index(CellPortKey(pd.net->driver)));
+    }
+    dirty_ports.clear();
+    for (size_t i = 0; i < fwd_cone.size(); i++) {
+        auto &pd = ports.at(fwd_cone.at(i));
+        if (pd.type == PORT_OUT) {
+            for (auto usr : pd.users)
+                visit_fwd(usr);
+        } else if (pd.type == PORT_IN) {
+            for (auto &fanout : pd.cell_arcs)
+                if (fanout.type == CellArc::COMBINATIONAL)
+                    visit_fwd(fanout.other_port);
+        }
+    }
+    for (size_t i = 0; i < bwd_cone.size(); i++) {
+        auto &pd = ports.at(bwd_cone.at(i));
+        if (pd.type == PORT_IN) {
+            if (pd.net != nullptr && pd.net->driver.cell != nullptr)
+                visit_bwd(port_index(CellPortKey(pd.net->driver)));
+        } else if (pd.type == PORT_OUT) {
+            for (auto &fanin : pd.cell_arcs)
+                if (fanin.type == CellArc::COMBINATIONAL)
+                    visit_bwd(fanin.other_port);
+        }
+    }
+
+    auto clear_cones = [&]() {
+        for (auto p : fwd_cone)
+            ports.at(p).in_fwd_cone = false;
+        for (auto p : bwd_cone)
+            ports.at(p).in_bwd_cone = false;
+    };
+
+    // Without a valid topological order, or if most of the design is affected anyway, a full walk is simpler and no
+    // slower. The route delays are already up to date, so they aren't fetched again
+    if (have_loops || (fwd_cone.size() + bwd_cone.size()) > ports.size()) {
+        clear_cones();
+        reset_times();
+        walk_forward();
+        walk_backward();
+        compute_slack();
+        compute_criticality();
+        return;
+    }
+
+    auto topo_less = [&](port_id_t a, port_id_t b) { return ports.at(a).topo_index < ports.at(b).topo_index; };
+    std::sort(fwd_cone.begin(), fwd_cone.end(), topo_less);
+    std::sort(bwd_cone.begin(), bwd_cone.end(), topo_less);
+
+    for (auto p : fwd_cone)
+        for (auto &arr : ports.at(p).arrival)
+            arr.second = ArrivReqTime{init_delay};
+    for (auto p : bwd_cone)
+        for (auto &req : ports.at(p).required)
+            req.second = ArrivReqTime{init_delay};
+
+    for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
+        auto &dom = domains.at(dom_id);
+        for (auto &sp : dom.startpoints)
+            if (ports.at(sp.first).in_fwd_cone)
+                init_startpoint(dom_id, sp);
+        for (auto &ep : dom.endpoints)
+            if (ports.at(ep.first).in_bwd_cone)
+                init_endpoint(dom_id, ep);
+    }
+    // Everything outside of the cones is unchanged, so times can be pulled from the fan-in (fan-out) of each port in
+    // topological (reverse topological) order
+    for (auto p : fwd_cone)
+        pull_arrival(p);
+    for (auto p : reversed_range(bwd_cone))
+        pull_required(p);
+
+    // Update slack of the affected ports, then the worst slack of every domain pair
+    for (auto p : fwd_cone)
+        compute_port_slack(p);
+    for (auto p : bwd_cone)
+        if (!ports.at(p).in_fwd_cone)
+            compute_port_slack(p);
+    std::vector<std::pair<delay_t, delay_t>> old_worst;
+    for (auto &dp : domain_pairs) {
+        old_worst.emplace_back(dp.worst_setup_slack, dp.worst_hold_slack);
+        dp.worst_setup_slack = std::numeric_limits<delay_t>::max();
+        dp.worst_hold_slack = std::numeric_limits<delay_t>::max();
+    }
+    for (auto &pd : ports) {
+        for (auto &pdp : pd.domain_pairs) {
+            auto &dp = domain_pairs.at(pdp.first);
+            dp.worst_setup_slack = std::min(dp.worst_setup_slack, pdp.second.setup_slack);
+            if (!setup_only)
+                dp.worst_hold_slack = std::min(dp.worst_hold_slack, pdp.second.hold_slack);
+        }
+    }
+    bool worst_changed = false;
+    for (size_t i = 0; i < domain_pairs.size(); i++)
+        if (domain_pairs.at(i).worst_setup_slack != old_worst.at(i).first)
+            worst_changed = true;
+
+    // Criticality is relative to the worst slack of the domain pair; so if that changed everything must be updated
+    if (worst_changed) {
+        compute_criticality();
+    } else {
+        for (auto p : fwd_cone)
+            compute_port_criticality(p);
+        for (auto p : bwd_cone)
+            if (!ports.at(p).in_fwd_cone)
+                compute_port_criticality(p);
+    }
+    clear_cones();
+}
+
 void TimingAnalyser::init_ports()
 {
+    ports.clear();
+    port_to_id.clear();
     // Per cell port structures
     for (auto cell : sorted(ctx->cells)) {
         CellInfo *ci = cell.second;
         for (auto port : sorted_ref(ci->ports)) {
-            auto &data = ports[CellPortKey(ci->name, port.first)];
+            CellPortKey key(ci->name, port.first);
+            port_to_id[key] = port_id_t(ports.size());
+            ports.emplace_back();
+            auto &data = ports.back();
             data.type = port.second.type;
-            data.cell_port = CellPortKey(ci->name, port.first);
+            data.cell_port = key;
+            data.net = port.second.net;
         }
     }
-    // Cell port to net port mapping
+    // Cell port to net port mapping, and connectivity by port index
     for (auto net : sorted(ctx->nets)) {
         NetInfo *ni = net.second;
-        if (ni->driver.cell != nullptr)
-            ports[CellPortKey(ni->driver)].net_port = NetPortKey(ni->name);
-        for (size_t i = 0; i < ni->users.size(); i++)
-            ports[CellPortKey(ni->users.at(i))].net_port = NetPortKey(ni->name, i);
+        port_id_t drv = -1;
+        if (ni->driver.cell != nullptr) {
+            drv = port_index(CellPortKey(ni->driver));
+            ports.at(drv).net_port = NetPortKey(ni->name);
+            if (ports.at(drv).type != PORT_OUT)
+                drv = -1;
+        }
+        for (size_t i = 0; i < ni->users.size(); i++) {
+            port_id_t usr = port_index(CellPortKey(ni->users.at(i)));
+            ports.at(usr).net_port = NetPortKey(ni->name, i);
+            ports.at(usr).driver = drv;
+            if (drv != -1)
+                ports.at(drv).users.push_back(usr);
+        }
     }
 }
 
 void TimingAnalyser::get_cell_delays()
 {
-    for (auto &port : ports) {
-        CellInfo *ci = cell_info(port.first);
-        auto &pi = port_info(port.first);
-        auto &pd = port.second;
-
-        IdString name = port.first.port;
+    for (auto &pd : ports) {
+        CellInfo *ci = ctx->cells.at(pd.cell_port.cell).get();
+        IdString name = pd.cell_port.port;
         // Ignore dangling ports altogether for timing purposes
         if (pd.net_port.net == IdString())
             continue;
         pd.cell_arcs.clear();
         int clkInfoCount = 0;
         TimingPortClass cls = ctx->getPortTimingClass(ci, name, clkInfoCount);
+        pd.port_class = cls;
         if (cls == TMG_STARTPOINT || cls == TMG_ENDPOINT || cls == TMG_CLOCK_INPUT || cls == TMG_GEN_CLOCK ||
             cls == TMG_IGNORE)
             continue;
-        if (pi.type == PORT_IN) {
+        if (pd.type == PORT_IN) {
             // Input ports might have setup/hold relationships
             if (cls == TMG_REGISTER_INPUT) {
                 for (int i = 0; i < clkInfoCount; i++) {
                     auto info = ctx->getPortClockingInfo(ci, name, i);
-                    if (!ci->ports.count(info.clock_port) || ci->ports.at(info.clock_port).net == nullptr)
-                        continue;
-                    pd.cell_arcs.emplace_back(CellArc::SETUP, info.clock_port, DelayQuad(info.setup, info.setup),
-                                              info.edge);
-                    pd.cell_arcs.emplace_back(CellArc::HOLD, info.clock_port, DelayQuad(info.hold, info.hold),
+                    // registers without a clock are analysed as unclocked endpoints
+                    port_id_t clock_port = -1;
+                    if (ci->ports.count(info.clock_port) && ci->ports.at(info.clock_port).net != nullptr)
+                        clock_port = port_index(CellPortKey(ci->name, info.clock_port));
+                    pd.cell_arcs.emplace_back(CellArc::SETUP, clock_port, DelayQuad(info.setup, info.setup),
                                               info.edge);
+                    pd.cell_arcs.emplace_back(CellArc::HOLD, clock_port, DelayQuad(info.hold, info.hold), info.edge);
                 }
             }
             // Combinational delays through cell
@@ -109,16 +283,19 @@ void TimingAnalyser::get_cell_delays()
                 DelayQuad delay;
                 bool is_path = ctx->getCellDelay(ci, name, other_port.first, delay);
                 if (is_path)
-                    pd.cell_arcs.emplace_back(CellArc::COMBINATIONAL, other_port.first, delay);
+                    pd.cell_arcs.emplace_back(CellArc::COMBINATIONAL,
+                                              port_index(CellPortKey(ci->name, other_port.first)), delay);
             }
-        } else if (pi.type == PORT_OUT) {
+        } else if (pd.type == PORT_OUT) {
             // Output ports might have clk-to-q relationships
             if (cls == TMG_REGISTER_OUTPUT) {
                 for (int i = 0; i < clkInfoCount; i++) {
                     auto info = ctx->getPortClockingInfo(ci, name, i);
-                    if (!ci->ports.count(info.clock_port) || ci->ports.at(info.clock_port).net == nullptr)
-                        continue;
-                    pd.cell_arcs.emplace_back(CellArc::CLK_TO_Q, info.clock_port, info.clockToQ, info.edge);
+                    // and those without a clock as unclocked startpoints
+                    port_id_t clock_port = -1;
+                    if (ci->ports.count(info.clock_port) && ci->ports.at(info.clock_port).net != nullptr)
+                        clock_port = port_index(CellPortKey(ci->name, info.clock_port));
+                    pd.cell_arcs.emplace_back(CellArc::CLK_TO_Q, clock_port, info.clockToQ, info.edge);
                 }
             }
             // Combinational delays through cell
@@ -130,47 +307,63 @@ void TimingAnalyser::get_cell_delays()
                 DelayQuad delay;
                 bool is_path = ctx->getCellDelay(ci, other_port.first, name, delay);
                 if (is_path)
-                    pd.cell_arcs.emplace_back(CellArc::COMBINATIONAL, other_port.first, delay);
+                    pd.cell_arcs.emplace_back(CellArc::COMBINATIONAL,
+                                              port_index(CellPortKey(ci->name, other_port.first)), delay);
             }
         }
     }
+    // Mirror the combinational arcs onto the port they end at
+    for (auto &pd : ports)
+        pd.pull_arcs.clear();
+    for (port_id_t p = 0; p < port_id_t(ports.size()); p++) {
+        for (auto &arc : ports.at(p).cell_arcs) {
+            if (arc.type != CellArc::COMBINATIONAL)
+                continue;
+            ports.at(arc.other_port).pull_arcs.emplace_back(CellArc::COMBINATIONAL, p, arc.value);
+        }
+    }
 }
 
 void TimingAnalyser::get_route_delays()
 {
-    for (auto net : sorted(ctx->nets)) {
-        NetInfo *ni = net.second;
+    // All route delays are refreshed, so any pending incremental updates are superseded
+    for (auto p : dirty_ports)
+        ports.at(p).dirty = false;
+    dirty_ports.clear();
+    for (auto &pd : ports) {
+        if (pd.type != PORT_OUT || pd.net == nullptr)
+            continue;
+        NetInfo *ni = pd.net;
         if (ni->driver.cell == nullptr || ni->driver.cell->bel == BelId())
             continue;
-        for (auto &usr : ni->users) {
+        for (size_t i = 0; i < ni->users.size(); i++) {
+            auto &usr = ni->users.at(i);
             if (usr.cell->bel == BelId())
                 continue;
-            ports.at(CellPortKey(usr)).route_delay = DelayPair(ctx->getNetinfoRouteDelay(ni, usr));
+            ports.at(pd.users.at(i)).route_delay =
+                    use_route_delays ? DelayPair(ctx->getNetinfoRouteDelay(ni, usr)) : DelayPair(0);
         }
     }
 }
 
 void TimingAnalyser::topo_sort()
 {
-    TopoSort<CellPortKey> topo;
-    for (auto &port : ports) {
-        auto &pd = port.second;
+    TopoSort<port_id_t> topo;
+    for (port_id_t p = 0; p < port_id_t(ports.size()); p++) {
+        auto &pd = ports.at(p);
         // All ports are nodes
-        topo.node(port.first);
+        topo.node(p);
         if (pd.type == PORT_IN) {
             // inputs: combinational arcs through the cell are edges
             for (auto &arc : pd.cell_arcs) {
                 if (arc.type != CellArc::COMBINATIONAL)
                     continue;
-                topo.edge(port.first, CellPortKey(port.first.cell, arc.other_port));
+                topo.edge(p, arc.other_port);
             }
         } else if (pd.type == PORT_OUT) {
             // output: routing arcs are edges
-            const NetInfo *pn = port_info(port.first).net;
-            if (pn != nullptr) {
-                for (auto &usr : pn->users)
-                    topo.edge(port.first, CellPortKey(usr));
-            }
+            for (auto usr : pd.users)
+                topo.edge(p, usr);
         }
     }
     bool no_loops = topo.sort();
@@ -179,14 +372,35 @@ void TimingAnalyser::topo_sort()
         int i = 0;
         for (auto &loop : topo.loops) {
             log_info("    loop %d:\n", ++i);
-            for (auto &port : loop) {
-                log_info("        %s.%s (%s)\n", ctx->nameOf(port.cell), ctx->nameOf(port.port),
-                         ctx->nameOf(port_info(port).net));
+            for (auto port : loop) {
+                auto &pd = ports.at(port);
+                log_info("        %s.%s (%s)\n", ctx->nameOf(pd.cell_port.cell), ctx->nameOf(pd.cell_port.port),
+                         ctx->nameOf(pd.net));
             }
         }
     }
     have_loops = !no_loops;
     std::swap(topological_order, topo.sorted);
+    for (int i = 0; i < int(topological_order.size()); i++)
+        ports.at(topological_order.at(i)).topo_index = i;
+    // Group the ports into levels, such that each port only depends on ports in earlier levels
+    topo_levels.clear();
+    if (have_loops)
+        return;
+    for (auto p : topological_order) {
+        auto &pd = ports.at(p);
+        pd.topo_level = 0;
+        if (pd.type == PORT_IN) {
+            if (pd.driver != -1)
+                pd.topo_level = ports.at(pd.driver).topo_level + 1;
+        } else if (pd.type == PORT_OUT) {
+            for (auto &fanin : pd.pull_arcs)
+                pd.topo_level = std::max(pd.topo_level, ports.at(fanin.other_port).topo_level + 1);
+        }
+        if (pd.topo_level >= int(topo_levels.size()))
+            topo_levels.resize(pd.topo_level + 1);
+        topo_levels.at(pd.topo_level).push_back(p);
+    }
 }
 
 void TimingAnalyser::setup_port_domains()
@@ -195,48 +409,67 @@ void TimingAnalyser::setup_port_domains()
         d.startpoints.clear();
         d.endpoints.clear();
     }
+    // In out-of-context mode, top-level inputs look floating but aren't, so their users are unclocked startpoints
+    std::unordered_set<const NetInfo *> ooc_port_nets;
+    if (bool_or_default(ctx->settings, ctx->id("arch.ooc"))) {
+        for (auto &p : ctx->ports) {
+            if (p.second.type != PORT_IN || p.second.net == nullptr)
+                continue;
+            ooc_port_nets.insert(p.second.net);
+        }
+    }
     // Go forward through the topological order (domains from the PoV of arrival time)
     bool first_iter = true;
     do {
         updated_domains = false;
         for (auto port : topological_order) {
             auto &pd = ports.at(port);
-            auto &pi = port_info(port);
-            if (pi.type == PORT_OUT) {
+            if (pd.type == PORT_OUT) {
                 if (first_iter) {
                     for (auto &fanin : pd.cell_arcs) {
                         if (fanin.type != CellArc::CLK_TO_Q)
                             continue;
                         // registered outputs are startpoints
-                        auto dom = domain_id(port.cell, fanin.other_port, fanin.edge);
+                        auto dom = (fanin.other_port == -1) ? domain_id(IdString(), RISING_EDGE)
+                                                            : domain_id(ports.at(fanin.other_port).net, fanin.edge);
                         // create per-domain data
                         pd.arrival[dom];
                         domains.at(dom).startpoints.emplace_back(port, fanin.other_port);
                     }
+                    if (pd.port_class == TMG_STARTPOINT) {
+                        // unclocked startpoints, e.g. inputs from IO
+                        auto dom = domain_id(IdString(), RISING_EDGE);
+                        pd.arrival[dom];
+                        domains.at(dom).startpoints.emplace_back(port, -1);
+                    }
                 }
                 // copy domains across routing
-                if (pi.net != nullptr)
-                    for (auto &usr : pi.net->users)
-                        copy_domains(port, CellPortKey(usr), false);
+                for (auto usr : pd.users)
+                    copy_domains(port, usr, false);
             } else {
+                if (first_iter && pd.driver == -1 && pd.net != nullptr && pd.net->driver.cell == nullptr &&
+                    ooc_port_nets.count(pd.net)) {
+                    auto dom = domain_id(IdString(), RISING_EDGE);
+                    pd.arrival[dom];
+                    domains.at(dom).startpoints.emplace_back(port, -1);
+                }
                 // copy domains from input to output
                 for (auto &fanout : pd.cell_arcs) {
                     if (fanout.type != CellArc::COMBINATIONAL)
                         continue;
-                    copy_domains(port, CellPortKey(port.cell, fanout.other_port), false);
+                    copy_domains(port, fanout.other_port, false);
                 }
             }
         }
         // Go backward through the topological order (domains from the PoV of required time)
         for (auto port : reversed_range(topological_order)) {
             auto &pd = ports.at(port);
-            auto &pi = port_info(port);
-            if (pi.type == PORT_OUT) {
+            if (pd.type == PORT_OUT) {
                 // copy domains from output to input
                 for (auto &fanin : pd.cell_arcs) {
                     if (fanin.type != CellArc::COMBINATIONAL)
                         continue;
-                    copy_domains(port, CellPortKey(port.cell, fanin.other_port), true);
+                    copy_domains(port, fanin.other_port, true);
                 }
             } else {
                 if (first_iter) {
@@ -244,15 +477,21 @@ void TimingAnalyser::setup_port_domains()
                         if (fanout.type != CellArc::SETUP)
                             continue;
                         // registered inputs are endpoints
-                        auto dom = domain_id(port.cell, fanout.other_port, fanout.edge);
+                        auto dom = (fanout.other_port == -1) ? domain_id(IdString(), RISING_EDGE)
+                                                             : domain_id(ports.at(fanout.other_port).net, fanout.edge);
                         // create per-domain data
                         pd.required[dom];
                         domains.at(dom).endpoints.emplace_back(port, fanout.other_port);
                     }
+                    if (pd.port_class == TMG_ENDPOINT) {
+                        auto dom = domain_id(IdString(), RISING_EDGE);
+                        pd.required[dom];
+                        domains.at(dom).endpoints.emplace_back(port, -1);
+                    }
                 }
                 // copy port to driver
-                if (pi.net != nullptr && pi.net->driver.cell != nullptr)
-                    copy_domains(port, CellPortKey(pi.net->driver), true);
+                if (pd.net != nullptr && pd.net->driver.cell != nullptr)
+                    copy_domains(port, port_index(CellPortKey(pd.net->driver)), true);
             }
         }
         // Iterate over ports and find domain paris
@@ -271,32 +510,28 @@ void TimingAnalyser::setup_port_domains()
 
 void TimingAnalyser::reset_times()
 {
-    for (auto &port : ports) {
-        auto do_reset = [&](std::unordered_map<domain_id_t, ArrivReqTime> &times) {
-            for (auto &t : times) {
-                t.second.value = init_delay;
-                t.second.path_length = 0;
-                t.second.bwd_min = CellPortKey();
-                t.second.bwd_max = CellPortKey();
-            }
+    for (auto &pd : ports) {
+        auto do_reset = [&](DomainMap<ArrivReqTime> &times) {
+            for (auto &t : times)
+                t.second = ArrivReqTime{init_delay};
         };
-        do_reset(port.second.arrival);
-        do_reset(port.second.required);
-        for (auto &dp : port.second.domain_pairs) {
+        do_reset(pd.arrival);
+        do_reset(pd.required);
+        for (auto &dp : pd.domain_pairs) {
             dp.second.setup_slack = std::numeric_limits<delay_t>::max();
             dp.second.hold_slack = std::numeric_limits<delay_t>::max();
             dp.second.max_path_length = 0;
             dp.second.criticality = 0;
             dp.second.budget = 0;
         }
-        port.second.worst_crit = 0;
-        port.second.worst_setup_slack = std::numeric_limits<delay_t>::max();
-        port.second.worst_hold_slack = std::numeric_limits<delay_t>::max();
+        pd.worst_crit = 0;
+        pd.worst_setup_slack = std::numeric_limits<delay_t>::max();
+        pd.worst_hold_slack = std::numeric_limits<delay_t>::max();
     }
 }
 
-void TimingAnalyser::set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, int path_length,
-                                      CellPortKey prev)
+void TimingAnalyser::set_arrival_time(port_id_t target, domain_id_t domain, DelayPair arrival, int path_length,
+                                      port_id_t prev)
 {
     auto &arr = ports.at(target).arrival.at(domain);
     if (arrival.max_delay > arr.value.max_delay) {
@@ -310,8 +545,8 @@ void TimingAnalyser::set_arrival_time(CellPortKey target, domain_id_t domain, De
     arr.path_length = std::max(arr.path_length, path_length);
 }
 
-void TimingAnalyser::set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, int path_length,
-                                       CellPortKey prev)
+void TimingAnalyser::set_required_time(port_id_t target, domain_id_t domain, DelayPair required, int path_length,
+                                       port_id_t prev)
 {
     auto &req = ports.at(target).required.at(domain);
     if (required.min_delay < req.value.min_delay) {
@@ -325,28 +560,47 @@ void TimingAnalyser::set_required_time(CellPortKey target, domain_id_t domain, D
     req.path_length = std::max(req.path_length, path_length);
 }
 
+void TimingAnalyser::init_startpoint(domain_id_t dom_id, const std::pair<port_id_t, port_id_t> &sp)
+{
+    auto &pd = ports.at(sp.first);
+    DelayPair init_arrival(0);
+    // TODO: clock routing delay, if analysis of that is enabled
+    // registered startpoints have a clock-to-out time (including registers with no clock, which are unclocked)
+    for (auto &fanin : pd.cell_arcs) {
+        if (fanin.type == CellArc::CLK_TO_Q && fanin.other_port == sp.second) {
+            init_arrival = init_arrival + fanin.value.delayPair();
+            break;
+        }
+    }
+    set_arrival_time(sp.first, dom_id, init_arrival, 1, sp.second);
+}
+
+void TimingAnalyser::init_endpoint(domain_id_t dom_id, const std::pair<port_id_t, port_id_t> &ep)
+{
+    auto &pd = ports.at(ep.first);
+    DelayPair init_setuphold(0);
+    // TODO: clock routing delay, if analysis of that is enabled
+    // Add setup/hold time, if this endpoint is a register
+    for (auto &fanin : pd.cell_arcs) {
+        if (fanin.type == CellArc::SETUP && fanin.other_port == ep.second)
+            init_setuphold.min_delay -= fanin.value.maxDelay();
+        if (fanin.type == CellArc::HOLD && fanin.other_port == ep.second)
+            init_setuphold.max_delay -= fanin.value.maxDelay();
+    }
+    set_required_time(ep.first, dom_id, init_setuphold, 1, ep.second);
+}
+
 void TimingAnalyser::walk_forward()
 {
     // Assign initial arrival time to domain startpoints
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
-        auto &dom = domains.at(dom_id);
-        for (auto &sp : dom.startpoints) {
-            auto &pd = ports.at(sp.first);
-            DelayPair init_arrival(0);
-            CellPortKey clock_key;
-            // TODO: clock routing delay, if analysis of that is enabled
-            if (sp.second != IdString()) {
-                // clocked startpoints have a clock-to-out time
-                for (auto &fanin : pd.cell_arcs) {
-                    if (fanin.type == CellArc::CLK_TO_Q && fanin.other_port == sp.second) {
-                        init_arrival = init_arrival + fanin.value.delayPair();
-                        break;
-                    }
-                }
-                clock_key = CellPortKey(sp.first.cell, sp.second);
-            }
-            set_arrival_time(sp.first, dom_id, init_arrival, 1, clock_key);
-        }
+        for (auto &sp : domains.at(dom_id).startpoints)
+            init_startpoint(dom_id, sp);
+    }
+    if (!have_loops) {
+        // Each port only reads from its fan-in, which is in an earlier level, and writes to itself
+        for_each_level(false, [&](port_id_t p) { pull_arrival(p); });
+        return;
     }
     // Walk forward in topological order
     for (auto p : topological_order) {
@@ -354,21 +608,16 @@ void TimingAnalyser::walk_forward()
         for (auto &arr : pd.arrival) {
             if (pd.type == PORT_OUT) {
                 // Output port: propagate delay through net, adding route delay
-                NetInfo *net = port_info(p).net;
-                if (net != nullptr)
-                    for (auto &usr : net->users) {
-                        CellPortKey usr_key(usr);
-                        auto &usr_pd = ports.at(usr_key);
-                        set_arrival_time(usr_key, arr.first, arr.second.value + usr_pd.route_delay,
-                                         arr.second.path_length, p);
-                    }
+                for (auto usr : pd.users)
+                    set_arrival_time(usr, arr.first, arr.second.value + ports.at(usr).route_delay,
+                                     arr.second.path_length, p);
             } else if (pd.type == PORT_IN) {
                 // Input port; propagate delay through cell, adding combinational delay
                 for (auto &fanout : pd.cell_arcs) {
                     if (fanout.type != CellArc::COMBINATIONAL)
                         continue;
-                    set_arrival_time(CellPortKey(p.cell, fanout.other_port), arr.first,
-                                     arr.second.value + fanout.value.delayPair(), arr.second.path_length + 1, p);
+                    set_arrival_time(fanout.other_port, arr.first, arr.second.value + fanout.value.delayPair(),
+                                     arr.second.path_length + 1, p);
                 }
             }
         }
@@ -381,24 +630,12 @@ void TimingAnalyser::walk_backward()
     // Note that clock frequency will be considered later in the analysis for, for now all required times are normalised
     // to 0ns
     for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
-        auto &dom = domains.at(dom_id);
-        for (auto &ep : dom.endpoints) {
-            auto &pd = ports.at(ep.first);
-            DelayPair init_setuphold(0);
-            CellPortKey clock_key;
-            // TODO: clock routing delay, if analysis of that is enabled
-            if (ep.second != IdString()) {
-                // Add setup/hold time, if this endpoint is clocked
-                for (auto &fanin : pd.cell_arcs) {
-                    if (fanin.type == CellArc::SETUP && fanin.other_port == ep.second)
-                        init_setuphold.min_delay -= fanin.value.maxDelay();
-                    if (fanin.type == CellArc::HOLD && fanin.other_port == ep.second)
-                        init_setuphold.max_delay -= fanin.value.maxDelay();
-                }
-                clock_key = CellPortKey(ep.first.cell, ep.second);
-            }
-            set_required_time(ep.first, dom_id, init_setuphold, 1, clock_key);
-        }
+        for (auto &ep : domains.at(dom_id).endpoints)
+            init_endpoint(dom_id, ep);
+    }
+    if (!have_loops) {
+        for_each_level(true, [&](port_id_t p) { pull_required(p); });
+        return;
     }
     // Walk backwards in topological order
     for (auto p : reversed_range(topological_order)) {
@@ -406,19 +643,101 @@ void TimingAnalyser::walk_backward()
         for (auto &req : pd.required) {
             if (pd.type == PORT_IN) {
                 // Input port: propagate delay back through net, subtracting route delay
-                NetInfo *net = port_info(p).net;
-                if (net != nullptr && net->driver.cell != nullptr)
-                    set_required_time(CellPortKey(net->driver), req.first, req.second.value - pd.route_delay,
-                                      req.second.path_length, p);
+                if (pd.net != nullptr && pd.net->driver.cell != nullptr)
+                    set_required_time(port_index(CellPortKey(pd.net->driver)), req.first,
+                                      req.second.value - pd.route_delay, req.second.path_length, p);
             } else if (pd.type == PORT_OUT) {
                 // Output port : propagate delay back through cell, subtracting combinational delay
                 for (auto &fanin : pd.cell_arcs) {
                     if (fanin.type != CellArc::COMBINATIONAL)
                         continue;
-                    set_required_time(CellPortKey(p.cell, fanin.other_port), req.first,
-                                      req.second.value - fanin.value.delayPair(), req.second.path_length + 1, p);
+                    set_required_time(fanin.other_port, req.first, req.second.value - fanin.value.delayPair(),
+                                      req.second.path_length + 1, p);
+                }
+            }
+        }
+    }
+}
+
+void TimingAnalyser::for_each_level(bool backwards, const std::function<void(port_id_t)> &func)
+{
+    int n_levels = int(topo_levels.size());
+    auto get_level = [&](int i) -> const std::vector<port_id_t> & {
+        return topo_levels.at(backwards ? (n_levels - 1 - i) : i);
+    };
+#ifndef NPNR_DISABLE_THREADS
+    // Not worth the thread startup and synchronisation overhead for small designs
+    if (threads > 1 && topological_order.size() >= 8192) {
+        const size_t chunk_size = 64;
+        std::vector<std::atomic<size_t>> next_chunk(n_levels);
+        for (auto &n : next_chunk)
+            n.store(0);
+        boost::barrier level_done(threads);
+        auto worker = [&]() {
+            for (int i = 0; i < n_levels; i++) {
+                auto &level = get_level(i);
+                while (true) {
+                    size_t start = next_chunk.at(i).fetch_add(chunk_size);
+                    if (start >= level.size())
+                        break;
+                    size_t end = std::min(level.size(), start + chunk_size);
+                    for (size_t j = start; j < end; j++)
+                        func(level.at(j));
                 }
+                level_done.wait();
             }
+        };
+        std::vector<boost::thread> workers;
+        for (int i = 1; i < threads; i++)
+            workers.emplace_back(worker);
+        worker();
+        for (auto &w : workers)
+            w.join();
+        return;
+    }
+#endif
+    for (int i = 0; i < n_levels; i++)
+        for (auto p : get_level(i))
+            func(p);
+}
+
+void TimingAnalyser::pull_arrival(port_id_t p)
+{
+    auto &pd = ports.at(p);
+    if (pd.type == PORT_IN) {
+        // Input port: arrival time of the driver, plus route delay
+        if (pd.driver == -1)
+            return;
+        for (auto &arr : ports.at(pd.driver).arrival)
+            set_arrival_time(p, arr.first, arr.second.value + pd.route_delay, arr.second.path_length, pd.driver);
+    } else if (pd.type == PORT_OUT) {
+        // Output port: arrival times of the inputs, plus combinational delay
+        for (auto &fanin : pd.pull_arcs) {
+            for (auto &arr : ports.at(fanin.other_port).arrival)
+                set_arrival_time(p, arr.first, arr.second.value + fanin.value.delayPair(), arr.second.path_length + 1,
+                                 fanin.other_port);
+        }
+    }
+}
+
+void TimingAnalyser::pull_required(port_id_t p)
+{
+    auto &pd = ports.at(p);
+    if (pd.type == PORT_OUT) {
+        // Output port: required times of the net users, minus route delay
+        for (auto usr : pd.users) {
+            auto &usr_pd = ports.at(usr);
+            if (usr_pd.type != PORT_IN)
+                continue;
+            for (auto &req : usr_pd.required)
+                set_required_time(p, req.first, req.second.value - usr_pd.route_delay, req.second.path_length, usr);
+        }
+    } else if (pd.type == PORT_IN) {
+        // Input port: required times of the outputs, minus combinational delay
+        for (auto &fanout : pd.pull_arcs) {
+            for (auto &req : ports.at(fanout.other_port).required)
+                set_required_time(p, req.first, req.second.value - fanout.value.delayPair(),
+                                  req.second.path_length + 1, fanout.other_port);
         }
     }
 }
@@ -450,80 +769,91 @@ void TimingAnalyser::compute_slack()
         dp.worst_hold_slack = std::numeric_limits<delay_t>::max();
     }
     for (auto p : topological_order) {
+        compute_port_slack(p);
         auto &pd = ports.at(p);
         for (auto &pdp : pd.domain_pairs) {
             auto &dp = domain_pairs.at(pdp.first);
-            auto &arr = pd.arrival.at(dp.key.launch);
-            auto &req = pd.required.at(dp.key.capture);
-            pdp.second.setup_slack = dp.period.minDelay() - (arr.value.maxDelay() - req.value.minDelay());
-            if (!setup_only)
-                pdp.second.hold_slack = arr.value.minDelay() - req.value.maxDelay();
-            pdp.second.max_path_length = arr.path_length + req.path_length;
-            pd.worst_setup_slack = std::min(pd.worst_setup_slack, pdp.second.setup_slack);
             dp.worst_setup_slack = std::min(dp.worst_setup_slack, pdp.second.setup_slack);
-            if (!setup_only) {
-                pd.worst_hold_slack = std::min(pd.worst_hold_slack, pdp.second.hold_slack);
+            if (!setup_only)
                 dp.worst_hold_slack = std::min(dp.worst_hold_slack, pdp.second.hold_slack);
-            }
         }
     }
 }
 
+void TimingAnalyser::compute_port_slack(port_id_t p)
+{
+    auto &pd = ports.at(p);
+    pd.worst_setup_slack = std::numeric_limits<delay_t>::max();
+    pd.worst_hold_slack = std::numeric_limits<delay_t>::max();
+    for (auto &pdp : pd.domain_pairs) {
+        auto &dp = domain_pairs.at(pdp.first);
+        auto &arr = pd.arrival.at(dp.key.launch);
+        auto &req = pd.required.at(dp.key.capture);
+        pdp.second.setup_slack = dp.period.minDelay() - (arr.value.maxDelay() - req.value.minDelay());
+        if (!setup_only)
+            pdp.second.hold_slack = arr.value.minDelay() - req.value.maxDelay();
+        pdp.second.max_path_length = arr.path_length + req.path_length;
+        pd.worst_setup_slack = std::min(pd.worst_setup_slack, pdp.second.setup_slack);
+        if (!setup_only)
+            pd.worst_hold_slack = std::min(pd.worst_hold_slack, pdp.second.hold_slack);
+    }
+}
+
 void TimingAnalyser::compute_criticality()
 {
-    for (auto p : topological_order) {
-        auto &pd = ports.at(p);
-        for (auto &pdp : pd.domain_pairs) {
-            auto &dp = domain_pairs.at(pdp.first);
-            float crit =
-                    1.0f - (float(pdp.second.setup_slack) - float(dp.worst_setup_slack)) / float(-dp.worst_setup_slack);
-            crit = std::min(crit, 1.0f);
-            crit = std::max(crit, 0.0f);
-            pdp.second.criticality = crit;
-            pd.worst_crit = std::max(pd.worst_crit, crit);
-        }
+    for (auto p : topological_order)
+        compute_port_criticality(p);
+}
+
+void TimingAnalyser::compute_port_criticality(port_id_t p)
+{
+    auto &pd = ports.at(p);
+    pd.worst_crit = 0;
+    for (auto &pdp : pd.domain_pairs) {
+        auto &dp = domain_pairs.at(pdp.first);
+        float crit =
+                1.0f - (float(pdp.second.setup_slack) - float(dp.worst_setup_slack)) / float(-dp.worst_setup_slack);
+        crit = std::min(crit, 1.0f);
+        crit = std::max(crit, 0.0f);
+        pdp.second.criticality = crit;
+        pd.worst_crit = std::max(pd.worst_crit, crit);
     }
 }
 
-std::vector<CellPortKey> TimingAnalyser::get_failing_eps(domain_id_t domain_pair, int count)
+std::vector<TimingAnalyser::port_id_t> TimingAnalyser::get_failing_eps(domain_id_t domain_pair, int count)
 {
-    std::vector<CellPortKey> failing_eps;
-    delay_t last_slack = std::numeric_limits<delay_t>::min();
+    // Sort by slack, and then port index so that ties come out in a deterministic order
+    std::vector<std::pair<delay_t, port_id_t>> ep_slacks;
     auto &dp = domain_pairs.at(domain_pair);
     auto &cap_d = domains.at(dp.key.capture);
-    while (int(failing_eps.size()) < count) {
-        CellPortKey next;
-        delay_t next_slack = std::numeric_limits<delay_t>::max();
-        for (auto ep : cap_d.endpoints) {
-            auto &pd = ports.at(ep.first);
-            if (!pd.domain_pairs.count(domain_pair))
-                continue;
-            delay_t ep_slack = pd.domain_pairs.at(domain_pair).setup_slack;
-            if (ep_slack < next_slack && ep_slack > last_slack) {
-                next = ep.first;
-                next_slack = ep_slack;
-            }
-        }
-        if (next == CellPortKey())
-            break;
-        failing_eps.push_back(next);
-        last_slack = next_slack;
+    for (auto ep : cap_d.endpoints) {
+        auto &pd = ports.at(ep.first);
+        if (!pd.domain_pairs.count(domain_pair))
+            continue;
+        ep_slacks.emplace_back(pd.domain_pairs.at(domain_pair).setup_slack, ep.first);
     }
+    size_t n = std::min(ep_slacks.size(), size_t(std::max(count, 0)));
+    std::partial_sort(ep_slacks.begin(), ep_slacks.begin() + n, ep_slacks.end());
+    std::vector<port_id_t> failing_eps;
+    for (size_t i = 0; i < n; i++)
+        failing_eps.push_back(ep_slacks.at(i).second);
     return failing_eps;
 }
 
-void TimingAnalyser::print_critical_path(CellPortKey endpoint, domain_id_t domain_pair)
+void TimingAnalyser::print_critical_path(port_id_t endpoint, domain_id_t domain_pair)
 {
-    CellPortKey cursor = endpoint;
+    port_id_t cursor = endpoint;
     auto &dp = domain_pairs.at(domain_pair);
-    log("    endpoint %s.%s (slack %.02fns):\n", ctx->nameOf(cursor.cell), ctx->nameOf(cursor.port),
+    log("    endpoint %s.%s (slack %.02fns):\n", ctx->nameOf(ports.at(cursor).cell_port.cell),
+        ctx->nameOf(ports.at(cursor).cell_port.port),
         ctx->getDelayNS(ports.at(cursor).domain_pairs.at(domain_pair).setup_slack));
-    while (cursor != CellPortKey()) {
-        log("        %s.%s (net %s)\n", ctx->nameOf(cursor.cell), ctx->nameOf(cursor.port),
-            ctx->nameOf(get_net_or_empty(ctx->cells.at(cursor.cell).get(), cursor.port)));
-        if (!ports.at(cursor).arrival.count(dp.key.launch))
+    while (cursor != -1) {
+        auto &pd = ports.at(cursor);
+        log("        %s.%s (net %s)\n", ctx->nameOf(pd.cell_port.cell), ctx->nameOf(pd.cell_port.port),
+            ctx->nameOf(pd.net));
+        if (!pd.arrival.count(dp.key.launch))
             break;
-        cursor = ports.at(cursor).arrival.at(dp.key.launch).bwd_max;
+        cursor = pd.arrival.at(dp.key.launch).bwd_max;
     }
 }
 
@@ -546,14 +876,14 @@ void TimingAnalyser::print_report()
     }
 }
 
-domain_id_t TimingAnalyser::domain_id(IdString cell, IdString clock_port, ClockEdge edge)
-{
-    return domain_id(ctx->cells.at(cell)->ports.at(clock_port).net, edge);
-}
 domain_id_t TimingAnalyser::domain_id(const NetInfo *net, ClockEdge edge)
 {
     NPNR_ASSERT(net != nullptr);
-    ClockDomainKey key{net->name, edge};
+    return domain_id(net->name, edge);
+}
+domain_id_t TimingAnalyser::domain_id(IdString clock, ClockEdge edge)
+{
+    ClockDomainKey key{clock, edge};
     auto inserted = domain_to_id.emplace(key, domains.size());
     if (inserted.second) {
         domains.emplace_back(key);
@@ -566,11 +896,34 @@ domain_id_t TimingAnalyser::domain_pair_id(domain_id_t launch, domain_id_t captu
     auto inserted = pair_to_id.emplace(key, domain_pairs.size());
     if (inserted.second) {
         domain_pairs.emplace_back(key);
+        domain_pairs.back().period = DelayPair(domain_pair_period(launch, capture));
     }
     return inserted.first->second;
 }
 
-void TimingAnalyser::copy_domains(const CellPortKey &from, const CellPortKey &to, bool backward)
+delay_t TimingAnalyser::domain_pair_period(domain_id_t launch, domain_id_t capture)
+{
+    auto &launch_key = domains.at(launch).key, &capture_key = domains.at(capture).key;
+    bool same_edge = (launch_key.edge == capture_key.edge);
+    // Unconstrained clocks, and unclocked paths, use the default target frequency
+    delay_t period = ctx->getDelayFromNS(1.0e9 / ctx->setting<float>("target_freq"));
+    if (!same_edge)
+        period /= 2;
+    if (capture_key.clock != IdString()) {
+        const auto &clkconstr = ctx->nets.at(capture_key.clock)->clkconstr;
+        if (clkconstr) {
+            if (same_edge)
+                period = clkconstr->period.minDelay();
+            else if (capture_key.edge == RISING_EDGE)
+                period = clkconstr->low.minDelay(); // falling -> rising
+            else
+                period = clkconstr->high.minDelay(); // rising -> falling
+        }
+    }
+    return period;
+}
+
+void TimingAnalyser::copy_domains(port_id_t from, port_id_t to, bool backward)
 {
     auto &f = ports.at(from), &t = ports.at(to);
     for (auto &dom : (backward ? f.required : f.arrival)) {
@@ -578,541 +931,191 @@ void TimingAnalyser::copy_domains(const CellPortKey &from, const CellPortKey &to
     }
 }
 
-CellInfo *TimingAnalyser::cell_info(const CellPortKey &key) { return ctx->cells.at(key.cell).get(); }
-
-PortInfo &TimingAnalyser::port_info(const CellPortKey &key) { return ctx->cells.at(key.cell)->ports.at(key.port); }
-
-/** LEGACY CODE BEGIN **/
-
-namespace {
-struct ClockEvent
-{
-    IdString clock;
-    ClockEdge edge;
-
-    bool operator==(const ClockEvent &other) const { return clock == other.clock && edge == other.edge; }
-};
-
-struct ClockPair
-{
-    ClockEvent start, end;
-
-    bool operator==(const ClockPair &other) const { return start == other.start && end == other.end; }
-};
-} // namespace
-
-NEXTPNR_NAMESPACE_END
-namespace std {
-
-template <> struct hash<NEXTPNR_NAMESPACE_PREFIX ClockEvent>
+std::vector<const PortRef *> TimingAnalyser::get_crit_path_sinks(port_id_t endpoint, domain_id_t launch)
 {
-    std::size_t operator()(const NEXTPNR_NAMESPACE_PREFIX ClockEvent &obj) const noexcept
-    {
-        std::size_t seed = 0;
-        boost::hash_combine(seed, hash<NEXTPNR_NAMESPACE_PREFIX IdString>()(obj.clock));
-        boost::hash_combine(seed, hash<int>()(int(obj.edge)));
-        return seed;
+    std::vector<const PortRef *> sinks;
+    port_id_t cursor = endpoint;
+    while (cursor != -1) {
+        auto &pd = ports.at(cursor);
+        if (!pd.arrival.count(launch))
+            break;
+        port_id_t prev = pd.arrival.at(launch).bwd_max;
+        if (pd.type == PORT_IN) {
+            // Out-of-context top-level inputs have no driver to report, so the path starts at their user
+            if (pd.net == nullptr || pd.net_port.is_driver() || pd.net->driver.cell == nullptr)
+                break;
+            sinks.push_back(&pd.net->users.at(pd.net_port.user_idx()));
+        } else if (prev != -1) {
+            // Stop at clocked startpoints, where the path comes from the clock input rather than a combinational arc
+            bool is_clock = std::any_of(pd.cell_arcs.begin(), pd.cell_arcs.end(), [&](const CellArc &arc) {
+                return arc.type == CellArc::CLK_TO_Q && arc.other_port == prev;
+            });
+            if (is_clock)
+                break;
+        }
+        cursor = prev;
     }
-};
+    std::reverse(sinks.begin(), sinks.end());
+    return sinks;
+}
 
-template <> struct hash<NEXTPNR_NAMESPACE_PREFIX ClockPair>
+delay_t TimingAnalyser::assign_budgets()
 {
-    std::size_t operator()(const NEXTPNR_NAMESPACE_PREFIX ClockPair &obj) const noexcept
-    {
-        std::size_t seed = 0;
-        boost::hash_combine(seed, hash<NEXTPNR_NAMESPACE_PREFIX ClockEvent>()(obj.start));
-        boost::hash_combine(seed, hash<NEXTPNR_NAMESPACE_PREFIX ClockEvent>()(obj.start));
-        return seed;
+    // Clear delays to a very high value first
+    for (auto &net : ctx->nets) {
+        for (auto &usr : net.second->users) {
+            usr.budget = std::numeric_limits<delay_t>::max();
+        }
     }
-};
-
-} // namespace std
-NEXTPNR_NAMESPACE_BEGIN
-
-typedef std::vector<const PortRef *> PortRefVector;
-typedef std::map<int, unsigned> DelayFrequency;
-
-struct CriticalPath
-{
-    PortRefVector ports;
-    delay_t path_delay;
-    delay_t path_period;
-};
-
-typedef std::unordered_map<ClockPair, CriticalPath> CriticalPathMap;
+    for (auto &pd : ports) {
+        if (pd.type != PORT_IN || pd.net == nullptr || pd.net_port.net == IdString() || pd.net_port.is_driver())
+            continue;
+        PortRef &usr = pd.net->users.at(pd.net_port.user_idx());
+        delay_t net_delay = pd.route_delay.maxDelay();
+        bool budget_override = ctx->getBudgetOverride(pd.net, usr, net_delay);
+        for (auto &pdp : pd.domain_pairs) {
+            // Overridden arcs don't get a share of the slack. Both the start and endpoint contribute one to the path
+            // length, so the number of arcs on the path is one less than it
+            int num_arcs = std::max(1, pdp.second.max_path_length - 1);
+            pdp.second.budget = budget_override ? net_delay : net_delay + pdp.second.setup_slack / num_arcs;
+            usr.budget = std::min(usr.budget, pdp.second.budget);
+        }
+    }
+    delay_t min_slack = ctx->getDelayFromNS(1.0e9 / ctx->setting<float>("target_freq"));
+    for (auto &dp : domain_pairs)
+        min_slack = std::min(min_slack, dp.worst_setup_slack);
+    return min_slack;
+}
 
-struct Timing
+namespace {
+void print_net_source(Context *ctx, NetInfo *net)
 {
-    Context *ctx;
-    bool net_delays;
-    bool update;
-    delay_t min_slack;
-    CriticalPathMap *crit_path;
-    DelayFrequency *slack_histogram;
-    IdString async_clock;
-
-    struct TimingData
-    {
-        TimingData() : max_arrival(), max_path_length(), min_remaining_budget() {}
-        TimingData(delay_t max_arrival) : max_arrival(max_arrival), max_path_length(), min_remaining_budget() {}
-        delay_t max_arrival;
-        unsigned max_path_length = 0;
-        delay_t min_remaining_budget;
-        bool false_startpoint = false;
-        std::vector<delay_t> min_required;
-        std::unordered_map<ClockEvent, delay_t> arrival_time;
-    };
-
-    Timing(Context *ctx, bool net_delays, bool update, CriticalPathMap *crit_path = nullptr,
-           DelayFrequency *slack_histogram = nullptr)
-            : ctx(ctx), net_delays(net_delays), update(update), min_slack(1.0e12 / ctx->setting<float>("target_freq")),
-              crit_path(crit_path), slack_histogram(slack_histogram), async_clock(ctx->id("$async$"))
-    {
+    // Check if this net is annotated with a source list
+    auto sources = net->attrs.find(ctx->id("src"));
+    if (sources == net->attrs.end()) {
+        // No sources for this net, can't print anything
+        return;
     }
 
-    delay_t walk_paths()
-    {
-        const auto clk_period = ctx->getDelayFromNS(1.0e9 / ctx->setting<float>("target_freq"));
-
-        // First, compute the topological order of nets to walk through the circuit, assuming it is a _acyclic_ graph
-        // TODO(eddieh): Handle the case where it is cyclic, e.g. combinatorial loops
-        std::vector<NetInfo *> topological_order;
-        std::unordered_map<const NetInfo *, std::unordered_map<ClockEvent, TimingData>> net_data;
-        // In lieu of deleting edges from the graph, simply count the number of fanins to each output port
-        std::unordered_map<const PortInfo *, unsigned> port_fanin;
-
-        std::vector<IdString> input_ports;
-        std::vector<const PortInfo *> output_ports;
-
-        std::unordered_set<IdString> ooc_port_nets;
-
-        // In out-of-context mode, top-level inputs look floating but aren't
-        if (bool_or_default(ctx->settings, ctx->id("arch.ooc"))) {
-            for (auto &p : ctx->ports) {
-                if (p.second.type != PORT_IN || p.second.net == nullptr)
-                    continue;
-                ooc_port_nets.insert(p.second.net->name);
-            }
-        }
-
-        for (auto &cell : ctx->cells) {
-            input_ports.clear();
-            output_ports.clear();
-            for (auto &port : cell.second->ports) {
-                if (!port.second.net)
-                    continue;
-                if (port.second.type == PORT_OUT)
-                    output_ports.push_back(&port.second);
-                else
-                    input_ports.push_back(port.first);
-            }
-
-            for (auto o : output_ports) {
-                int clocks = 0;
-                TimingPortClass portClass = ctx->getPortTimingClass(cell.second.get(), o->name, clocks);
-                // If output port is influenced by a clock (e.g. FF output) then add it to the ordering as a timing
-                // start-point
-                if (portClass == TMG_REGISTER_OUTPUT) {
-                    topological_order.emplace_back(o->net);
-                    for (int i = 0; i < clocks; i++) {
-                        TimingClockingInfo clkInfo = ctx->getPortClockingInfo(cell.second.get(), o->name, i);
-                        const NetInfo *clknet = get_net_or_empty(cell.second.get(), clkInfo.clock_port);
-                        IdString clksig = clknet ? clknet->name : async_clock;
-                        net_data[o->net][ClockEvent{clksig, clknet ? clkInfo.edge : RISING_EDGE}] =
-                                TimingData{clkInfo.clockToQ.maxDelay()};
-                    }
-
-                } else {
-                    if (portClass == TMG_STARTPOINT || portClass == TMG_GEN_CLOCK || portClass == TMG_IGNORE) {
-                        topological_order.emplace_back(o->net);
-                        TimingData td;
-                        td.false_startpoint = (portClass == TMG_GEN_CLOCK || portClass == TMG_IGNORE);
-                        td.max_arrival = 0;
-                        net_data[o->net][ClockEvent{async_clock, RISING_EDGE}] = td;
-                    }
-
-                    // Don't analyse paths from a clock input to other pins - they will be considered by the
-                    // special-case handling register input/output class ports
-                    if (portClass == TMG_CLOCK_INPUT)
-                        continue;
-
-                    // Otherwise, for all driven input ports on this cell, if a timing arc exists between the input and
-                    // the current output port, increment fanin counter
-                    for (auto i : input_ports) {
-                        DelayQuad comb_delay;
-                        NetInfo *i_net = cell.second->ports[i].net;
-                        if (i_net->driver.cell == nullptr && !ooc_port_nets.count(i_net->name))
-                            continue;
-                        bool is_path = ctx->getCellDelay(cell.second.get(), i, o->name, comb_delay);
-                        if (is_path)
-                            port_fanin[o]++;
-                    }
-                    // If there is no fanin, add the port as a false startpoint
-                    if (!port_fanin.count(o) && !net_data.count(o->net)) {
-                        topological_order.emplace_back(o->net);
-                        TimingData td;
-                        td.false_startpoint = true;
-                        td.max_arrival = 0;
-                        net_data[o->net][ClockEvent{async_clock, RISING_EDGE}] = td;
-                    }
-                }
-            }
-        }
-
-        // In out-of-context mode, handle top-level ports correctly
-        if (bool_or_default(ctx->settings, ctx->id("arch.ooc"))) {
-            for (auto &p : ctx->ports) {
-                if (p.second.type != PORT_IN || p.second.net == nullptr)
-                    continue;
-                topological_order.emplace_back(p.second.net);
-            }
-        }
-
-        std::deque<NetInfo *> queue(topological_order.begin(), topological_order.end());
-        // Now walk the design, from the start points identified previously, building up a topological order
-        while (!queue.empty()) {
-            const auto net = queue.front();
-            queue.pop_front();
-
-            for (auto &usr : net->users) {
-                int user_clocks;
-                TimingPortClass usrClass = ctx->getPortTimingClass(usr.cell, usr.port, user_clocks);
-                if (usrClass == TMG_IGNORE || usrClass == TMG_CLOCK_INPUT)
-                    continue;
-                for (auto &port : usr.cell->ports) {
-                    if (port.second.type != PORT_OUT || !port.second.net)
-                        continue;
-                    int port_clocks;
-                    TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, port.first, port_clocks);
-
-                    // Skip if this is a clocked output (but allow non-clocked ones)
-                    if (portClass == TMG_REGISTER_OUTPUT || portClass == TMG_STARTPOINT || portClass == TMG_IGNORE ||
-                        portClass == TMG_GEN_CLOCK)
-                        continue;
-                    DelayQuad comb_delay;
-                    bool is_path = ctx->getCellDelay(usr.cell, usr.port, port.first, comb_delay);
-                    if (!is_path)
-                        continue;
-                    // Decrement the fanin count, and only add to topological order if all its fanins have already
-                    // been visited
-                    auto it = port_fanin.find(&port.second);
-                    if (it == port_fanin.end())
-                        log_error("Timing counted negative fanin count for port %s.%s (net %s), please report this "
-                                  "error.\n",
-                                  ctx->nameOf(usr.cell), ctx->nameOf(port.first), ctx->nameOf(port.second.net));
-                    if (--it->second == 0) {
-                        topological_order.emplace_back(port.second.net);
-                        queue.emplace_back(port.second.net);
-                        port_fanin.erase(it);
-                    }
-                }
-            }
-        }
-
-        // Sanity check to ensure that all ports where fanins were recorded were indeed visited
-        if (!port_fanin.empty() && !bool_or_default(ctx->settings, ctx->id("timing/ignoreLoops"), false)) {
-            for (auto fanin : port_fanin) {
-                NetInfo *net = fanin.first->net;
-                if (net != nullptr) {
-                    log_info("   remaining fanin includes %s (net %s)\n", fanin.first->name.c_str(ctx),
-                             net->name.c_str(ctx));
-                    if (net->driver.cell != nullptr)
-                        log_info("        driver = %s.%s\n", net->driver.cell->name.c_str(ctx),
-                                 net->driver.port.c_str(ctx));
-                    for (auto net_user : net->users)
-                        log_info("        user: %s.%s\n", net_user.cell->name.c_str(ctx), net_user.port.c_str(ctx));
-                } else {
-                    log_info("   remaining fanin includes %s (no net)\n", fanin.first->name.c_str(ctx));
-                }
-            }
-            if (ctx->force)
-                log_warning("timing analysis failed due to presence of combinatorial loops, incomplete specification "
-                            "of timing ports, etc.\n");
-            else
-                log_error("timing analysis failed due to presence of combinatorial loops, incomplete specification of "
-                          "timing ports, etc.\n");
-        }
-
-        // Go forwards topologically to find the maximum arrival time and max path length for each net
-        for (auto net : topological_order) {
-            if (!net_data.count(net))
-                continue;
-            auto &nd_map = net_data.at(net);
-            for (auto &startdomain : nd_map) {
-                ClockEvent start_clk = startdomain.first;
-                auto &nd = startdomain.second;
-                if (nd.false_startpoint)
-                    continue;
-                const auto net_arrival = nd.max_arrival;
-                const auto net_length_plus_one = nd.max_path_length + 1;
-                nd.min_remaining_budget = clk_period;
-                for (auto &usr : net->users) {
-                    int port_clocks;
-                    TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, usr.port, port_clocks);
-                    auto net_delay = net_delays ? ctx->getNetinfoRouteDelay(net, usr) : delay_t();
-                    auto usr_arrival = net_arrival + net_delay;
-
-                    if (portClass == TMG_ENDPOINT || portClass == TMG_IGNORE || portClass == TMG_CLOCK_INPUT) {
-                        // Skip
-                    } else {
-                        auto budget_override = ctx->getBudgetOverride(net, usr, net_delay);
-                        // Iterate over all output ports on the same cell as the sink
-                        for (auto port : usr.cell->ports) {
-                            if (port.second.type != PORT_OUT || !port.second.net)
-                                continue;
-                            DelayQuad comb_delay;
-                            // Look up delay through this path
-                            bool is_path = ctx->getCellDelay(usr.cell, usr.port, port.first, comb_delay);
-                            if (!is_path)
-                                continue;
-                            auto &data = net_data[port.second.net][start_clk];
-                            auto &arrival = data.max_arrival;
-                            arrival = std::max(arrival, usr_arrival + comb_delay.maxDelay());
-                            if (!budget_override) { // Do not increment path length if budget overridden since it
-                                                    // doesn't
-                                // require a share of the slack
-                                auto &path_length = data.max_path_length;
-                                path_length = std::max(path_length, net_length_plus_one);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        std::unordered_map<ClockPair, std::pair<delay_t, NetInfo *>> crit_nets;
-
-        // Now go backwards topologically to determine the minimum path slack, and to distribute all path slack evenly
-        // between all nets on the path
-        for (auto net : boost::adaptors::reverse(topological_order)) {
-            if (!net_data.count(net))
-                continue;
-            auto &nd_map = net_data.at(net);
-            for (auto &startdomain : nd_map) {
-                auto &nd = startdomain.second;
-                // Ignore false startpoints
-                if (nd.false_startpoint)
-                    continue;
-                const delay_t net_length_plus_one = nd.max_path_length + 1;
-                auto &net_min_remaining_budget = nd.min_remaining_budget;
-                for (auto &usr : net->users) {
-                    auto net_delay = net_delays ? ctx->getNetinfoRouteDelay(net, usr) : delay_t();
-                    auto budget_override = ctx->getBudgetOverride(net, usr, net_delay);
-                    int port_clocks;
-                    TimingPortClass portClass = ctx->getPortTimingClass(usr.cell, usr.port, port_clocks);
-                    if (portClass == TMG_REGISTER_INPUT || portClass == TMG_ENDPOINT) {
-                        auto process_endpoint = [&](IdString clksig, ClockEdge edge, delay_t setup) {
-                            const auto net_arrival = nd.max_arrival;
-                            const auto endpoint_arrival = net_arrival + net_delay + setup;
-                            delay_t period;
-                            // Set default period
-                            if (edge == startdomain.first.edge) {
-                                period = clk_period;
-                            } else {
-                                period = clk_period / 2;
-                            }
-                            if (clksig != async_clock) {
-                                if (ctx->nets.at(clksig)->clkconstr) {
-                                    if (edge == startdomain.first.edge) {
-                                        // same edge
-                                        period = ctx->nets.at(clksig)->clkconstr->period.minDelay();
-                                    } else if (edge == RISING_EDGE) {
-                                        // falling -> rising
-                                        period = ctx->nets.at(clksig)->clkconstr->low.minDelay();
-                                    } else if (edge == FALLING_EDGE) {
-                                        // rising -> falling
-                                        period = ctx->nets.at(clksig)->clkconstr->high.minDelay();
-                                    }
-                                }
-                            }
-                            auto path_budget = period - endpoint_arrival;
-
-                            if (update) {
-                                auto budget_share = budget_override ? 0 : path_budget / net_length_plus_one;
-                                usr.budget = std::min(usr.budget, net_delay + budget_share);
-                                net_min_remaining_budget =
-                                        std::min(net_min_remaining_budget, path_budget - budget_share);
-                            }
-
-                            if (path_budget < min_slack)
-                                min_slack = path_budget;
-
-                            if (slack_histogram) {
-                                int slack_ps = ctx->getDelayNS(path_budget) * 1000;
-                                (*slack_histogram)[slack_ps]++;
-                            }
-                            ClockEvent dest_ev{clksig, edge};
-                            ClockPair clockPair{startdomain.first, dest_ev};
-                            nd.arrival_time[dest_ev] = std::max(nd.arrival_time[dest_ev], endpoint_arrival);
-
-                            if (crit_path) {
-                                if (!crit_nets.count(clockPair) || crit_nets.at(clockPair).first < endpoint_arrival) {
-                                    crit_nets[clockPair] = std::make_pair(endpoint_arrival, net);
-                                    (*crit_path)[clockPair].path_delay = endpoint_arrival;
-                                    (*crit_path)[clockPair].path_period = period;
-                                    (*crit_path)[clockPair].ports.clear();
-                                    (*crit_path)[clockPair].ports.push_back(&usr);
-                                }
-                            }
-                        };
-                        if (portClass == TMG_REGISTER_INPUT) {
-                            for (int i = 0; i < port_clocks; i++) {
-                                TimingClockingInfo clkInfo = ctx->getPortClockingInfo(usr.cell, usr.port, i);
-                                const NetInfo *clknet = get_net_or_empty(usr.cell, clkInfo.clock_port);
-                                IdString clksig = clknet ? clknet->name : async_clock;
-                                process_endpoint(clksig, clknet ? clkInfo.edge : RISING_EDGE, clkInfo.setup.maxDelay());
-                            }
-                        } else {
-                            process_endpoint(async_clock, RISING_EDGE, 0);
-                        }
-
-                    } else if (update) {
-
-                        // Iterate over all output ports on the same cell as the sink
-                        for (const auto &port : usr.cell->ports) {
-                            if (port.second.type != PORT_OUT || !port.second.net)
-                                continue;
-                            DelayQuad comb_delay;
-                            bool is_path = ctx->getCellDelay(usr.cell, usr.port, port.first, comb_delay);
-                            if (!is_path)
-                                continue;
-                            if (net_data.count(port.second.net) &&
-                                net_data.at(port.second.net).count(startdomain.first)) {
-                                auto path_budget =
-                                        net_data.at(port.second.net).at(startdomain.first).min_remaining_budget;
-                                auto budget_share = budget_override ? 0 : path_budget / net_length_plus_one;
-                                usr.budget = std::min(usr.budget, net_delay + budget_share);
-                                net_min_remaining_budget =
-                                        std::min(net_min_remaining_budget, path_budget - budget_share);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        if (crit_path) {
-            // Walk backwards from the most critical net
-            for (auto crit_pair : crit_nets) {
-                NetInfo *crit_net = crit_pair.second.second;
-                auto &cp_ports = (*crit_path)[crit_pair.first].ports;
-                while (crit_net) {
-                    const PortInfo *crit_ipin = nullptr;
-                    delay_t max_arrival = std::numeric_limits<delay_t>::min();
-                    // Look at all input ports on its driving cell
-                    for (const auto &port : crit_net->driver.cell->ports) {
-                        if (port.second.type != PORT_IN || !port.second.net)
-                            continue;
-                        DelayQuad comb_delay;
-                        bool is_path =
-                                ctx->getCellDelay(crit_net->driver.cell, port.first, crit_net->driver.port, comb_delay);
-                        if (!is_path)
-                            continue;
-                        // If input port is influenced by a clock, skip
-                        int port_clocks;
-                        TimingPortClass portClass =
-                                ctx->getPortTimingClass(crit_net->driver.cell, port.first, port_clocks);
-                        if (portClass == TMG_CLOCK_INPUT || portClass == TMG_ENDPOINT || portClass == TMG_IGNORE)
-                            continue;
-                        // And find the fanin net with the latest arrival time
-                        if (net_data.count(port.second.net) &&
-                            net_data.at(port.second.net).count(crit_pair.first.start)) {
-                            auto net_arrival = net_data.at(port.second.net).at(crit_pair.first.start).max_arrival;
-                            if (net_delays) {
-                                for (auto &user : port.second.net->users)
-                                    if (user.port == port.first && user.cell == crit_net->driver.cell) {
-                                        net_arrival += ctx->getNetinfoRouteDelay(port.second.net, user);
-                                        break;
-                                    }
-                            }
-                            net_arrival += comb_delay.maxDelay();
-                            if (net_arrival > max_arrival) {
-                                max_arrival = net_arrival;
-                                crit_ipin = &port.second;
-                            }
-                        }
-                    }
-
-                    if (!crit_ipin)
-                        break;
-                    // Now convert PortInfo* into a PortRef*
-                    for (auto &usr : crit_ipin->net->users) {
-                        if (usr.cell->name == crit_net->driver.cell->name && usr.port == crit_ipin->name) {
-                            cp_ports.push_back(&usr);
-                            break;
-                        }
-                    }
-                    crit_net = crit_ipin->net;
-                }
-                std::reverse(cp_ports.begin(), cp_ports.end());
-            }
-        }
-        return min_slack;
+    // Sources are separated by pipe characters.
+    // There is no guaranteed ordering on sources, so we just print all
+    auto sourcelist = sources->second.as_string();
+    std::vector<std::string> source_entries;
+    size_t current = 0, prev = 0;
+    while ((current = sourcelist.find("|", prev)) != std::string::npos) {
+        source_entries.emplace_back(sourcelist.substr(prev, current - prev));
+        prev = current + 1;
     }
+    // Ensure we emplace the final entry
+    source_entries.emplace_back(sourcelist.substr(prev, current - prev));
 
-    void assign_budget()
-    {
-        // Clear delays to a very high value first
-        for (auto &net : ctx->nets) {
-            for (auto &usr : net.second->users) {
-                usr.budget = std::numeric_limits<delay_t>::max();
-            }
-        }
-
-        walk_paths();
+    // Iterate and print our source list at the correct indentation level
+    log_info("               Defined in:\n");
+    for (auto entry : source_entries) {
+        log_info("                 %s\n", entry.c_str());
     }
-};
+}
 
-void assign_budget(Context *ctx, bool quiet)
+void print_path_report(Context *ctx, const ClockDomainKey &start_clock, const std::vector<const PortRef *> &crit_path)
 {
-    if (!quiet) {
-        log_break();
-        log_info("Annotating ports with timing budgets for target frequency %.2f MHz\n",
-                 ctx->setting<float>("target_freq") / 1e6);
+    delay_t total = 0, logic_total = 0, route_total = 0;
+    auto &front = crit_path.front();
+    auto &front_port = front->cell->ports.at(front->port);
+    auto &front_driver = front_port.net->driver;
+
+    int port_clocks;
+    auto portClass = ctx->getPortTimingClass(front_driver.cell, front_driver.port, port_clocks);
+    IdString last_port = front_driver.port;
+    int clock_start = -1;
+    if (portClass == TMG_REGISTER_OUTPUT) {
+        for (int i = 0; i < port_clocks; i++) {
+            TimingClockingInfo clockInfo = ctx->getPortClockingInfo(front_driver.cell, front_driver.port, i);
+            const NetInfo *clknet = get_net_or_empty(front_driver.cell, clockInfo.clock_port);
+            if (clknet != nullptr && clknet->name == start_clock.clock && clockInfo.edge == start_clock.edge) {
+                last_port = clockInfo.clock_port;
+                clock_start = i;
+                break;
+            }
+        }
     }
 
-    Timing timing(ctx, ctx->setting<int>("slack_redist_iter") > 0 /* net_delays */, true /* update */);
-    timing.assign_budget();
-
-    if (!quiet || ctx->verbose) {
-        for (auto &net : ctx->nets) {
-            for (auto &user : net.second->users) {
-                // Post-update check
-                if (!ctx->setting<bool>("auto_freq") && user.budget < 0)
-                    log_info("port %s.%s, connected to net '%s', has negative "
-                             "timing budget of %fns\n",
-                             user.cell->name.c_str(ctx), user.port.c_str(ctx), net.first.c_str(ctx),
-                             ctx->getDelayNS(user.budget));
-                else if (ctx->debug)
-                    log_info("port %s.%s, connected to net '%s', has "
-                             "timing budget of %fns\n",
-                             user.cell->name.c_str(ctx), user.port.c_str(ctx), net.first.c_str(ctx),
-                             ctx->getDelayNS(user.budget));
+    log_info("curr total\n");
+    for (auto sink : crit_path) {
+        auto sink_cell = sink->cell;
+        auto &port = sink_cell->ports.at(sink->port);
+        auto net = port.net;
+        auto &driver = net->driver;
+        auto driver_cell = driver.cell;
+        DelayQuad comb_delay;
+        if (clock_start != -1) {
+            auto clockInfo = ctx->getPortClockingInfo(driver_cell, driver.port, clock_start);
+            comb_delay = clockInfo.clockToQ;
+            clock_start = -1;
+        } else if (last_port == driver.port) {
+            // Case where we start with a STARTPOINT etc
+            comb_delay = DelayQuad(0);
+        } else {
+            ctx->getCellDelay(driver_cell, last_port, driver.port, comb_delay);
+        }
+        total += comb_delay.maxDelay();
+        logic_total += comb_delay.maxDelay();
+        log_info("%4.1f %4.1f  Source %s.%s\n", ctx->getDelayNS(comb_delay.maxDelay()), ctx->getDelayNS(total),
+                 driver_cell->name.c_str(ctx), driver.port.c_str(ctx));
+        auto net_delay = ctx->getNetinfoRouteDelay(net, *sink);
+        total += net_delay;
+        route_total += net_delay;
+        auto driver_loc = ctx->getBelLocation(driver_cell->bel);
+        auto sink_loc = ctx->getBelLocation(sink_cell->bel);
+        log_info("%4.1f %4.1f    Net %s budget %f ns (%d,%d) -> (%d,%d)\n", ctx->getDelayNS(net_delay),
+                 ctx->getDelayNS(total), net->name.c_str(ctx), ctx->getDelayNS(sink->budget), driver_loc.x,
+                 driver_loc.y, sink_loc.x, sink_loc.y);
+        log_info("               Sink %s.%s\n", sink_cell->name.c_str(ctx), sink->port.c_str(ctx));
+        if (ctx->verbose) {
+            auto driver_wire = ctx->getNetinfoSourceWire(net);
+            auto sink_wire = ctx->getNetinfoSinkWire(net, *sink, 0);
+            log_info("                 prediction: %f ns estimate: %f ns\n",
+                     ctx->getDelayNS(ctx->predictDelay(net, *sink)),
+                     ctx->getDelayNS(ctx->estimateDelay(driver_wire, sink_wire)));
+            auto cursor = sink_wire;
+            delay_t delay;
+            while (driver_wire != cursor) {
+#ifdef ARCH_ECP5
+                if (net->is_global)
+                    break;
+#endif
+                auto it = net->wires.find(cursor);
+                assert(it != net->wires.end());
+                auto pip = it->second.pip;
+                NPNR_ASSERT(pip != PipId());
+                delay = ctx->getPipDelay(pip).maxDelay();
+                log_info("                 %1.3f %s\n", ctx->getDelayNS(delay), ctx->nameOfPip(pip));
+                cursor = ctx->getPipSrcWire(pip);
             }
         }
+        if (!ctx->disable_critical_path_source_print) {
+            print_net_source(ctx, net);
+        }
+        last_port = sink->port;
     }
-
-    // For slack redistribution, if user has not specified a frequency dynamically adjust the target frequency to be the
-    // currently achieved maximum
-    if (ctx->setting<bool>("auto_freq") && ctx->setting<int>("slack_redist_iter") > 0) {
-        delay_t default_slack = delay_t((1.0e9 / ctx->getDelayNS(1)) / ctx->setting<float>("target_freq"));
-        ctx->settings[ctx->id("target_freq")] =
-                std::to_string(1.0e9 / ctx->getDelayNS(default_slack - timing.min_slack));
-        if (ctx->verbose)
-            log_info("minimum slack for this assign = %.2f ns, target Fmax for next "
-                     "update = %.2f MHz\n",
-                     ctx->getDelayNS(timing.min_slack), ctx->setting<float>("target_freq") / 1e6);
+    int clockCount = 0;
+    auto sinkClass = ctx->getPortTimingClass(crit_path.back()->cell, crit_path.back()->port, clockCount);
+    if (sinkClass == TMG_REGISTER_INPUT && clockCount > 0) {
+        auto sinkClockInfo = ctx->getPortClockingInfo(crit_path.back()->cell, crit_path.back()->port, 0);
+        delay_t setup = sinkClockInfo.setup.maxDelay();
+        total += setup;
+        logic_total += setup;
+        log_info("%4.1f %4.1f  Setup %s.%s\n", ctx->getDelayNS(setup), ctx->getDelayNS(total),
+                 crit_path.back()->cell->name.c_str(ctx), crit_path.back()->port.c_str(ctx));
     }
-
-    if (!quiet)
-        log_info("Checksum: 0x%08x\n", ctx->checksum());
+    log_info("%.1f ns logic, %.1f ns routing\n", ctx->getDelayNS(logic_total), ctx->getDelayNS(route_total));
 }
+} // namespace
 
-void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool print_path, bool warn_on_failure)
+void TimingAnalyser::print_timing_report(bool print_histogram, bool print_fmax, bool print_path, bool warn_on_failure)
 {
-    auto format_event = [ctx](const ClockEvent &e, int field_width = 0) {
+    auto format_event = [&](const ClockDomainKey &e, int field_width = 0) {
         std::string value;
-        if (e.clock == ctx->id("$async$"))
+        if (e.clock == IdString())
             value = std::string("<async>");
         else
             value = (e.edge == FALLING_EDGE ? std::string("negedge ") : std::string("posedge ")) + e.clock.str(ctx);
@@ -1121,212 +1124,98 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
         return value;
     };
 
-    CriticalPathMap crit_paths;
-    DelayFrequency slack_histogram;
+    // The critical path of each domain pair ends at the endpoint with the worst slack
+    std::vector<port_id_t> crit_endpoint(domain_pairs.size(), -1);
+    for (domain_id_t i = 0; i < domain_id_t(domain_pairs.size()); i++) {
+        auto eps = get_failing_eps(i, 1);
+        if (!eps.empty())
+            crit_endpoint.at(i) = eps.front();
+    }
+    auto path_delay = [&](domain_id_t pair) {
+        auto &dp = domain_pairs.at(pair);
+        return dp.period.minDelay() - ports.at(crit_endpoint.at(pair)).domain_pairs.at(pair).setup_slack;
+    };
 
-    Timing timing(ctx, true /* net_delays */, false /* update */, (print_path || print_fmax) ? &crit_paths : nullptr,
-                  print_histogram ? &slack_histogram : nullptr);
-    timing.walk_paths();
-    std::map<IdString, std::pair<ClockPair, CriticalPath>> clock_reports;
+    std::map<IdString, domain_id_t> clock_reports;
     std::map<IdString, double> clock_fmax;
-    std::vector<ClockPair> xclock_paths;
+    std::vector<domain_id_t> xclock_paths;
     std::set<IdString> empty_clocks; // set of clocks with no interior paths
     if (print_path || print_fmax) {
-        for (auto path : crit_paths) {
-            const ClockEvent &a = path.first.start;
-            const ClockEvent &b = path.first.end;
-            empty_clocks.insert(a.clock);
-            empty_clocks.insert(b.clock);
+        for (domain_id_t i = 0; i < domain_id_t(domain_pairs.size()); i++) {
+            if (crit_endpoint.at(i) == -1)
+                continue;
+            auto &dp = domain_pairs.at(i);
+            empty_clocks.insert(domains.at(dp.key.launch).key.clock);
+            empty_clocks.insert(domains.at(dp.key.capture).key.clock);
         }
-        for (auto path : crit_paths) {
-            const ClockEvent &a = path.first.start;
-            const ClockEvent &b = path.first.end;
-            if (a.clock != b.clock || a.clock == ctx->id("$async$"))
+        for (domain_id_t i = 0; i < domain_id_t(domain_pairs.size()); i++) {
+            if (crit_endpoint.at(i) == -1)
+                continue;
+            auto &dp = domain_pairs.at(i);
+            const auto &a = domains.at(dp.key.launch).key;
+            const auto &b = domains.at(dp.key.capture).key;
+            if (a.clock != b.clock || a.clock == IdString()) {
+                xclock_paths.push_back(i);
                 continue;
+            }
             double Fmax;
             empty_clocks.erase(a.clock);
             if (a.edge == b.edge)
-                Fmax = 1000 / ctx->getDelayNS(path.second.path_delay);
+                Fmax = 1000 / ctx->getDelayNS(path_delay(i));
             else
-                Fmax = 500 / ctx->getDelayNS(path.second.path_delay);
+                Fmax = 500 / ctx->getDelayNS(path_delay(i));
             if (!clock_fmax.count(a.clock) || Fmax < clock_fmax.at(a.clock)) {
-                clock_reports[a.clock] = path;
+                clock_reports[a.clock] = i;
                 clock_fmax[a.clock] = Fmax;
             }
         }
 
-        for (auto &path : crit_paths) {
-            const ClockEvent &a = path.first.start;
-            const ClockEvent &b = path.first.end;
-            if (a.clock == b.clock && a.clock != ctx->id("$async$"))
-                continue;
-            xclock_paths.push_back(path.first);
-        }
-
         if (clock_reports.empty()) {
             log_info("No Fmax available; no interior timing paths found in design.\n");
         }
 
-        std::sort(xclock_paths.begin(), xclock_paths.end(), [ctx](const ClockPair &a, const ClockPair &b) {
-            if (a.start.clock.str(ctx) < b.start.clock.str(ctx))
-                return true;
-            if (a.start.clock.str(ctx) > b.start.clock.str(ctx))
-                return false;
-            if (a.start.edge < b.start.edge)
-                return true;
-            if (a.start.edge > b.start.edge)
-                return false;
-            if (a.end.clock.str(ctx) < b.end.clock.str(ctx))
-                return true;
-            if (a.end.clock.str(ctx) > b.end.clock.str(ctx))
-                return false;
-            if (a.end.edge < b.end.edge)
-                return true;
-            return false;
+        std::sort(xclock_paths.begin(), xclock_paths.end(), [&](domain_id_t pa, domain_id_t pb) {
+            const auto &a_start = domains.at(domain_pairs.at(pa).key.launch).key;
+            const auto &a_end = domains.at(domain_pairs.at(pa).key.capture).key;
+            const auto &b_start = domains.at(domain_pairs.at(pb).key.launch).key;
+            const auto &b_end = domains.at(domain_pairs.at(pb).key.capture).key;
+            if (a_start.clock.str(ctx) != b_start.clock.str(ctx))
+                return a_start.clock.str(ctx) < b_start.clock.str(ctx);
+            if (a_start.edge != b_start.edge)
+                return a_start.edge < b_start.edge;
+            if (a_end.clock.str(ctx) != b_end.clock.str(ctx))
+                return a_end.clock.str(ctx) < b_end.clock.str(ctx);
+            return a_end.edge < b_end.edge;
         });
     }
 
     if (print_path) {
-        static auto print_net_source = [](Context *ctx, NetInfo *net) {
-            // Check if this net is annotated with a source list
-            auto sources = net->attrs.find(ctx->id("src"));
-            if (sources == net->attrs.end()) {
-                // No sources for this net, can't print anything
-                return;
-            }
-
-            // Sources are separated by pipe characters.
-            // There is no guaranteed ordering on sources, so we just print all
-            auto sourcelist = sources->second.as_string();
-            std::vector<std::string> source_entries;
-            size_t current = 0, prev = 0;
-            while ((current = sourcelist.find("|", prev)) != std::string::npos) {
-                source_entries.emplace_back(sourcelist.substr(prev, current - prev));
-                prev = current + 1;
-            }
-            // Ensure we emplace the final entry
-            source_entries.emplace_back(sourcelist.substr(prev, current - prev));
-
-            // Iterate and print our source list at the correct indentation level
-            log_info("               Defined in:\n");
-            for (auto entry : source_entries) {
-                log_info("                 %s\n", entry.c_str());
-            }
-        };
-
-        auto print_path_report = [ctx](ClockPair &clocks, PortRefVector &crit_path) {
-            delay_t total = 0, logic_total = 0, route_total = 0;
-            auto &front = crit_path.front();
-            auto &front_port = front->cell->ports.at(front->port);
-            auto &front_driver = front_port.net->driver;
-
-            int port_clocks;
-            auto portClass = ctx->getPortTimingClass(front_driver.cell, front_driver.port, port_clocks);
-            IdString last_port = front_driver.port;
-            int clock_start = -1;
-            if (portClass == TMG_REGISTER_OUTPUT) {
-                for (int i = 0; i < port_clocks; i++) {
-                    TimingClockingInfo clockInfo = ctx->getPortClockingInfo(front_driver.cell, front_driver.port, i);
-                    const NetInfo *clknet = get_net_or_empty(front_driver.cell, clockInfo.clock_port);
-                    if (clknet != nullptr && clknet->name == clocks.start.clock &&
-                        clockInfo.edge == clocks.start.edge) {
-                        last_port = clockInfo.clock_port;
-                        clock_start = i;
-                        break;
-                    }
-                }
-            }
-
-            log_info("curr total\n");
-            for (auto sink : crit_path) {
-                auto sink_cell = sink->cell;
-                auto &port = sink_cell->ports.at(sink->port);
-                auto net = port.net;
-                auto &driver = net->driver;
-                auto driver_cell = driver.cell;
-                DelayQuad comb_delay;
-                if (clock_start != -1) {
-                    auto clockInfo = ctx->getPortClockingInfo(driver_cell, driver.port, clock_start);
-                    comb_delay = clockInfo.clockToQ;
-                    clock_start = -1;
-                } else if (last_port == driver.port) {
-                    // Case where we start with a STARTPOINT etc
-                    comb_delay = DelayQuad(0);
-                } else {
-                    ctx->getCellDelay(driver_cell, last_port, driver.port, comb_delay);
-                }
-                total += comb_delay.maxDelay();
-                logic_total += comb_delay.maxDelay();
-                log_info("%4.1f %4.1f  Source %s.%s\n", ctx->getDelayNS(comb_delay.maxDelay()), ctx->getDelayNS(total),
-                         driver_cell->name.c_str(ctx), driver.port.c_str(ctx));
-                auto net_delay = ctx->getNetinfoRouteDelay(net, *sink);
-                total += net_delay;
-                route_total += net_delay;
-                auto driver_loc = ctx->getBelLocation(driver_cell->bel);
-                auto sink_loc = ctx->getBelLocation(sink_cell->bel);
-                log_info("%4.1f %4.1f    Net %s budget %f ns (%d,%d) -> (%d,%d)\n", ctx->getDelayNS(net_delay),
-                         ctx->getDelayNS(total), net->name.c_str(ctx), ctx->getDelayNS(sink->budget), driver_loc.x,
-                         driver_loc.y, sink_loc.x, sink_loc.y);
-                log_info("               Sink %s.%s\n", sink_cell->name.c_str(ctx), sink->port.c_str(ctx));
-                if (ctx->verbose) {
-                    auto driver_wire = ctx->getNetinfoSourceWire(net);
-                    auto sink_wire = ctx->getNetinfoSinkWire(net, *sink, 0);
-                    log_info("                 prediction: %f ns estimate: %f ns\n",
-                             ctx->getDelayNS(ctx->predictDelay(net, *sink)),
-                             ctx->getDelayNS(ctx->estimateDelay(driver_wire, sink_wire)));
-                    auto cursor = sink_wire;
-                    delay_t delay;
-                    while (driver_wire != cursor) {
-#ifdef ARCH_ECP5
-                        if (net->is_global)
-                            break;
-#endif
-                        auto it = net->wires.find(cursor);
-                        assert(it != net->wires.end());
-                        auto pip = it->second.pip;
-                        NPNR_ASSERT(pip != PipId());
-                        delay = ctx->getPipDelay(pip).maxDelay();
-                        log_info("                 %1.3f %s\n", ctx->getDelayNS(delay), ctx->nameOfPip(pip));
-                        cursor = ctx->getPipSrcWire(pip);
-                    }
-                }
-                if (!ctx->disable_critical_path_source_print) {
-                    print_net_source(ctx, net);
-                }
-                last_port = sink->port;
-            }
-            int clockCount = 0;
-            auto sinkClass = ctx->getPortTimingClass(crit_path.back()->cell, crit_path.back()->port, clockCount);
-            if (sinkClass == TMG_REGISTER_INPUT && clockCount > 0) {
-                auto sinkClockInfo = ctx->getPortClockingInfo(crit_path.back()->cell, crit_path.back()->port, 0);
-                delay_t setup = sinkClockInfo.setup.maxDelay();
-                total += setup;
-                logic_total += setup;
-                log_info("%4.1f %4.1f  Setup %s.%s\n", ctx->getDelayNS(setup), ctx->getDelayNS(total),
-                         crit_path.back()->cell->name.c_str(ctx), crit_path.back()->port.c_str(ctx));
-            }
-            log_info("%.1f ns logic, %.1f ns routing\n", ctx->getDelayNS(logic_total), ctx->getDelayNS(route_total));
+        auto print_domain_pair_path = [&](domain_id_t pair) {
+            auto &dp = domain_pairs.at(pair);
+            auto crit_path = get_crit_path_sinks(crit_endpoint.at(pair), dp.key.launch);
+            if (!crit_path.empty())
+                print_path_report(ctx, domains.at(dp.key.launch).key, crit_path);
         };
 
         for (auto &clock : clock_reports) {
             log_break();
-            std::string start =
-                    clock.second.first.start.edge == FALLING_EDGE ? std::string("negedge") : std::string("posedge");
-            std::string end =
-                    clock.second.first.end.edge == FALLING_EDGE ? std::string("negedge") : std::string("posedge");
+            auto &dp = domain_pairs.at(clock.second);
+            std::string start = domains.at(dp.key.launch).key.edge == FALLING_EDGE ? std::string("negedge")
+                                                                                    : std::string("posedge");
+            std::string end = domains.at(dp.key.capture).key.edge == FALLING_EDGE ? std::string("negedge")
+                                                                                   : std::string("posedge");
             log_info("Critical path report for clock '%s' (%s -> %s):\n", clock.first.c_str(ctx), start.c_str(),
                      end.c_str());
-            auto &crit_path = clock.second.second.ports;
-            print_path_report(clock.second.first, crit_path);
+            print_domain_pair_path(clock.second);
         }
 
         for (auto &xclock : xclock_paths) {
             log_break();
-            std::string start = format_event(xclock.start);
-            std::string end = format_event(xclock.end);
+            auto &dp = domain_pairs.at(xclock);
+            std::string start = format_event(domains.at(dp.key.launch).key);
+            std::string end = format_event(domains.at(dp.key.capture).key);
             log_info("Critical path report for cross-domain path '%s' -> '%s':\n", start.c_str(), end.c_str());
-            auto &crit_path = crit_paths.at(xclock).ports;
-            print_path_report(xclock, crit_path);
+            print_domain_pair_path(xclock);
         }
     }
     if (print_fmax) {
@@ -1353,28 +1242,43 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
                                    clock_name.c_str(), clock_fmax[clock.first], passed ? "PASS" : "FAIL", target);
         }
         for (auto &eclock : empty_clocks) {
-            if (eclock != ctx->id("$async$"))
+            if (eclock != IdString())
                 log_info("Clock '%s' has no interior paths\n", eclock.c_str(ctx));
         }
         log_break();
 
         int start_field_width = 0, end_field_width = 0;
         for (auto &xclock : xclock_paths) {
-            start_field_width = std::max((int)format_event(xclock.start).length(), start_field_width);
-            end_field_width = std::max((int)format_event(xclock.end).length(), end_field_width);
+            auto &dp = domain_pairs.at(xclock);
+            start_field_width = std::max((int)format_event(domains.at(dp.key.launch).key).length(), start_field_width);
+            end_field_width = std::max((int)format_event(domains.at(dp.key.capture).key).length(), end_field_width);
         }
 
         for (auto &xclock : xclock_paths) {
-            const ClockEvent &a = xclock.start;
-            const ClockEvent &b = xclock.end;
-            auto &path = crit_paths.at(xclock);
-            auto ev_a = format_event(a, start_field_width), ev_b = format_event(b, end_field_width);
-            log_info("Max delay %s -> %s: %0.02f ns\n", ev_a.c_str(), ev_b.c_str(), ctx->getDelayNS(path.path_delay));
+            auto &dp = domain_pairs.at(xclock);
+            auto ev_a = format_event(domains.at(dp.key.launch).key, start_field_width),
+                 ev_b = format_event(domains.at(dp.key.capture).key, end_field_width);
+            log_info("Max delay %s -> %s: %0.02f ns\n", ev_a.c_str(), ev_b.c_str(),
+                     ctx->getDelayNS(path_delay(xclock)));
         }
         log_break();
     }
 
-    if (print_histogram && slack_histogram.size() > 0) {
+    if (print_histogram) {
+        // Slack of each endpoint, for each launching domain
+        std::map<int, unsigned> slack_histogram;
+        for (domain_id_t dom_id = 0; dom_id < domain_id_t(domains.size()); ++dom_id) {
+            for (auto &ep : domains.at(dom_id).endpoints) {
+                for (auto &pdp : ports.at(ep.first).domain_pairs) {
+                    if (domain_pairs.at(pdp.first).key.capture != dom_id)
+                        continue;
+                    int slack_ps = ctx->getDelayNS(pdp.second.setup_slack) * 1000;
+                    slack_histogram[slack_ps]++;
+                }
+            }
+        }
+        if (slack_histogram.empty())
+            return;
         unsigned num_bins = 20;
         unsigned bar_width = 60;
         auto min_slack = slack_histogram.begin()->first;
@@ -1400,4 +1304,77 @@ void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool p
     }
 }
 
+namespace {
+void check_loops(Context *ctx, const TimingAnalyser &tmg)
+{
+    if (!tmg.have_loops || bool_or_default(ctx->settings, ctx->id("timing/ignoreLoops"), false))
+        return;
+    if (ctx->force)
+        log_warning("timing analysis failed due to presence of combinatorial loops, incomplete specification "
+                    "of timing ports, etc.\n");
+    else
+        log_error("timing analysis failed due to presence of combinatorial loops, incomplete specification of "
+                  "timing ports, etc.\n");
+}
+} // namespace
+
+void assign_budget(Context *ctx, bool quiet)
+{
+    if (!quiet) {
+        log_break();
+        log_info("Annotating ports with timing budgets for target frequency %.2f MHz\n",
+                 ctx->setting<float>("target_freq") / 1e6);
+    }
+
+    TimingAnalyser tmg(ctx);
+    tmg.setup_only = true;
+    tmg.verbose_mode = !quiet && !bool_or_default(ctx->settings, ctx->id("timing/ignoreLoops"), false);
+    tmg.use_route_delays = ctx->setting<int>("slack_redist_iter") > 0;
+    tmg.setup();
+    check_loops(ctx, tmg);
+    delay_t min_slack = tmg.assign_budgets();
+
+    if (!quiet || ctx->verbose) {
+        for (auto &net : ctx->nets) {
+            for (auto &user : net.second->users) {
+                // Post-update check
+                if (!ctx->setting<bool>("auto_freq") && user.budget < 0)
+                    log_info("port %s.%s, connected to net '%s', has negative "
+                             "timing budget of %fns\n",
+                             user.cell->name.c_str(ctx), user.port.c_str(ctx), net.first.c_str(ctx),
+                             ctx->getDelayNS(user.budget));
+                else if (ctx->debug)
+                    log_info("port %s.%s, connected to net '%s', has "
+                             "timing budget of %fns\n",
+                             user.cell->name.c_str(ctx), user.port.c_str(ctx), net.first.c_str(ctx),
+                             ctx->getDelayNS(user.budget));
+            }
+        }
+    }
+
+    // For slack redistribution, if user has not specified a frequency dynamically adjust the target frequency to be the
+    // currently achieved maximum
+    if (ctx->setting<bool>("auto_freq") && ctx->setting<int>("slack_redist_iter") > 0) {
+        delay_t default_slack = delay_t((1.0e9 / ctx->getDelayNS(1)) / ctx->setting<float>("target_freq"));
+        ctx->settings[ctx->id("target_freq")] = std::to_string(1.0e9 / ctx->getDelayNS(default_slack - min_slack));
+        if (ctx->verbose)
+            log_info("minimum slack for this assign = %.2f ns, target Fmax for next "
+                     "update = %.2f MHz\n",
+                     ctx->getDelayNS(min_slack), ctx->setting<float>("target_freq") / 1e6);
+    }
+
+    if (!quiet)
+        log_info("Checksum: 0x%08x\n", ctx->checksum());
+}
+
+void timing_analysis(Context *ctx, bool print_histogram, bool print_fmax, bool print_path, bool warn_on_failure)
+{
+    TimingAnalyser tmg(ctx);
+    tmg.setup_only = true;
+    tmg.verbose_mode = !bool_or_default(ctx->settings, ctx->id("timing/ignoreLoops"), false);
+    tmg.setup();
+    check_loops(ctx, tmg);
+    tmg.print_timing_report(print_histogram, print_fmax, print_path, warn_on_failure);
+}
+
 NEXTPNR_NAMESPACE_END
@@ -20,6 +20,9 @@
 #ifndef TIMING_H
 #define TIMING_H
 
+#include <algorithm>
+#include <boost/container/small_vector.hpp>
+#include <functional>
 #include "nextpnr.h"
 
 NEXTPNR_NAMESPACE_BEGIN
@@ -130,12 +133,23 @@ struct TimingAnalyser
     void run();
     void print_report();
 
-    float get_criticality(CellPortKey port) const { return ports.at(port).worst_crit; }
-    float get_setup_slack(CellPortKey port) const { return ports.at(port).worst_setup_slack; }
+    // Set the budget of every net user by evenly distributing the slack of each path amongst the arcs on it, and
+    // return the worst slack in the design
+    delay_t assign_budgets();
+    // Print the Fmax of each clock, the critical path of each domain pair and/or a histogram of endpoint slack
+    void print_timing_report(bool print_histogram, bool print_fmax, bool print_path, bool warn_on_failure);
+
+    // Incremental analysis, for use inside the router loop: update the routing delay into an input port, then call
+    // run_incremental() to re-propagate times only through the fan-in and fan-out cones of the changed ports
+    void set_route_delay(CellPortKey port, DelayPair value);
+    void run_incremental();
+
+    float get_criticality(CellPortKey port) const { return ports.at(port_index(port)).worst_crit; }
+    float get_setup_slack(CellPortKey port) const { return ports.at(port_index(port)).worst_setup_slack; }
     float get_domain_setup_slack(CellPortKey port) const
     {
         delay_t slack = std::numeric_limits<delay_t>::max();
-        for (const auto &dp : ports.at(port).domain_pairs)
+        for (const auto &dp : ports.at(port_index(port)).domain_pairs)
             slack = std::min(slack, domain_pairs.at(dp.first).worst_setup_slack);
         return slack;
     }
@@ -144,8 +158,15 @@ struct TimingAnalyser
     bool verbose_mode = false;
     bool have_loops = false;
     bool updated_domains = false;
+    // if false, all routing delays are taken as zero
+    bool use_route_delays = true;
+    // number of threads used for the forward and backward walks, set from the timing/threads setting by setup()
+    int threads = 1;
 
   private:
+    // Ports are numbered densely by init_ports(), and referred to by index everywhere inside the analyser
+    typedef int port_id_t;
+
     void init_ports();
     void get_cell_delays();
     void get_route_delays();
@@ -156,23 +177,34 @@ struct TimingAnalyser
 
     void walk_forward();
     void walk_backward();
+    // Call func for every port, one topological level at a time, so the ports within a level can be processed in
+    // parallel
+    void for_each_level(bool backwards, const std::function<void(port_id_t)> &func);
+
+    void init_startpoint(domain_id_t dom_id, const std::pair<port_id_t, port_id_t> &sp);
+    void init_endpoint(domain_id_t dom_id, const std::pair<port_id_t, port_id_t> &ep);
+    // Recompute the arrival/required time of a single port from its fan-in/fan-out
+    void pull_arrival(port_id_t port);
+    void pull_required(port_id_t port);
 
     void compute_slack();
     void compute_criticality();
+    void compute_port_slack(port_id_t port);
+    void compute_port_criticality(port_id_t port);
 
     void print_fmax();
     // get the N most failing endpoints for a given domain pair
-    std::vector<CellPortKey> get_failing_eps(domain_id_t domain_pair, int count);
+    std::vector<port_id_t> get_failing_eps(domain_id_t domain_pair, int count);
     // print the critical path for an endpoint and domain pair
-    void print_critical_path(CellPortKey endpoint, domain_id_t domain_pair);
+    void print_critical_path(port_id_t endpoint, domain_id_t domain_pair);
 
     const DelayPair init_delay{std::numeric_limits<delay_t>::max(), std::numeric_limits<delay_t>::lowest()};
 
     // Set arrival/required times if more/less than the current value
-    void set_arrival_time(CellPortKey target, domain_id_t domain, DelayPair arrival, int path_length,
-                          CellPortKey prev = CellPortKey());
-    void set_required_time(CellPortKey target, domain_id_t domain, DelayPair required, int path_length,
-                           CellPortKey prev = CellPortKey());
+    void set_arrival_time(port_id_t target, domain_id_t domain, DelayPair arrival, int path_length,
+                          port_id_t prev = -1);
+    void set_required_time(port_id_t target, domain_id_t domain, DelayPair required, int path_length,
+                           port_id_t prev = -1);
 
     // To avoid storing the domain tag structure (which could get large when considering more complex constrained tag
     // cases), assign each domain an ID and use that instead
@@ -181,8 +213,8 @@ struct TimingAnalyser
     struct ArrivReqTime
     {
         DelayPair value;
-        CellPortKey bwd_min, bwd_max;
-        int path_length;
+        port_id_t bwd_min = -1, bwd_max = -1;
+        int path_length = 0;
     };
     // Data per port-domain tuple
     struct PortDomainPairData
@@ -193,6 +225,45 @@ struct TimingAnalyser
         float criticality = 0;
     };
 
+    // Per-domain data of a port. Almost all ports are only in one or two domains, so the entries are stored inline
+    // and searched linearly rather than hashed
+    template <typename T> struct DomainMap
+    {
+        typedef std::pair<domain_id_t, T> entry_t;
+        typedef typename boost::container::small_vector<entry_t, 2>::iterator iterator;
+        typedef typename boost::container::small_vector<entry_t, 2>::const_iterator const_iterator;
+        boost::container::small_vector<entry_t, 2> entries;
+
+        iterator begin() { return entries.begin(); }
+        iterator end() { return entries.end(); }
+        const_iterator begin() const { return entries.begin(); }
+        const_iterator end() const { return entries.end(); }
+
+        iterator find(domain_id_t dom)
+        {
+            return std::find_if(entries.begin(), entries.end(), [dom](const entry_t &e) { return e.first == dom; });
+        }
+        size_t count(domain_id_t dom) const
+        {
+            return std::any_of(entries.begin(), entries.end(), [dom](const entry_t &e) { return e.first == dom; });
+        }
+        T &at(domain_id_t dom)
+        {
+            auto found = find(dom);
+            NPNR_ASSERT(found != entries.end());
+            return found->second;
+        }
+        std::pair<iterator, bool> emplace(domain_id_t dom, const T &value)
+        {
+            auto found = find(dom);
+            if (found != entries.end())
+                return std::make_pair(found, false);
+            entries.emplace_back(dom, value);
+            return std::make_pair(entries.end() - 1, true);
+        }
+        T &operator[](domain_id_t dom) { return emplace(dom, T()).first->second; }
+    };
+
     // A cell timing arc, used to cache cell timings and reduce the number of potentially-expensive Arch API calls
     struct CellArc
     {
@@ -205,14 +276,14 @@ struct TimingAnalyser
             CLK_TO_Q
         } type;
 
-        IdString other_port;
+        port_id_t other_port;
         DelayQuad value;
         // Clock polarity, not used for combinational arcs
         ClockEdge edge;
 
-        CellArc(ArcType type, IdString other_port, DelayQuad value)
+        CellArc(ArcType type, port_id_t other_port, DelayQuad value)
                 : type(type), other_port(other_port), value(value), edge(RISING_EDGE){};
-        CellArc(ArcType type, IdString other_port, DelayQuad value, ClockEdge edge)
+        CellArc(ArcType type, port_id_t other_port, DelayQuad value, ClockEdge edge)
                 : type(type), other_port(other_port), value(value), edge(edge){};
     };
 
@@ -222,25 +293,40 @@ struct TimingAnalyser
         CellPortKey cell_port;
         NetPortKey net_port;
         PortType type;
+        TimingPortClass port_class = TMG_IGNORE;
+        // the net connected to this port, if any
+        NetInfo *net = nullptr;
+        // the driver of the net (inputs only, -1 if not driven by an output); and the users of the net in the same
+        // order as NetInfo::users (outputs only)
+        port_id_t driver = -1;
+        std::vector<port_id_t> users;
         // per domain timings
-        std::unordered_map<domain_id_t, ArrivReqTime> arrival;
-        std::unordered_map<domain_id_t, ArrivReqTime> required;
-        std::unordered_map<domain_id_t, PortDomainPairData> domain_pairs;
+        DomainMap<ArrivReqTime> arrival;
+        DomainMap<ArrivReqTime> required;
+        DomainMap<PortDomainPairData> domain_pairs;
         // cell timing arcs to (outputs)/from (inputs)  from this port
         std::vector<CellArc> cell_arcs;
+        // the combinational arcs of other ports that end at this port (i.e. from inputs for outputs, and from outputs
+        // for inputs), so arrival/required times can be pulled along the same arcs the walks push along
+        std::vector<CellArc> pull_arcs;
         // routing delay into this port (input ports only)
         DelayPair route_delay;
         // worst criticality and slack across domain pairs
-        float worst_crit;
-        delay_t worst_setup_slack, worst_hold_slack;
+        float worst_crit = 0;
+        delay_t worst_setup_slack = std::numeric_limits<delay_t>::max(),
+                worst_hold_slack = std::numeric_limits<delay_t>::max();
+        // position in topological_order, and topological level (longest path from a node with no fan-in)
+        int topo_index = -1, topo_level = 0;
+        // incremental analysis state
+        bool dirty = false, in_fwd_cone = false, in_bwd_cone = false;
     };
 
     struct PerDomain
     {
         PerDomain(ClockDomainKey key) : key(key){};
         ClockDomainKey key;
-        // these are pairs (signal port; clock port)
-        std::vector<std::pair<CellPortKey, IdString>> startpoints, endpoints;
+        // these are pairs (signal port; clock port, or -1 if unclocked)
+        std::vector<std::pair<port_id_t, port_id_t>> startpoints, endpoints;
     };
 
     struct PerDomainPair
@@ -251,22 +337,31 @@ struct TimingAnalyser
         delay_t worst_setup_slack, worst_hold_slack;
     };
 
-    CellInfo *cell_info(const CellPortKey &key);
-    PortInfo &port_info(const CellPortKey &key);
+    port_id_t port_index(const CellPortKey &key) const { return port_to_id.at(key); }
 
-    domain_id_t domain_id(IdString cell, IdString clock_port, ClockEdge edge);
+    // Unclocked start and endpoints (e.g. IO) are in a domain with an empty clock name
+    domain_id_t domain_id(IdString clock, ClockEdge edge);
     domain_id_t domain_id(const NetInfo *net, ClockEdge edge);
     domain_id_t domain_pair_id(domain_id_t launch, domain_id_t capture);
+    delay_t domain_pair_period(domain_id_t launch, domain_id_t capture);
+
+    // the net users along the critical path ending at an endpoint, from the start of the path
+    std::vector<const PortRef *> get_crit_path_sinks(port_id_t endpoint, domain_id_t launch);
 
-    void copy_domains(const CellPortKey &from, const CellPortKey &to, bool backwards);
+    void copy_domains(port_id_t from, port_id_t to, bool backwards);
 
-    std::unordered_map<CellPortKey, PerPort, CellPortKey::Hash> ports;
+    std::vector<PerPort> ports;
+    std::unordered_map<CellPortKey, port_id_t, CellPortKey::Hash> port_to_id;
     std::unordered_map<ClockDomainKey, domain_id_t, ClockDomainKey::Hash> domain_to_id;
     std::unordered_map<ClockDomainPairKey, domain_id_t, ClockDomainPairKey::Hash> pair_to_id;
     std::vector<PerDomain> domains;
     std::vector<PerDomainPair> domain_pairs;
 
-    std::vector<CellPortKey> topological_order;
+    std::vector<port_id_t> topological_order;
+    // ports grouped by topological level; the ports in a level only depend on lower levels (empty if there are loops)
+    std::vector<std::vector<port_id_t>> topo_levels;
+    // input ports with a changed route delay since the last run
+    std::vector<port_id_t> dirty_ports;
 
     Context *ctx;
 };
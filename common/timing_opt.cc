@@ -30,8 +30,10 @@
 
 #include "timing_opt.h"
 #include <boost/range/adaptor/reversed.hpp>
+#include <chrono>
 #include <queue>
 #include "nextpnr.h"
+#include "parallel.h"
 #include "timing.h"
 #include "util.h"
 
@@ -39,6 +41,18 @@
 
 NEXTPNR_NAMESPACE_BEGIN
 
+TimingOptCfg::TimingOptCfg(Context *ctx)
+{
+    maxIters = ctx->setting<int>("timingOpt/maxIters", 30);
+    earlyExit = ctx->setting<bool>("timingOpt/earlyExit", false);
+    maxTime = ctx->setting<float>("timingOpt/maxTime", 0);
+#ifdef NPNR_DISABLE_THREADS
+    threads = 1;
+#else
+    threads = std::max(1, ctx->setting<int>("timingOpt/threads", 1));
+#endif
+}
+
 class TimingOptimiser
 {
   public:
@@ -50,21 +64,141 @@ class TimingOptimiser
         if (ctx->verbose)
             timing_analysis(ctx, false, true, false, false);
         tmg.setup();
-        for (int i = 0; i < 30; i++) {
+        startt = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < cfg.maxIters; i++) {
+            if (out_of_time()) {
+                log_info("   Time budget of %.2fs used up, stopping\n", cfg.maxTime);
+                break;
+            }
             log_info("   Iteration %d...\n", i);
             tmg.run();
             setup_delay_limits();
             auto crit_paths = find_crit_paths(0.98, 50000);
-            for (auto &path : crit_paths)
-                optimise_path(path);
-            if (ctx->verbose)
+            moved_cells = 0;
+            int improved = (cfg.threads > 1) ? optimise_paths_batched(crit_paths) : optimise_paths(crit_paths);
+            if (ctx->verbose) {
+                log_info("      improved %d/%d paths\n", improved, int(crit_paths.size()));
                 timing_analysis(ctx, false, true, false, false);
+            }
+            // Solutions that aren't better than the original placement are still committed, so only stop once an
+            // iteration no longer changes the placement
+            if (cfg.earlyExit && moved_cells == 0 && !out_of_time()) {
+                log_info("   No cells moved, stopping\n");
+                break;
+            }
         }
         ctx->unlock();
         return true;
     }
 
   private:
+    // The cells of a path that may be moved, and the candidate bels found for them
+    struct PathCandidates
+    {
+        std::vector<IdString> path_cells;
+        // The bel of each path cell when the candidates were found
+        std::vector<BelId> path_cell_bels;
+        // Current candidate Bels for cells (linked in both direction>
+        std::unordered_map<IdString, std::unordered_set<BelId>> cell_neighbour_bels;
+        std::unordered_map<BelId, std::unordered_set<IdString>> bel_candidate_cells;
+        // Every tile location (z = 0) that find_neighbours looked at; the choice of candidates depends on the
+        // bindings of all the bels there, not only the ones that became candidates
+        std::unordered_set<Loc> scanned_locs;
+        // The value of move_count when the candidates were found
+        int found_at = 0;
+    };
+
+    bool out_of_time() const
+    {
+        return cfg.maxTime > 0 &&
+               std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - startt).count() > cfg.maxTime;
+    }
+
+    // Optimise paths one at a time, returns the number of paths improved
+    int optimise_paths(std::vector<std::vector<PortRef *>> &crit_paths)
+    {
+        int improved = 0;
+        for (auto &path : crit_paths) {
+            if (out_of_time())
+                break;
+            PathCandidates pc;
+            find_path_cells(path, pc);
+            if (pc.path_cells.size() >= 2)
+                find_candidates(pc, *ctx);
+            if (optimise_path(path, pc))
+                ++improved;
+        }
+        return improved;
+    }
+
+    // Optimise paths in batches. Finding the candidate bels of each path in a batch only reads the placement, so is
+    // done in parallel; the BFS and commit of each path then run serially in order, as the BFS works by binding trial
+    // swaps. If an earlier path of the batch moved a cell to or from any location the candidate search of a path looked
+    // at, or moved one of its cells, the candidates of that path are found again before the BFS. The batch size is
+    // fixed, so the result doesn't depend on the number of threads.
+    int optimise_paths_batched(std::vector<std::vector<PortRef *>> &crit_paths)
+    {
+        int improved = 0, conflicts = 0;
+        const size_t batch_size = 64;
+        for (size_t start = 0; start < crit_paths.size() && !out_of_time(); start += batch_size) {
+            size_t count = std::min(batch_size, crit_paths.size() - start);
+            // Each path has its own RNG so the result doesn't depend on which thread finds its candidates
+            std::vector<uint64_t> seeds(count);
+            for (auto &seed : seeds)
+                seed = ctx->rng64();
+            auto prepare = [&](size_t i, PathCandidates &pc) {
+                pc = PathCandidates();
+                pc.found_at = move_count;
+                find_path_cells(crit_paths.at(start + i), pc);
+                if (pc.path_cells.size() < 2)
+                    return;
+                DeterministicRNG rng;
+                rng.rngseed(seeds.at(i));
+                find_candidates(pc, rng);
+            };
+            std::vector<PathCandidates> batch(count);
+            for_each_parallel(cfg.threads, count, [&](size_t i) { prepare(i, batch.at(i)); });
+
+            for (size_t i = 0; i < count; i++) {
+                if (out_of_time())
+                    break;
+                PathCandidates &pc = batch.at(i);
+                if (has_conflict(pc)) {
+                    prepare(i, pc);
+                    ++conflicts;
+                }
+                if (optimise_path(crit_paths.at(start + i), pc))
+                    ++improved;
+            }
+        }
+        if (ctx->verbose)
+            log_info("      %d paths had their candidates invalidated by earlier paths in the batch\n", conflicts);
+        return improved;
+    }
+
+    bool has_conflict(const PathCandidates &pc)
+    {
+        for (size_t i = 0; i < pc.path_cells.size(); i++)
+            if (ctx->cells.at(pc.path_cells.at(i))->bel != pc.path_cell_bels.at(i))
+                return true;
+        for (auto &loc : pc.scanned_locs)
+            if (loc.x < int(loc_moved_at.size()) && loc.y < int(loc_moved_at.at(loc.x).size()) &&
+                loc_moved_at.at(loc.x).at(loc.y) > pc.found_at)
+                return true;
+        return false;
+    }
+
+    // Record that a cell was moved to or from the tile of a bel
+    void mark_moved(BelId bel)
+    {
+        Loc loc = ctx->getBelLocation(bel);
+        if (int(loc_moved_at.size()) < (loc.x + 1))
+            loc_moved_at.resize(loc.x + 1);
+        if (int(loc_moved_at.at(loc.x).size()) < (loc.y + 1))
+            loc_moved_at.at(loc.x).resize(loc.y + 1);
+        loc_moved_at.at(loc.x).at(loc.y) = move_count;
+    }
+
     void setup_delay_limits()
     {
         max_net_delay.clear();
@@ -162,8 +296,11 @@ class TimingOptimiser
         return true;
     }
 
-    int find_neighbours(CellInfo *cell, IdString prev_cell, int d, bool allow_swap)
+    int find_neighbours(PathCandidates &pc, DeterministicRNG &rng, CellInfo *cell, IdString prev_cell, int d,
+                        bool allow_swap)
     {
+        auto &cell_neighbour_bels = pc.cell_neighbour_bels;
+        auto &bel_candidate_cells = pc.bel_candidate_cells;
         BelId curr = cell->bel;
         Loc curr_loc = ctx->getBelLocation(curr);
         int found_count = 0;
@@ -176,6 +313,7 @@ class TimingOptimiser
                 // FIXME: This means that we cannot touch carry chains or similar relatively constrained macros
                 std::vector<BelId> free_bels_at_loc;
                 std::vector<BelId> bound_bels_at_loc;
+                pc.scanned_locs.insert(Loc(curr_loc.x + dx, curr_loc.y + dy, 0));
                 for (auto bel : ctx->getBelsByTile(curr_loc.x + dx, curr_loc.y + dy)) {
                     if (!ctx->isValidBelForCellType(cell->type, bel))
                         continue;
@@ -192,11 +330,11 @@ class TimingOptimiser
                 while (!free_bels_at_loc.empty() || !bound_bels_at_loc.empty()) {
                     BelId try_bel;
                     if (!free_bels_at_loc.empty()) {
-                        int try_idx = ctx->rng(int(free_bels_at_loc.size()));
+                        int try_idx = rng.rng(int(free_bels_at_loc.size()));
                         try_bel = free_bels_at_loc.at(try_idx);
                         free_bels_at_loc.erase(free_bels_at_loc.begin() + try_idx);
                     } else {
-                        int try_idx = ctx->rng(int(bound_bels_at_loc.size()));
+                        int try_idx = rng.rng(int(bound_bels_at_loc.size()));
                         try_bel = bound_bels_at_loc.at(try_idx);
                         bound_bels_at_loc.erase(bound_bels_at_loc.begin() + try_idx);
                     }
@@ -365,14 +503,10 @@ class TimingOptimiser
         return crit_paths;
     }
 
-    void optimise_path(std::vector<PortRef *> &path)
+    // Find the cells of a path that may be moved
+    void find_path_cells(const std::vector<PortRef *> &path, PathCandidates &pc)
     {
-        path_cells.clear();
-        cell_neighbour_bels.clear();
-        bel_candidate_cells.clear();
-        if (ctx->debug)
-            log_info("Optimising the following path: \n");
-
+        auto &path_cells = pc.path_cells;
         auto front_port = path.front();
         NetInfo *front_net = front_port->cell->ports.at(front_port->port).net;
         if (front_net != nullptr && front_net->driver.cell != nullptr) {
@@ -384,20 +518,45 @@ class TimingOptimiser
         }
 
         for (auto port : path) {
-            if (ctx->debug) {
-                float crit = tmg.get_criticality(CellPortKey(*port));
-                log_info("    %s.%s at %s crit %0.02f\n", port->cell->name.c_str(ctx), port->port.c_str(ctx),
-                         ctx->nameOfBel(port->cell->bel), crit);
-            }
             if (std::find(path_cells.begin(), path_cells.end(), port->cell->name) != path_cells.end())
                 continue;
             if (port->cell->belStrength > STRENGTH_WEAK || !cfg.cellTypes.count(port->cell->type) ||
                 port->cell->constr_parent != nullptr || !port->cell->constr_children.empty())
                 continue;
-            if (ctx->debug)
-                log_info("        can move\n");
             path_cells.push_back(port->cell->name);
         }
+    }
+
+    // Find the candidate bels of each moveable cell of a path
+    void find_candidates(PathCandidates &pc, DeterministicRNG &rng)
+    {
+        IdString last_cell;
+        const int d = 2; // FIXME: how to best determine d
+        for (auto cell : pc.path_cells) {
+            CellInfo *ci = ctx->cells.at(cell).get();
+            pc.path_cell_bels.push_back(ci->bel);
+            // FIXME: when should we allow swapping due to a lack of candidates
+            find_neighbours(pc, rng, ci, last_cell, d, false);
+            last_cell = cell;
+        }
+    }
+
+    // Optimise a path using the candidates already found for it. Returns true if the path delay was improved; the tiles
+    // of any cells moved are recorded in loc_moved_at
+    bool optimise_path(std::vector<PortRef *> &path, PathCandidates &pc)
+    {
+        auto &path_cells = pc.path_cells;
+        auto &cell_neighbour_bels = pc.cell_neighbour_bels;
+        if (ctx->debug) {
+            log_info("Optimising the following path: \n");
+            for (auto port : path) {
+                float crit = tmg.get_criticality(CellPortKey(*port));
+                log_info("    %s.%s at %s crit %0.02f\n", port->cell->name.c_str(ctx), port->port.c_str(ctx),
+                         ctx->nameOfBel(port->cell->bel), crit);
+                if (std::find(path_cells.begin(), path_cells.end(), port->cell->name) != path_cells.end())
+                    log_info("        can move\n");
+            }
+        }
 
         if (path_cells.size() < 2) {
             if (ctx->debug) {
@@ -405,7 +564,7 @@ class TimingOptimiser
                 log_break();
             }
 
-            return;
+            return false;
         }
 
         // Calculate original delay before touching anything
@@ -422,14 +581,6 @@ class TimingOptimiser
             }
         }
 
-        IdString last_cell;
-        const int d = 2; // FIXME: how to best determine d
-        for (auto cell : path_cells) {
-            // FIXME: when should we allow swapping due to a lack of candidates
-            find_neighbours(ctx->cells[cell].get(), last_cell, d, false);
-            last_cell = cell;
-        }
-
         if (ctx->debug) {
             for (auto cell : path_cells) {
                 log_info("Candidate neighbours for %s (%s):\n", cell.c_str(ctx), ctx->nameOfBel(ctx->cells[cell]->bel));
@@ -516,8 +667,12 @@ class TimingOptimiser
                     if (acceptable_move(move)) {
                         cumul_costs[ncname][neighbour] = total_delay;
                         backtrace[std::make_pair(ncname, neighbour)] = std::make_pair(cellname, entry.second);
-                        if (!to_visit.count(std::make_pair(entry.first + 1, neighbour)))
+                        // All the updates to the next cell's costs are made before any of its entries are visited,
+                        // so each entry only needs to be visited once
+                        if (!to_visit.count(std::make_pair(entry.first + 1, neighbour))) {
+                            to_visit.insert(std::make_pair(entry.first + 1, neighbour));
                             visit.push(std::make_pair(entry.first + 1, neighbour));
+                        }
                     }
                 }
                 // Revert the experimental swap
@@ -533,6 +688,7 @@ class TimingOptimiser
         }
 
         // Did we find a solution??
+        bool improved = false;
         if (cumul_costs.count(path_cells.back())) {
             // Find the end position with the lowest total delay
             auto &end_options = cumul_costs.at(path_cells.back());
@@ -554,23 +710,32 @@ class TimingOptimiser
                          ctx->getDelayNS(lowest->second), ctx->getDelayNS(original_delay));
             for (auto rt_entry : boost::adaptors::reverse(route_to_solution)) {
                 CellInfo *cell = ctx->cells.at(rt_entry.first).get();
-                cell_swap_bel(cell, rt_entry.second);
+                BelId oldBel = cell_swap_bel(cell, rt_entry.second);
+                if (oldBel != rt_entry.second) {
+                    ++moved_cells;
+                    ++move_count;
+                    mark_moved(oldBel);
+                    mark_moved(rt_entry.second);
+                }
                 if (ctx->debug)
                     log_info("    %s at %s\n", rt_entry.first.c_str(ctx), ctx->nameOfBel(rt_entry.second));
             }
-
+            improved = lowest->second < original_delay;
         } else {
             if (ctx->debug)
                 log_info("Solution was not found\n");
         }
         if (ctx->debug)
             log_break();
+        return improved;
     }
 
-    // Current candidate Bels for cells (linked in both direction>
-    std::vector<IdString> path_cells;
-    std::unordered_map<IdString, std::unordered_set<BelId>> cell_neighbour_bels;
-    std::unordered_map<BelId, std::unordered_set<IdString>> bel_candidate_cells;
+    std::chrono::high_resolution_clock::time_point startt;
+    // Number of cells moved by the solutions committed in the current iteration
+    int moved_cells = 0;
+    // The number of cell moves so far, and the value it had at the last move to or from each tile
+    int move_count = 0;
+    std::vector<std::vector<int>> loc_moved_at;
     // Map cell ports to net delay limit
     std::unordered_map<std::pair<IdString, IdString>, delay_t, PairHash> max_net_delay;
     Context *ctx;
@@ -24,12 +24,23 @@ NEXTPNR_NAMESPACE_BEGIN
 
 struct TimingOptCfg
 {
-    TimingOptCfg(Context *ctx) {}
+    TimingOptCfg(Context *ctx);
 
     // The timing optimiser will *only* optimise cells of these types
     // Normally these would only be logic cells (or tiles if applicable), the algorithm makes little sense
     // for other cell types
     std::unordered_set<IdString> cellTypes;
+
+    // Maximum number of iterations, each optimising all the critical paths found at the start of the iteration
+    int maxIters;
+    // Stop once an iteration doesn't move any cells (off by default, so the fixed iteration count is kept)
+    bool earlyExit;
+    // Time budget for the whole pass in seconds, or 0 for no limit
+    float maxTime;
+    // Number of threads used to find the candidate bels of batches of paths in parallel, 1 for the original serial
+    // optimiser. Only the candidate search is parallel; the BFS path search and the moves it makes are always serial,
+    // as the BFS checks legality by binding trial swaps, so the speedup is limited to the candidate search
+    int threads;
 };
 
 extern bool timing_opt(Context *ctx, TimingOptCfg cfg);
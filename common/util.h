@@ -54,8 +54,8 @@ std::string str_or_default(const Container &ct, const KeyType &key, std::string
     }
 };
 
-template <typename KeyType>
-std::string str_or_default(const std::unordered_map<KeyType, Property> &ct, const KeyType &key, std::string def = "")
+template <template <typename...> class Map, typename KeyType, typename... Args>
+std::string str_or_default(const Map<KeyType, Property, Args...> &ct, const KeyType &key, std::string def = "")
 {
     auto found = ct.find(key);
     if (found == ct.end())
@@ -78,8 +78,8 @@ template <typename Container, typename KeyType> int int_or_default(const Contain
         return std::stoi(found->second);
 };
 
-template <typename KeyType>
-int int_or_default(const std::unordered_map<KeyType, Property> &ct, const KeyType &key, int def = 0)
+template <template <typename...> class Map, typename KeyType, typename... Args>
+int int_or_default(const Map<KeyType, Property, Args...> &ct, const KeyType &key, int def = 0)
 {
     auto found = ct.find(key);
     if (found == ct.end())
@@ -139,6 +139,39 @@ template <typename K> std::set<K> sorted(const std::unordered_set<K> &orig)
     return retVal;
 };
 
+// As above, for dict and pool
+template <typename K, typename V> std::map<K, V *> sorted(const dict<K, std::unique_ptr<V>> &orig)
+{
+    std::map<K, V *> retVal;
+    for (auto &item : orig)
+        retVal.emplace(std::make_pair(item.first, item.second.get()));
+    return retVal;
+};
+
+template <typename K, typename V> std::map<K, V &> sorted_ref(dict<K, V> &orig)
+{
+    std::map<K, V &> retVal;
+    for (auto &item : orig)
+        retVal.emplace(std::make_pair(item.first, std::ref(item.second)));
+    return retVal;
+};
+
+template <typename K, typename V> std::map<K, const V &> sorted_cref(const dict<K, V> &orig)
+{
+    std::map<K, const V &> retVal;
+    for (auto &item : orig)
+        retVal.emplace(std::make_pair(item.first, std::ref(item.second)));
+    return retVal;
+};
+
+template <typename K> std::set<K> sorted(const pool<K> &orig)
+{
+    std::set<K> retVal;
+    for (auto &item : orig)
+        retVal.insert(item);
+    return retVal;
+};
+
 // Return a net if port exists, or nullptr
 inline const NetInfo *get_net_or_empty(const CellInfo *cell, const IdString port)
 {
@@ -30,6 +30,7 @@
 #include "nextpnr.h"
 #include "placer1.h"
 #include "placer_heap.h"
+#include "placer_static.h"
 #include "router1.h"
 #include "router2.h"
 #include "timing.h"
@@ -105,6 +106,14 @@ Arch::Arch(ArchArgs args) : args(args)
 
     bel_to_cell.resize(chip_info->height * chip_info->width * max_loc_bels, nullptr);
 
+    loc_wire_base.push_back(0);
+    loc_pip_base.push_back(0);
+    for (int i = 0; i < chip_info->height * chip_info->width; i++) {
+        auto &loc = chip_info->locations[chip_info->location_type[i]];
+        loc_wire_base.push_back(loc_wire_base.back() + loc.wire_data.ssize());
+        loc_pip_base.push_back(loc_pip_base.back() + loc.pip_data.ssize());
+    }
+
     BaseArch::init_cell_types();
     BaseArch::init_bel_buckets();
 
@@ -436,6 +445,10 @@ delay_t Arch::estimateDelay(WireId src, WireId dst) const
         }
     }
 
+    delay_t lookahead_delay;
+    if (lookahead.estimateDelay(getWireIndex(src), getWireIndex(dst), lookahead_delay))
+        return lookahead_delay;
+
     auto est_location = [&](WireId w) -> std::pair<int, int> {
         const auto &wire = loc_info(w)->wire_data[w.index];
         if (w == gsrclk_wire) {
@@ -570,7 +583,7 @@ bool Arch::place()
 {
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
 
-    if (placer == "heap") {
+    if (placer == "heap" || placer == "static") {
         PlacerHeapCfg cfg(getCtx());
         cfg.criticalityExponent = 4;
         cfg.ioBufTypes.insert(id_TRELLIS_IO);
@@ -579,7 +592,8 @@ bool Arch::place()
         cfg.cellGroups.back().insert(id_MULT18X18D);
         cfg.cellGroups.back().insert(id_ALU54B);
 
-        if (!placer_heap(getCtx(), cfg))
+        bool placed = (placer == "static") ? placer_static(getCtx(), cfg) : placer_heap(getCtx(), cfg);
+        if (!placed)
             return false;
     } else if (placer == "sa") {
         if (!placer1(getCtx(), Placer1Cfg(getCtx())))
@@ -608,6 +622,8 @@ bool Arch::route()
     route_ecp5_globals(getCtx());
     assignArchInfo();
     assign_budget(getCtx(), true);
+    if (bool_or_default(settings, id("router/lookahead")))
+        lookahead.init(getCtx());
 
     bool result;
     if (router == "router1") {
@@ -1184,7 +1200,7 @@ const std::string Arch::defaultPlacer = "sa";
 
 const std::vector<std::string> Arch::availablePlacers = {"sa",
 #ifdef WITH_HEAP
-                                                         "heap"
+                                                         "heap", "static"
 #endif
 };
 
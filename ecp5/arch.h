@@ -27,6 +27,7 @@
 #include "base_arch.h"
 #include "nextpnr_types.h"
 #include "relptr.h"
+#include "router_lookahead.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -460,8 +461,12 @@ struct Arch : BaseArch<ArchRanges>
 
     mutable std::unordered_map<IdStringList, PipId> pip_by_name;
 
+    // Bels are bound in this flat array, indexed by getBelIndex, which already serves as the dense bel table; the
+    // BaseArch tables are only used for wires and pips
     std::vector<CellInfo *> bel_to_cell;
     std::unordered_map<WireId, int> wire_fanout;
+    // First dense wire and pip index for each location, in the same order as getWires/getPips
+    std::vector<int> loc_wire_base, loc_pip_base;
 
     // fast access to  X and Y IdStrings for building object names
     std::vector<IdString> x_ids, y_ids;
@@ -514,6 +519,9 @@ struct Arch : BaseArch<ArchRanges>
         return (bel.location.y * chip_info->width + bel.location.x) * max_loc_bels + bel.index;
     }
 
+    int getBelCount() const override { return int(bel_to_cell.size()); }
+    int getBelIndex(BelId bel) const override { return get_bel_flat_index(bel); }
+
     void bindBel(BelId bel, CellInfo *cell, PlaceStrength strength) override
     {
         NPNR_ASSERT(bel != BelId());
@@ -631,9 +639,9 @@ struct Arch : BaseArch<ArchRanges>
     void unbindWire(WireId wire) override
     {
         NPNR_ASSERT(wire != WireId());
-        NPNR_ASSERT(base_wire2net[wire] != nullptr);
+        NPNR_ASSERT(getBoundWireNet(wire) != nullptr);
 
-        auto &net_wires = base_wire2net[wire]->wires;
+        auto &net_wires = getBoundWireNet(wire)->wires;
         auto it = net_wires.find(wire);
         NPNR_ASSERT(it != net_wires.end());
         auto pip = it->second.pip;
@@ -646,6 +654,12 @@ struct Arch : BaseArch<ArchRanges>
 
     DelayQuad getWireDelay(WireId wire) const override { return DelayQuad(0); }
 
+    int getWireCount() const override { return loc_wire_base.back(); }
+    int getWireIndex(WireId wire) const override
+    {
+        return loc_wire_base[wire.location.y * chip_info->width + wire.location.x] + wire.index;
+    }
+
     WireRange getWires() const override
     {
         WireRange range;
@@ -786,6 +800,12 @@ struct Arch : BaseArch<ArchRanges>
         return loc;
     }
 
+    int getPipCount() const override { return loc_pip_base.back(); }
+    int getPipIndex(PipId pip) const override
+    {
+        return loc_pip_base[pip.location.y * chip_info->width + pip.location.x] + pip.index;
+    }
+
     int8_t get_pip_class(PipId pip) const { return loc_info(pip)->pip_data[pip.index].pip_type; }
 
     BelId get_package_pin_bel(const std::string &pin) const;
@@ -810,6 +830,8 @@ struct Arch : BaseArch<ArchRanges>
     // -------------------------------------------------
 
     delay_t estimateDelay(WireId src, WireId dst) const override;
+    // Precomputed lookahead used by estimateDelay, if enabled with the router/lookahead setting
+    RouterLookahead lookahead;
     ArcBounds getRouteBoundingBox(WireId src, WireId dst) const override;
     delay_t predictDelay(const NetInfo *net_info, const PortRef &sink) const override;
     delay_t getDelayEpsilon() const override { return 20; }
@@ -34,7 +34,7 @@ void add_port(const Context *ctx, CellInfo *cell, std::string name, PortType dir
 std::unique_ptr<CellInfo> create_ecp5_cell(Context *ctx, IdString type, std::string name)
 {
     static int auto_idx = 0;
-    std::unique_ptr<CellInfo> new_cell = std::unique_ptr<CellInfo>(new CellInfo());
+    std::unique_ptr<CellInfo> new_cell = std::unique_ptr<CellInfo>(new (ctx) CellInfo());
     if (name.empty()) {
         new_cell->name = ctx->id("$nextpnr_" + type.str(ctx) + "_" + std::to_string(auto_idx++));
     } else {
@@ -222,10 +222,8 @@ static void replace_port_safe(bool has_ff, CellInfo *ff, IdString ff_port, CellI
         NPNR_ASSERT(lc->ports.at(lc_port).net == ff->ports.at(ff_port).net);
         NetInfo *ffnet = ff->ports.at(ff_port).net;
         if (ffnet != nullptr)
-            ffnet->users.erase(
-                    std::remove_if(ffnet->users.begin(), ffnet->users.end(),
-                                   [ff, ff_port](PortRef port) { return port.cell == ff && port.port == ff_port; }),
-                    ffnet->users.end());
+            ffnet->remove_users_if(
+                    [ff, ff_port](const PortRef &port) { return port.cell == ff && port.port == ff_port; });
     } else {
         replace_port(ff, ff_port, lc, lc_port);
     }
@@ -465,7 +463,7 @@ void nxio_to_tr(Context *ctx, CellInfo *nxio, CellInfo *trio, std::vector<std::u
     if (ctx->ports.count(nxio->name)) {
         IdString tn_netname = nxio->name;
         NPNR_ASSERT(!ctx->nets.count(tn_netname));
-        std::unique_ptr<NetInfo> toplevel_net{new NetInfo};
+        std::unique_ptr<NetInfo> toplevel_net{new (ctx) NetInfo};
         toplevel_net->name = tn_netname;
         connect_port(ctx, toplevel_net.get(), trio, ctx->id("B"));
         ctx->ports[nxio->name].net = toplevel_net.get();
@@ -455,7 +455,7 @@ class Ecp5GlobalRouter
             dccptr = net->driver.cell;
         } else {
             auto dcc = create_ecp5_cell(ctx, id_DCCA, "$gbuf$" + net->name.str(ctx));
-            std::unique_ptr<NetInfo> glbnet = std::unique_ptr<NetInfo>(new NetInfo);
+            std::unique_ptr<NetInfo> glbnet = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
             glbnet->name = ctx->id("$glbnet$" + net->name.str(ctx));
             glbnet->driver.cell = dcc.get();
             glbnet->driver.port = id_CLKO;
@@ -469,17 +469,18 @@ class Ecp5GlobalRouter
                 } else if (is_logic_port(user)) {
                     keep_users.push_back(user);
                 } else {
-                    glbnet->users.push_back(user);
+                    glbnet->add_user(user);
                     user.cell->ports.at(user.port).net = glbnet.get();
                 }
             }
             net->users = keep_users;
+            net->refresh_user_idx();
 
             dcc->ports[id_CLKI].net = net;
             PortRef clki_pr;
             clki_pr.port = id_CLKI;
             clki_pr.cell = dcc.get();
-            net->users.push_back(clki_pr);
+            net->add_user(clki_pr);
             if (net->clkconstr) {
                 glbnet->clkconstr = std::unique_ptr<ClockConstraint>(new ClockConstraint());
                 glbnet->clkconstr->low = net->clkconstr->low;
@@ -753,14 +753,12 @@ class Ecp5Packer
         feedin->params[ctx->id("INJECT1_0")] = std::string("NO");
         feedin->params[ctx->id("INJECT1_1")] = std::string("YES");
 
-        carry->users.erase(std::remove_if(carry->users.begin(), carry->users.end(),
-                                          [chain_in](const PortRef &user) {
-                                              return user.port == chain_in.port && user.cell == chain_in.cell;
-                                          }),
-                           carry->users.end());
+        carry->remove_users_if([chain_in](const PortRef &user) {
+            return user.port == chain_in.port && user.cell == chain_in.cell;
+        });
         connect_port(ctx, carry, feedin.get(), id_A0);
 
-        std::unique_ptr<NetInfo> new_carry(new NetInfo());
+        std::unique_ptr<NetInfo> new_carry(new (ctx) NetInfo());
         new_carry->name = ctx->id(feedin->name.str(ctx) + "$COUT");
         connect_port(ctx, new_carry.get(), feedin.get(), ctx->id("COUT"));
         chain_in.cell->ports[chain_in.port].net = nullptr;
@@ -788,7 +786,7 @@ class Ecp5Packer
         carry->driver.cell = nullptr;
         connect_port(ctx, carry, feedout.get(), ctx->id("S0"));
 
-        std::unique_ptr<NetInfo> new_cin(new NetInfo());
+        std::unique_ptr<NetInfo> new_cin(new (ctx) NetInfo());
         new_cin->name = ctx->id(feedout->name.str(ctx) + "$CIN");
         new_cin->driver = carry_drv;
         carry_drv.cell->ports.at(carry_drv.port).net = new_cin.get();
@@ -798,13 +796,11 @@ class Ecp5Packer
             // Loop back into LUT4_1 for feedthrough
             connect_port(ctx, carry, feedout.get(), id_A1);
 
-            carry->users.erase(std::remove_if(carry->users.begin(), carry->users.end(),
-                                              [chain_next](const PortRef &user) {
-                                                  return user.port == chain_next->port && user.cell == chain_next->cell;
-                                              }),
-                               carry->users.end());
+            carry->remove_users_if([chain_next](const PortRef &user) {
+                return user.port == chain_next->port && user.cell == chain_next->cell;
+            });
 
-            std::unique_ptr<NetInfo> new_cout(new NetInfo());
+            std::unique_ptr<NetInfo> new_cout(new (ctx) NetInfo());
             new_cout->name = ctx->id(feedout->name.str(ctx) + "$COUT");
             connect_port(ctx, new_cout.get(), feedout.get(), ctx->id("COUT"));
 
@@ -1330,11 +1326,11 @@ class Ecp5Packer
                         } else {
                             // Not allowed to change to a tie-high
                             uc->ports[user.port].net = constnet;
-                            constnet->users.push_back(user);
+                            constnet->add_user(user);
                         }
                     } else {
                         uc->ports[user.port].net = constnet;
-                        constnet->users.push_back(user);
+                        constnet->add_user(user);
                     }
                 } else if (is_ff(ctx, uc) && user.port == ctx->id("LSR") &&
                            ((!constval && str_or_default(uc->params, ctx->id("LSRMUX"), "LSR") == "LSR") ||
@@ -1361,7 +1357,7 @@ class Ecp5Packer
                         user.port.str(ctx).substr(0, 6) == "SOURCE" || user.port.str(ctx).substr(0, 6) == "SIGNED" ||
                         user.port.str(ctx).substr(0, 2) == "OP") {
                         uc->ports[user.port].net = constnet;
-                        constnet->users.push_back(user);
+                        constnet->add_user(user);
                     } else {
                         // Connected to CIB ABCD. Default state is bitstream configurable
                         uc->params[ctx->id(user.port.str(ctx) + "MUX")] = std::string(constval ? "1" : "0");
@@ -1369,7 +1365,7 @@ class Ecp5Packer
                     }
                 } else {
                     uc->ports[user.port].net = constnet;
-                    constnet->users.push_back(user);
+                    constnet->add_user(user);
                 }
             }
         }
@@ -1383,7 +1379,7 @@ class Ecp5Packer
 
         std::unique_ptr<CellInfo> gnd_cell = create_ecp5_cell(ctx, ctx->id("LUT4"), "$PACKER_GND");
         gnd_cell->params[ctx->id("INIT")] = Property(0, 16);
-        std::unique_ptr<NetInfo> gnd_net = std::unique_ptr<NetInfo>(new NetInfo);
+        std::unique_ptr<NetInfo> gnd_net = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
         gnd_net->name = ctx->id("$PACKER_GND_NET");
         gnd_net->driver.cell = gnd_cell.get();
         gnd_net->driver.port = ctx->id("Z");
@@ -1391,7 +1387,7 @@ class Ecp5Packer
 
         std::unique_ptr<CellInfo> vcc_cell = create_ecp5_cell(ctx, ctx->id("LUT4"), "$PACKER_VCC");
         vcc_cell->params[ctx->id("INIT")] = Property(65535, 16);
-        std::unique_ptr<NetInfo> vcc_net = std::unique_ptr<NetInfo>(new NetInfo);
+        std::unique_ptr<NetInfo> vcc_net = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
         vcc_net->name = ctx->id("$PACKER_VCC_NET");
         vcc_net->driver.cell = vcc_cell.get();
         vcc_net->driver.port = ctx->id("Z");
@@ -1456,7 +1452,9 @@ class Ecp5Packer
             IdString o = ctx->id(oldname), n = ctx->id(newname);
             if (!c->params.count(o))
                 return;
-            c->params[n] = c->params[o];
+            // Copy the value first, as adding the new parameter may move the existing ones
+            Property value = c->params.at(o);
+            c->params[n] = value;
             c->params.erase(o);
         };
         for (auto cell : sorted(ctx->cells)) {
@@ -1931,7 +1929,7 @@ class Ecp5Packer
                 IdString eckname = ctx->id(ecknet->name.str(ctx) + "$eclk" + std::to_string(bank) + "_" +
                                            std::to_string(free_eclk));
 
-                std::unique_ptr<NetInfo> promoted_ecknet(new NetInfo);
+                std::unique_ptr<NetInfo> promoted_ecknet(new (ctx) NetInfo);
                 promoted_ecknet->name = eckname;
                 promoted_ecknet->attrs[ctx->id("ECP5_IS_GLOBAL")] = 1; // Prevents router etc touching this special net
                 eclk.buf = promoted_ecknet.get();
@@ -2017,8 +2015,8 @@ class Ecp5Packer
             ci->ports[port].type = PORT_IN;
         }
 
-        std::unique_ptr<CellInfo> zero_cell{new CellInfo};
-        std::unique_ptr<NetInfo> zero_net{new NetInfo};
+        std::unique_ptr<CellInfo> zero_cell{new (ctx) CellInfo};
+        std::unique_ptr<NetInfo> zero_net{new (ctx) NetInfo};
         IdString name = ctx->id(ci->name.str(ctx) + "$zero$" + port.str(ctx));
         zero_cell->type = ctx->id("GND");
         zero_cell->name = name;
@@ -35,6 +35,7 @@
 #include "nextpnr.h"
 #include "placer1.h"
 #include "placer_heap.h"
+#include "placer_static.h"
 #include "router1.h"
 #include "router2.h"
 #include "timing.h"
@@ -138,6 +139,14 @@ Arch::Arch(ArchArgs args) : args(args), disallow_site_routing(false)
     id_GND = id("GND");
     id_VCC = id("VCC");
 
+    tile_wire_base.push_back(chip_info->nodes.ssize());
+    tile_pip_base.push_back(0);
+    for (const auto &tile : chip_info->tiles) {
+        const auto &tile_type = chip_info->tile_types[tile.type];
+        tile_wire_base.push_back(tile_wire_base.back() + tile_type.wire_data.ssize());
+        tile_pip_base.push_back(tile_pip_base.back() + tile_type.pip_data.ssize());
+    }
+
     // Sanity check cell name ids.
     const CellMapPOD &cell_map = *chip_info->cell_map;
     int32_t first_cell_id = cell_map.cell_names[0];
@@ -774,7 +783,7 @@ bool Arch::place()
 #endif
 
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
-    if (placer == "heap") {
+    if (placer == "heap" || placer == "static") {
         PlacerHeapCfg cfg(getCtx());
         cfg.criticalityExponent = 7;
         cfg.alpha = 0.08;
@@ -785,7 +794,8 @@ bool Arch::place()
         cfg.spread_scale_x = 2;
         cfg.spread_scale_y = 1;
         cfg.solverTolerance = 0.6e-6;
-        if (!placer_heap(getCtx(), cfg))
+        bool placed = (placer == "static") ? placer_static(getCtx(), cfg) : placer_heap(getCtx(), cfg);
+        if (!placed)
             return false;
     } else if (placer == "sa") {
         if (!placer1(getCtx(), Placer1Cfg(getCtx())))
@@ -1038,7 +1048,7 @@ const std::string Arch::defaultPlacer = "sa";
 
 const std::vector<std::string> Arch::availablePlacers = {"sa",
 #ifdef WITH_HEAP
-                                                         "heap"
+                                                         "heap", "static"
 #endif
 };
 
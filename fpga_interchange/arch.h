@@ -109,6 +109,10 @@ struct Arch : ArchAPI<ArchRanges>
     std::unordered_map<WireId, NetInfo *> wire_to_net;
     std::unordered_map<PipId, NetInfo *> pip_to_net;
 
+    // First dense wire and pip index for each tile. Node wires (tile == -1) come first, followed by all tile wires
+    // (including those that are part of a node, which are never used as a WireId)
+    std::vector<int> tile_wire_base, tile_pip_base;
+
     DedicatedInterconnect dedicated_interconnect;
     HashTables::HashMap<int32_t, TileStatus> tileStatus;
     PseudoPipData pseudo_pip_data;
@@ -413,6 +417,10 @@ struct Arch : ArchAPI<ArchRanges>
 
     const std::vector<IdString> &getBelPinsForCellPin(const CellInfo *cell_info, IdString pin) const final;
 
+    // Bel binding is kept per tile in tileStatus, so there are no dense bel indices
+    int getBelCount() const final { return 0; }
+    int getBelIndex(BelId bel) const final { NPNR_ASSERT_FALSE("dense bel indices not supported"); }
+
     // -------------------------------------------------
 
     WireId getWireByName(IdStringList name) const final;
@@ -484,6 +492,12 @@ struct Arch : ArchAPI<ArchRanges>
 
     DelayQuad getWireDelay(WireId wire) const final { return DelayQuad(0); }
 
+    int getWireCount() const final { return tile_wire_base.back(); }
+    int getWireIndex(WireId wire) const final
+    {
+        return wire.tile == -1 ? wire.index : (tile_wire_base[wire.tile] + wire.index);
+    }
+
     TileWireRange get_tile_wire_range(WireId wire) const
     {
         TileWireRange range;
@@ -610,6 +624,9 @@ struct Arch : ArchAPI<ArchRanges>
         return loc;
     }
 
+    int getPipCount() const final { return tile_pip_base.back(); }
+    int getPipIndex(PipId pip) const final { return tile_pip_base[pip.tile] + pip.index; }
+
     uint32_t getPipChecksum(PipId pip) const final { return pip.index; }
 
     WireId getPipSrcWire(PipId pip) const final NPNR_ALWAYS_INLINE
@@ -690,7 +690,7 @@ template <typename FrontendType> struct GenericFrontend
         // Combine users
         for (auto &usr : mergee->users) {
             usr.cell->ports[usr.port].net = base;
-            base->users.push_back(usr);
+            base->add_user(usr);
         }
         // Point aliases to the new net
         for (IdString alias : mergee->aliases) {
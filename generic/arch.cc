@@ -22,62 +22,75 @@
 #include "nextpnr.h"
 #include "placer1.h"
 #include "placer_heap.h"
+#include "placer_static.h"
 #include "router1.h"
 #include "router2.h"
 #include "util.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
-WireInfo &Arch::wire_info(IdStringList wire)
+WireId Arch::wire_by_name_checked(IdStringList wire) const
 {
-    auto w = wires.find(wire);
-    if (w == wires.end())
+    auto w = wire_by_name.find(wire);
+    if (w == wire_by_name.end())
         NPNR_ASSERT_FALSE_STR("no wire named " + wire.str(getCtx()));
     return w->second;
 }
 
-PipInfo &Arch::pip_info(IdStringList pip)
+PipId Arch::pip_by_name_checked(IdStringList pip) const
 {
-    auto p = pips.find(pip);
-    if (p == pips.end())
+    auto p = pip_by_name.find(pip);
+    if (p == pip_by_name.end())
         NPNR_ASSERT_FALSE_STR("no pip named " + pip.str(getCtx()));
     return p->second;
 }
 
-BelInfo &Arch::bel_info(IdStringList bel)
+BelId Arch::bel_by_name_checked(IdStringList bel) const
 {
-    auto b = bels.find(bel);
-    if (b == bels.end())
+    auto b = bel_by_name.find(bel);
+    if (b == bel_by_name.end())
         NPNR_ASSERT_FALSE_STR("no bel named " + bel.str(getCtx()));
     return b->second;
 }
 
+WireInfo &Arch::wire_info(IdStringList wire) { return wires.at(wire_by_name_checked(wire).index); }
+
+PipInfo &Arch::pip_info(IdStringList pip) { return pips.at(pip_by_name_checked(pip).index); }
+
+BelInfo &Arch::bel_info(IdStringList bel) { return bels.at(bel_by_name_checked(bel).index); }
+
 void Arch::addWire(IdStringList name, IdString type, int x, int y)
 {
-    NPNR_ASSERT(wires.count(name) == 0);
-    WireInfo &wi = wires[name];
+    NPNR_ASSERT(wire_by_name.count(name) == 0);
+    WireId wire(int32_t(wires.size()));
+    wire_by_name[name] = wire;
+    wires.emplace_back();
+    WireInfo &wi = wires.back();
     wi.name = name;
     wi.type = type;
     wi.x = x;
     wi.y = y;
 
-    wire_ids.push_back(name);
+    wire_ids.push_back(wire);
 }
 
 void Arch::addPip(IdStringList name, IdString type, IdStringList srcWire, IdStringList dstWire, delay_t delay, Loc loc)
 {
-    NPNR_ASSERT(pips.count(name) == 0);
-    PipInfo &pi = pips[name];
+    NPNR_ASSERT(pip_by_name.count(name) == 0);
+    PipId pip(int32_t(pips.size()));
+    pip_by_name[name] = pip;
+    pips.emplace_back();
+    PipInfo &pi = pips.back();
     pi.name = name;
     pi.type = type;
-    pi.srcWire = srcWire;
-    pi.dstWire = dstWire;
+    pi.srcWire = wire_by_name_checked(srcWire);
+    pi.dstWire = wire_by_name_checked(dstWire);
     pi.delay = delay;
     pi.loc = loc;
 
-    wire_info(srcWire).downhill.push_back(name);
-    wire_info(dstWire).uphill.push_back(name);
-    pip_ids.push_back(name);
+    wires.at(pi.srcWire.index).downhill.push_back(pip);
+    wires.at(pi.dstWire.index).uphill.push_back(pip);
+    pip_ids.push_back(pip);
 
     if (int(tilePipDimZ.size()) <= loc.x)
         tilePipDimZ.resize(loc.x + 1);
@@ -92,9 +105,12 @@ void Arch::addPip(IdStringList name, IdString type, IdStringList srcWire, IdStri
 
 void Arch::addBel(IdStringList name, IdString type, Loc loc, bool gb, bool hidden)
 {
-    NPNR_ASSERT(bels.count(name) == 0);
+    NPNR_ASSERT(bel_by_name.count(name) == 0);
     NPNR_ASSERT(bel_by_loc.count(loc) == 0);
-    BelInfo &bi = bels[name];
+    BelId bel(int32_t(bels.size()));
+    bel_by_name[name] = bel;
+    bels.emplace_back();
+    BelInfo &bi = bels.back();
     bi.name = name;
     bi.type = type;
     bi.x = loc.x;
@@ -103,8 +119,8 @@ void Arch::addBel(IdStringList name, IdString type, Loc loc, bool gb, bool hidde
     bi.gb = gb;
     bi.hidden = hidden;
 
-    bel_ids.push_back(name);
-    bel_by_loc[loc] = name;
+    bel_ids.push_back(bel);
+    bel_by_loc[loc] = bel;
 
     if (int(bels_by_tile.size()) <= loc.x)
         bels_by_tile.resize(loc.x + 1);
@@ -112,7 +128,7 @@ void Arch::addBel(IdStringList name, IdString type, Loc loc, bool gb, bool hidde
     if (int(bels_by_tile[loc.x].size()) <= loc.y)
         bels_by_tile[loc.x].resize(loc.y + 1);
 
-    bels_by_tile[loc.x][loc.y].push_back(name);
+    bels_by_tile[loc.x][loc.y].push_back(bel);
 
     if (int(tileBelDimZ.size()) <= loc.x)
         tileBelDimZ.resize(loc.x + 1);
@@ -127,45 +143,57 @@ void Arch::addBel(IdStringList name, IdString type, Loc loc, bool gb, bool hidde
 
 void Arch::addBelInput(IdStringList bel, IdString name, IdStringList wire)
 {
-    NPNR_ASSERT(bel_info(bel).pins.count(name) == 0);
-    PinInfo &pi = bel_info(bel).pins[name];
+    BelId bel_id = bel_by_name_checked(bel);
+    NPNR_ASSERT(bels.at(bel_id.index).pins.count(name) == 0);
+    PinInfo &pi = bels.at(bel_id.index).pins[name];
     pi.name = name;
-    pi.wire = wire;
+    pi.wire = wire_by_name_checked(wire);
     pi.type = PORT_IN;
 
-    wire_info(wire).downhill_bel_pins.push_back(BelPin{bel, name});
-    wire_info(wire).bel_pins.push_back(BelPin{bel, name});
+    wire_info(wire).downhill_bel_pins.push_back(BelPin{bel_id, name});
+    wire_info(wire).bel_pins.push_back(BelPin{bel_id, name});
 }
 
 void Arch::addBelOutput(IdStringList bel, IdString name, IdStringList wire)
 {
-    NPNR_ASSERT(bel_info(bel).pins.count(name) == 0);
-    PinInfo &pi = bel_info(bel).pins[name];
+    BelId bel_id = bel_by_name_checked(bel);
+    NPNR_ASSERT(bels.at(bel_id.index).pins.count(name) == 0);
+    PinInfo &pi = bels.at(bel_id.index).pins[name];
     pi.name = name;
-    pi.wire = wire;
+    pi.wire = wire_by_name_checked(wire);
     pi.type = PORT_OUT;
 
-    wire_info(wire).uphill_bel_pin = BelPin{bel, name};
-    wire_info(wire).bel_pins.push_back(BelPin{bel, name});
+    wire_info(wire).uphill_bel_pin = BelPin{bel_id, name};
+    wire_info(wire).bel_pins.push_back(BelPin{bel_id, name});
 }
 
 void Arch::addBelInout(IdStringList bel, IdString name, IdStringList wire)
 {
-    NPNR_ASSERT(bel_info(bel).pins.count(name) == 0);
-    PinInfo &pi = bel_info(bel).pins[name];
+    BelId bel_id = bel_by_name_checked(bel);
+    NPNR_ASSERT(bels.at(bel_id.index).pins.count(name) == 0);
+    PinInfo &pi = bels.at(bel_id.index).pins[name];
     pi.name = name;
-    pi.wire = wire;
+    pi.wire = wire_by_name_checked(wire);
     pi.type = PORT_INOUT;
 
-    wire_info(wire).downhill_bel_pins.push_back(BelPin{bel, name});
-    wire_info(wire).bel_pins.push_back(BelPin{bel, name});
+    wire_info(wire).downhill_bel_pins.push_back(BelPin{bel_id, name});
+    wire_info(wire).bel_pins.push_back(BelPin{bel_id, name});
 }
 
-void Arch::addGroupBel(IdStringList group, IdStringList bel) { groups[group].bels.push_back(bel); }
+void Arch::addGroupBel(IdStringList group, IdStringList bel)
+{
+    groups[group].bels.push_back(bel_by_name_checked(bel));
+}
 
-void Arch::addGroupWire(IdStringList group, IdStringList wire) { groups[group].wires.push_back(wire); }
+void Arch::addGroupWire(IdStringList group, IdStringList wire)
+{
+    groups[group].wires.push_back(wire_by_name_checked(wire));
+}
 
-void Arch::addGroupPip(IdStringList group, IdStringList pip) { groups[group].pips.push_back(pip); }
+void Arch::addGroupPip(IdStringList group, IdStringList pip)
+{
+    groups[group].pips.push_back(pip_by_name_checked(pip));
+}
 
 void Arch::addGroupGroup(IdStringList group, IdStringList grp) { groups[group].groups.push_back(grp); }
 
@@ -177,19 +205,19 @@ void Arch::addDecalGraphic(DecalId decal, const GraphicElement &graphic)
 
 void Arch::setWireDecal(WireId wire, DecalXY decalxy)
 {
-    wire_info(wire).decalxy = decalxy;
+    wires.at(wire.index).decalxy = decalxy;
     refreshUiWire(wire);
 }
 
 void Arch::setPipDecal(PipId pip, DecalXY decalxy)
 {
-    pip_info(pip).decalxy = decalxy;
+    pips.at(pip.index).decalxy = decalxy;
     refreshUiPip(pip);
 }
 
 void Arch::setBelDecal(BelId bel, DecalXY decalxy)
 {
-    bel_info(bel).decalxy = decalxy;
+    bels.at(bel.index).decalxy = decalxy;
     refreshUiBel(bel);
 }
 
@@ -268,16 +296,17 @@ void IdString::initialize_arch(const BaseCtx *ctx) {}
 
 BelId Arch::getBelByName(IdStringList name) const
 {
-    if (bels.count(name))
-        return name;
-    return BelId();
+    auto b = bel_by_name.find(name);
+    if (b == bel_by_name.end())
+        return BelId();
+    return b->second;
 }
 
-IdStringList Arch::getBelName(BelId bel) const { return bel; }
+IdStringList Arch::getBelName(BelId bel) const { return bels.at(bel.index).name; }
 
 Loc Arch::getBelLocation(BelId bel) const
 {
-    auto &info = bels.at(bel);
+    auto &info = bels.at(bel.index);
     return Loc(info.x, info.y, info.z);
 }
 
@@ -291,7 +320,7 @@ BelId Arch::getBelByLocation(Loc loc) const
 
 const std::vector<BelId> &Arch::getBelsByTile(int x, int y) const { return bels_by_tile.at(x).at(y); }
 
-bool Arch::getBelGlobalBuf(BelId bel) const { return bels.at(bel).gb; }
+bool Arch::getBelGlobalBuf(BelId bel) const { return bels.at(bel.index).gb; }
 
 uint32_t Arch::getBelChecksum(BelId bel) const
 {
@@ -301,7 +330,7 @@ uint32_t Arch::getBelChecksum(BelId bel) const
 
 void Arch::bindBel(BelId bel, CellInfo *cell, PlaceStrength strength)
 {
-    bels.at(bel).bound_cell = cell;
+    bels.at(bel.index).bound_cell = cell;
     cell->bel = bel;
     cell->belStrength = strength;
     refreshUiBel(bel);
@@ -309,40 +338,40 @@ void Arch::bindBel(BelId bel, CellInfo *cell, PlaceStrength strength)
 
 void Arch::unbindBel(BelId bel)
 {
-    bels.at(bel).bound_cell->bel = BelId();
-    bels.at(bel).bound_cell->belStrength = STRENGTH_NONE;
-    bels.at(bel).bound_cell = nullptr;
+    bels.at(bel.index).bound_cell->bel = BelId();
+    bels.at(bel.index).bound_cell->belStrength = STRENGTH_NONE;
+    bels.at(bel.index).bound_cell = nullptr;
     refreshUiBel(bel);
 }
 
-bool Arch::checkBelAvail(BelId bel) const { return bels.at(bel).bound_cell == nullptr; }
+bool Arch::checkBelAvail(BelId bel) const { return bels.at(bel.index).bound_cell == nullptr; }
 
-CellInfo *Arch::getBoundBelCell(BelId bel) const { return bels.at(bel).bound_cell; }
+CellInfo *Arch::getBoundBelCell(BelId bel) const { return bels.at(bel.index).bound_cell; }
 
-CellInfo *Arch::getConflictingBelCell(BelId bel) const { return bels.at(bel).bound_cell; }
+CellInfo *Arch::getConflictingBelCell(BelId bel) const { return bels.at(bel.index).bound_cell; }
 
 const std::vector<BelId> &Arch::getBels() const { return bel_ids; }
 
-IdString Arch::getBelType(BelId bel) const { return bels.at(bel).type; }
+IdString Arch::getBelType(BelId bel) const { return bels.at(bel.index).type; }
 
-bool Arch::getBelHidden(BelId bel) const { return bels.at(bel).hidden; }
+bool Arch::getBelHidden(BelId bel) const { return bels.at(bel.index).hidden; }
 
-const std::map<IdString, std::string> &Arch::getBelAttrs(BelId bel) const { return bels.at(bel).attrs; }
+const std::map<IdString, std::string> &Arch::getBelAttrs(BelId bel) const { return bels.at(bel.index).attrs; }
 
 WireId Arch::getBelPinWire(BelId bel, IdString pin) const
 {
-    const auto &bdata = bels.at(bel);
+    const auto &bdata = bels.at(bel.index);
     if (!bdata.pins.count(pin))
         log_error("bel '%s' has no pin '%s'\n", getCtx()->nameOfBel(bel), pin.c_str(this));
     return bdata.pins.at(pin).wire;
 }
 
-PortType Arch::getBelPinType(BelId bel, IdString pin) const { return bels.at(bel).pins.at(pin).type; }
+PortType Arch::getBelPinType(BelId bel, IdString pin) const { return bels.at(bel.index).pins.at(pin).type; }
 
 std::vector<IdString> Arch::getBelPins(BelId bel) const
 {
     std::vector<IdString> ret;
-    for (auto &it : bels.at(bel).pins)
+    for (auto &it : bels.at(bel.index).pins)
         ret.push_back(it.first);
     return ret;
 }
@@ -356,16 +385,17 @@ const std::vector<IdString> &Arch::getBelPinsForCellPin(const CellInfo *cell_inf
 
 WireId Arch::getWireByName(IdStringList name) const
 {
-    if (wires.count(name))
-        return name;
-    return WireId();
+    auto w = wire_by_name.find(name);
+    if (w == wire_by_name.end())
+        return WireId();
+    return w->second;
 }
 
-IdStringList Arch::getWireName(WireId wire) const { return wire; }
+IdStringList Arch::getWireName(WireId wire) const { return wires.at(wire.index).name; }
 
-IdString Arch::getWireType(WireId wire) const { return wires.at(wire).type; }
+IdString Arch::getWireType(WireId wire) const { return wires.at(wire.index).type; }
 
-const std::map<IdString, std::string> &Arch::getWireAttrs(WireId wire) const { return wires.at(wire).attrs; }
+const std::map<IdString, std::string> &Arch::getWireAttrs(WireId wire) const { return wires.at(wire.index).attrs; }
 
 uint32_t Arch::getWireChecksum(WireId wire) const
 {
@@ -375,7 +405,7 @@ uint32_t Arch::getWireChecksum(WireId wire) const
 
 void Arch::bindWire(WireId wire, NetInfo *net, PlaceStrength strength)
 {
-    wires.at(wire).bound_net = net;
+    wires.at(wire.index).bound_net = net;
     net->wires[wire].pip = PipId();
     net->wires[wire].strength = strength;
     refreshUiWire(wire);
@@ -383,26 +413,26 @@ void Arch::bindWire(WireId wire, NetInfo *net, PlaceStrength strength)
 
 void Arch::unbindWire(WireId wire)
 {
-    auto &net_wires = wires.at(wire).bound_net->wires;
+    auto &net_wires = wires.at(wire.index).bound_net->wires;
 
     auto pip = net_wires.at(wire).pip;
     if (pip != PipId()) {
-        pips.at(pip).bound_net = nullptr;
+        pips.at(pip.index).bound_net = nullptr;
         refreshUiPip(pip);
     }
 
     net_wires.erase(wire);
-    wires.at(wire).bound_net = nullptr;
+    wires.at(wire.index).bound_net = nullptr;
     refreshUiWire(wire);
 }
 
-bool Arch::checkWireAvail(WireId wire) const { return wires.at(wire).bound_net == nullptr; }
+bool Arch::checkWireAvail(WireId wire) const { return wires.at(wire.index).bound_net == nullptr; }
 
-NetInfo *Arch::getBoundWireNet(WireId wire) const { return wires.at(wire).bound_net; }
+NetInfo *Arch::getBoundWireNet(WireId wire) const { return wires.at(wire.index).bound_net; }
 
-NetInfo *Arch::getConflictingWireNet(WireId wire) const { return wires.at(wire).bound_net; }
+NetInfo *Arch::getConflictingWireNet(WireId wire) const { return wires.at(wire.index).bound_net; }
 
-const std::vector<BelPin> &Arch::getWireBelPins(WireId wire) const { return wires.at(wire).bel_pins; }
+const std::vector<BelPin> &Arch::getWireBelPins(WireId wire) const { return wires.at(wire.index).bel_pins; }
 
 const std::vector<WireId> &Arch::getWires() const { return wire_ids; }
 
@@ -410,16 +440,17 @@ const std::vector<WireId> &Arch::getWires() const { return wire_ids; }
 
 PipId Arch::getPipByName(IdStringList name) const
 {
-    if (pips.count(name))
-        return name;
-    return PipId();
+    auto p = pip_by_name.find(name);
+    if (p == pip_by_name.end())
+        return PipId();
+    return p->second;
 }
 
-IdStringList Arch::getPipName(PipId pip) const { return pip; }
+IdStringList Arch::getPipName(PipId pip) const { return pips.at(pip.index).name; }
 
-IdString Arch::getPipType(PipId pip) const { return pips.at(pip).type; }
+IdString Arch::getPipType(PipId pip) const { return pips.at(pip.index).type; }
 
-const std::map<IdString, std::string> &Arch::getPipAttrs(PipId pip) const { return pips.at(pip).attrs; }
+const std::map<IdString, std::string> &Arch::getPipAttrs(PipId pip) const { return pips.at(pip.index).attrs; }
 
 uint32_t Arch::getPipChecksum(PipId wire) const
 {
@@ -429,9 +460,9 @@ uint32_t Arch::getPipChecksum(PipId wire) const
 
 void Arch::bindPip(PipId pip, NetInfo *net, PlaceStrength strength)
 {
-    WireId wire = pips.at(pip).dstWire;
-    pips.at(pip).bound_net = net;
-    wires.at(wire).bound_net = net;
+    WireId wire = pips.at(pip.index).dstWire;
+    pips.at(pip.index).bound_net = net;
+    wires.at(wire.index).bound_net = net;
     net->wires[wire].pip = pip;
     net->wires[wire].strength = strength;
     refreshUiPip(pip);
@@ -440,41 +471,41 @@ void Arch::bindPip(PipId pip, NetInfo *net, PlaceStrength strength)
 
 void Arch::unbindPip(PipId pip)
 {
-    WireId wire = pips.at(pip).dstWire;
-    wires.at(wire).bound_net->wires.erase(wire);
-    pips.at(pip).bound_net = nullptr;
-    wires.at(wire).bound_net = nullptr;
+    WireId wire = pips.at(pip.index).dstWire;
+    wires.at(wire.index).bound_net->wires.erase(wire);
+    pips.at(pip.index).bound_net = nullptr;
+    wires.at(wire.index).bound_net = nullptr;
     refreshUiPip(pip);
     refreshUiWire(wire);
 }
 
-bool Arch::checkPipAvail(PipId pip) const { return pips.at(pip).bound_net == nullptr; }
+bool Arch::checkPipAvail(PipId pip) const { return pips.at(pip.index).bound_net == nullptr; }
 
 bool Arch::checkPipAvailForNet(PipId pip, NetInfo *net) const
 {
-    NetInfo *bound_net = pips.at(pip).bound_net;
+    NetInfo *bound_net = pips.at(pip.index).bound_net;
     return bound_net == nullptr || bound_net == net;
 }
 
-NetInfo *Arch::getBoundPipNet(PipId pip) const { return pips.at(pip).bound_net; }
+NetInfo *Arch::getBoundPipNet(PipId pip) const { return pips.at(pip.index).bound_net; }
 
-NetInfo *Arch::getConflictingPipNet(PipId pip) const { return pips.at(pip).bound_net; }
+NetInfo *Arch::getConflictingPipNet(PipId pip) const { return pips.at(pip.index).bound_net; }
 
-WireId Arch::getConflictingPipWire(PipId pip) const { return pips.at(pip).bound_net ? pips.at(pip).dstWire : WireId(); }
+WireId Arch::getConflictingPipWire(PipId pip) const { return pips.at(pip.index).bound_net ? pips.at(pip.index).dstWire : WireId(); }
 
 const std::vector<PipId> &Arch::getPips() const { return pip_ids; }
 
-Loc Arch::getPipLocation(PipId pip) const { return pips.at(pip).loc; }
+Loc Arch::getPipLocation(PipId pip) const { return pips.at(pip.index).loc; }
 
-WireId Arch::getPipSrcWire(PipId pip) const { return pips.at(pip).srcWire; }
+WireId Arch::getPipSrcWire(PipId pip) const { return pips.at(pip.index).srcWire; }
 
-WireId Arch::getPipDstWire(PipId pip) const { return pips.at(pip).dstWire; }
+WireId Arch::getPipDstWire(PipId pip) const { return pips.at(pip.index).dstWire; }
 
-DelayQuad Arch::getPipDelay(PipId pip) const { return DelayQuad(pips.at(pip).delay); }
+DelayQuad Arch::getPipDelay(PipId pip) const { return DelayQuad(pips.at(pip.index).delay); }
 
-const std::vector<PipId> &Arch::getPipsDownhill(WireId wire) const { return wires.at(wire).downhill; }
+const std::vector<PipId> &Arch::getPipsDownhill(WireId wire) const { return wires.at(wire.index).downhill; }
 
-const std::vector<PipId> &Arch::getPipsUphill(WireId wire) const { return wires.at(wire).uphill; }
+const std::vector<PipId> &Arch::getPipsUphill(WireId wire) const { return wires.at(wire.index).uphill; }
 
 // ---------------------------------------------------------------
 
@@ -502,8 +533,8 @@ const std::vector<GroupId> &Arch::getGroupGroups(GroupId group) const { return g
 
 delay_t Arch::estimateDelay(WireId src, WireId dst) const
 {
-    const WireInfo &s = wires.at(src);
-    const WireInfo &d = wires.at(dst);
+    const WireInfo &s = wires.at(src.index);
+    const WireInfo &d = wires.at(dst.index);
     int dx = abs(s.x - d.x);
     int dy = abs(s.y - d.y);
     return (dx + dy) * args.delayScale + args.delayOffset;
@@ -526,10 +557,10 @@ ArcBounds Arch::getRouteBoundingBox(WireId src, WireId dst) const
 {
     ArcBounds bb;
 
-    int src_x = wires.at(src).x;
-    int src_y = wires.at(src).y;
-    int dst_x = wires.at(dst).x;
-    int dst_y = wires.at(dst).y;
+    int src_x = wires.at(src.index).x;
+    int src_y = wires.at(src.index).y;
+    int dst_x = wires.at(dst.index).x;
+    int dst_y = wires.at(dst.index).y;
 
     bb.x0 = src_x;
     bb.y0 = src_y;
@@ -551,7 +582,7 @@ ArcBounds Arch::getRouteBoundingBox(WireId src, WireId dst) const
 bool Arch::place()
 {
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
-    if (placer == "heap") {
+    if (placer == "heap" || placer == "static") {
         bool have_iobuf_or_constr = false;
         for (auto cell : sorted(cells)) {
             CellInfo *ci = cell.second;
@@ -568,7 +599,7 @@ bool Arch::place()
         } else {
             PlacerHeapCfg cfg(getCtx());
             cfg.ioBufTypes.insert(id("GENERIC_IOB"));
-            retVal = placer_heap(getCtx(), cfg);
+            retVal = (placer == "static") ? placer_static(getCtx(), cfg) : placer_heap(getCtx(), cfg);
         }
         getCtx()->settings[getCtx()->id("place")] = 1;
         archInfoToAttributes();
@@ -610,11 +641,11 @@ const std::vector<GraphicElement> &Arch::getDecalGraphics(DecalId decal) const
     return decal_graphics.at(decal);
 }
 
-DecalXY Arch::getBelDecal(BelId bel) const { return bels.at(bel).decalxy; }
+DecalXY Arch::getBelDecal(BelId bel) const { return bels.at(bel.index).decalxy; }
 
-DecalXY Arch::getWireDecal(WireId wire) const { return wires.at(wire).decalxy; }
+DecalXY Arch::getWireDecal(WireId wire) const { return wires.at(wire.index).decalxy; }
 
-DecalXY Arch::getPipDecal(PipId pip) const { return pips.at(pip).decalxy; }
+DecalXY Arch::getPipDecal(PipId pip) const { return pips.at(pip.index).decalxy; }
 
 DecalXY Arch::getGroupDecal(GroupId group) const { return groups.at(group).decalxy; }
 
@@ -675,7 +706,7 @@ const std::string Arch::defaultPlacer = "sa";
 
 const std::vector<std::string> Arch::availablePlacers = {"sa",
 #ifdef WITH_HEAP
-                                                         "heap"
+                                                         "heap", "static"
 #endif
 };
 
@@ -160,17 +160,28 @@ struct Arch : ArchAPI<ArchRanges>
 {
     std::string chipName;
 
-    std::unordered_map<IdStringList, WireInfo> wires;
-    std::unordered_map<IdStringList, PipInfo> pips;
-    std::unordered_map<IdStringList, BelInfo> bels;
+    // Indexed by the index of the BelId, WireId or PipId. The bound cell or net is kept in each entry, so binding is
+    // already a direct array access and the arch doesn't need the BaseArch bind tables
+    std::vector<WireInfo> wires;
+    std::vector<PipInfo> pips;
+    std::vector<BelInfo> bels;
     std::unordered_map<GroupId, GroupInfo> groups;
 
+    std::unordered_map<IdStringList, WireId> wire_by_name;
+    std::unordered_map<IdStringList, PipId> pip_by_name;
+    std::unordered_map<IdStringList, BelId> bel_by_name;
+
     // These functions include useful errors if not found
     WireInfo &wire_info(IdStringList wire);
-    PipInfo &pip_info(IdStringList wire);
-    BelInfo &bel_info(IdStringList wire);
+    PipInfo &pip_info(IdStringList pip);
+    BelInfo &bel_info(IdStringList bel);
+    WireId wire_by_name_checked(IdStringList wire) const;
+    BelId bel_by_name_checked(IdStringList bel) const;
+    PipId pip_by_name_checked(IdStringList pip) const;
 
-    std::vector<IdStringList> bel_ids, wire_ids, pip_ids;
+    std::vector<BelId> bel_ids;
+    std::vector<WireId> wire_ids;
+    std::vector<PipId> pip_ids;
 
     std::unordered_map<Loc, BelId> bel_by_loc;
     std::vector<std::vector<std::vector<BelId>>> bels_by_tile;
@@ -255,6 +266,8 @@ struct Arch : ArchAPI<ArchRanges>
     PortType getBelPinType(BelId bel, IdString pin) const override;
     std::vector<IdString> getBelPins(BelId bel) const override;
     const std::vector<IdString> &getBelPinsForCellPin(const CellInfo *cell_info, IdString pin) const override;
+    int getBelCount() const override { return int(bel_ids.size()); }
+    int getBelIndex(BelId bel) const override { return bel.index; }
 
     WireId getWireByName(IdStringList name) const override;
     IdStringList getWireName(WireId wire) const override;
@@ -269,6 +282,8 @@ struct Arch : ArchAPI<ArchRanges>
     NetInfo *getConflictingWireNet(WireId wire) const override;
     DelayQuad getWireDelay(WireId wire) const override { return DelayQuad(0); }
     const std::vector<WireId> &getWires() const override;
+    int getWireCount() const override { return int(wire_ids.size()); }
+    int getWireIndex(WireId wire) const override { return wire.index; }
     const std::vector<BelPin> &getWireBelPins(WireId wire) const override;
 
     PipId getPipByName(IdStringList name) const override;
@@ -285,6 +300,8 @@ struct Arch : ArchAPI<ArchRanges>
     NetInfo *getConflictingPipNet(PipId pip) const override;
     const std::vector<PipId> &getPips() const override;
     Loc getPipLocation(PipId pip) const override;
+    int getPipCount() const override { return int(pip_ids.size()); }
+    int getPipIndex(PipId pip) const override { return pip.index; }
     WireId getPipSrcWire(PipId pip) const override;
     WireId getPipDstWire(PipId pip) const override;
     DelayQuad getPipDelay(PipId pip) const override;
@@ -319,8 +336,8 @@ struct Arch : ArchAPI<ArchRanges>
     std::vector<IdString> getCellTypes() const override
     {
         std::unordered_set<IdString> cell_types;
-        for (auto bel : bels) {
-            cell_types.insert(bel.second.type);
+        for (auto &bel : bels) {
+            cell_types.insert(bel.type);
         }
 
         return std::vector<IdString>{cell_types.begin(), cell_types.end()};
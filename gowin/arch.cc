@@ -25,6 +25,7 @@
 #include "nextpnr.h"
 #include "placer1.h"
 #include "placer_heap.h"
+#include "placer_static.h"
 #include "router1.h"
 #include "router2.h"
 #include "util.h"
@@ -1007,7 +1008,7 @@ ArcBounds Arch::getRouteBoundingBox(WireId src, WireId dst) const
 bool Arch::place()
 {
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
-    if (placer == "heap") {
+    if (placer == "heap" || placer == "static") {
         bool have_iobuf_or_constr = false;
         for (auto cell : sorted(cells)) {
             CellInfo *ci = cell.second;
@@ -1025,7 +1026,7 @@ bool Arch::place()
             PlacerHeapCfg cfg(getCtx());
             cfg.ioBufTypes.insert(id("IOB"));
             cfg.beta = 0.5;
-            retVal = placer_heap(getCtx(), cfg);
+            retVal = (placer == "static") ? placer_static(getCtx(), cfg) : placer_heap(getCtx(), cfg);
         }
         getCtx()->settings[getCtx()->id("place")] = 1;
         archInfoToAttributes();
@@ -1114,7 +1115,7 @@ const std::string Arch::defaultPlacer = "sa";
 
 const std::vector<std::string> Arch::availablePlacers = {"sa",
 #ifdef WITH_HEAP
-                                                         "heap"
+                                                         "heap", "static"
 #endif
 };
 
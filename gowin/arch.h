@@ -287,6 +287,8 @@ struct Arch : BaseArch<ArchRanges>
     const PackagePOD *package;
     const TimingGroupsPOD *speed;
 
+    // Bels, wires and pips are identified by name and created at runtime without dense indices, so bound objects are
+    // kept in these entries, found by the same lookup as everything else about them, rather than in a BaseArch table
     std::unordered_map<IdString, WireInfo> wires;
     std::unordered_map<IdString, PipInfo> pips;
     std::unordered_map<IdString, BelInfo> bels;
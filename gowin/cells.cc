@@ -35,7 +35,7 @@ void add_port(const Context *ctx, CellInfo *cell, IdString id, PortType dir)
 std::unique_ptr<CellInfo> create_generic_cell(Context *ctx, IdString type, std::string name)
 {
     static int auto_idx = 0;
-    std::unique_ptr<CellInfo> new_cell = std::unique_ptr<CellInfo>(new CellInfo());
+    std::unique_ptr<CellInfo> new_cell = std::unique_ptr<CellInfo>(new (ctx) CellInfo());
     if (name.empty()) {
         new_cell->name = ctx->id("$nextpnr_" + type.str(ctx) + "_" + std::to_string(auto_idx++));
     } else {
@@ -27,6 +27,7 @@
 #include "nextpnr.h"
 #include "placer1.h"
 #include "placer_heap.h"
+#include "placer_static.h"
 #include "router1.h"
 #include "router2.h"
 #include "timing_opt.h"
@@ -683,10 +684,11 @@ bool Arch::getBudgetOverride(const NetInfo *net_info, const PortRef &sink, delay
 bool Arch::place()
 {
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
-    if (placer == "heap") {
+    if (placer == "heap" || placer == "static") {
         PlacerHeapCfg cfg(getCtx());
         cfg.ioBufTypes.insert(id_SB_IO);
-        if (!placer_heap(getCtx(), cfg))
+        bool placed = (placer == "static") ? placer_static(getCtx(), cfg) : placer_heap(getCtx(), cfg);
+        if (!placed)
             return false;
     } else if (placer == "sa") {
         if (!placer1(getCtx(), Placer1Cfg(getCtx())))
@@ -708,6 +710,8 @@ bool Arch::place()
 bool Arch::route()
 {
     std::string router = str_or_default(settings, id("router"), defaultRouter);
+    if (bool_or_default(settings, id("router/lookahead")))
+        lookahead.init(getCtx());
     bool result;
     if (router == "router1") {
         result = router1(getCtx(), Router1Cfg(getCtx()));
@@ -1274,7 +1278,7 @@ const std::string Arch::defaultPlacer = "sa";
 
 const std::vector<std::string> Arch::availablePlacers = {"sa",
 #ifdef WITH_HEAP
-                                                         "heap"
+                                                         "heap", "static"
 #endif
 };
 
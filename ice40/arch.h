@@ -26,6 +26,7 @@
 #include "nextpnr_namespaces.h"
 #include "nextpnr_types.h"
 #include "relptr.h"
+#include "router_lookahead.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -406,6 +407,7 @@ struct Arch : BaseArch<ArchRanges>
     mutable std::unordered_map<Loc, int> bel_by_loc;
 
     std::vector<bool> bel_carry;
+    // Bound objects by dense index; ice40 binds everything itself, as binding a pip also tracks its switch
     std::vector<CellInfo *> bel_to_cell;
     std::vector<NetInfo *> wire_to_net;
     std::vector<NetInfo *> pip_to_net;
@@ -523,6 +525,9 @@ struct Arch : BaseArch<ArchRanges>
     PortType getBelPinType(BelId bel, IdString pin) const override;
     std::vector<IdString> getBelPins(BelId bel) const override;
 
+    int getBelCount() const override { return chip_info->bel_data.ssize(); }
+    int getBelIndex(BelId bel) const override { return bel.index; }
+
     bool is_bel_locked(BelId bel) const;
 
     // -------------------------------------------------
@@ -591,6 +596,9 @@ struct Arch : BaseArch<ArchRanges>
             return DelayQuad(chip_info->wire_data[wire.index].slow_delay);
     }
 
+    int getWireCount() const override { return chip_info->wire_data.ssize(); }
+    int getWireIndex(WireId wire) const override { return wire.index; }
+
     BelPinRange getWireBelPins(WireId wire) const override
     {
         BelPinRange range;
@@ -720,6 +728,9 @@ struct Arch : BaseArch<ArchRanges>
         return loc;
     }
 
+    int getPipCount() const override { return chip_info->pip_data.ssize(); }
+    int getPipIndex(PipId pip) const override { return pip.index; }
+
     IdStringList getPipName(PipId pip) const override;
 
     IdString getPipType(PipId pip) const override;
@@ -784,6 +795,8 @@ struct Arch : BaseArch<ArchRanges>
     // -------------------------------------------------
 
     delay_t estimateDelay(WireId src, WireId dst) const override;
+    // Precomputed lookahead used by estimateDelay, if enabled with the router/lookahead setting
+    RouterLookahead lookahead;
     delay_t predictDelay(const NetInfo *net_info, const PortRef &sink) const override;
     delay_t getDelayEpsilon() const override { return 20; }
     delay_t getRipupDelayPenalty() const override { return 200; }
@@ -979,7 +979,7 @@ void read_config(Context *ctx, std::istream &in, chipconfig_t &config)
                 IdString netName = ctx->id(name);
 
                 if (ctx->nets.find(netName) == ctx->nets.end()) {
-                    std::unique_ptr<NetInfo> created_net = std::unique_ptr<NetInfo>(new NetInfo);
+                    std::unique_ptr<NetInfo> created_net = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
                     created_net->name = netName;
                     ctx->nets[netName] = std::move(created_net);
                 }
@@ -1148,7 +1148,7 @@ bool read_asc(Context *ctx, std::istream &in)
                             if (port.second.type == PORT_OUT)
                                 net->driver = ref;
                             else
-                                net->users.push_back(ref);
+                                net->add_user(ref);
                         }
                     }
                 }
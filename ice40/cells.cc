@@ -36,7 +36,7 @@ void add_port(const Context *ctx, CellInfo *cell, std::string name, PortType dir
 std::unique_ptr<CellInfo> create_ice_cell(Context *ctx, IdString type, std::string name)
 {
     static int auto_idx = 0;
-    std::unique_ptr<CellInfo> new_cell = std::unique_ptr<CellInfo>(new CellInfo());
+    std::unique_ptr<CellInfo> new_cell = std::unique_ptr<CellInfo>(new (ctx) CellInfo());
     if (name.empty()) {
         new_cell->name = ctx->id("$nextpnr_" + type.str(ctx) + "_" + std::to_string(auto_idx++));
     } else {
@@ -459,7 +459,7 @@ void nxio_to_sb(Context *ctx, CellInfo *nxio, CellInfo *sbio, std::unordered_set
     if (ctx->ports.count(nxio->name)) {
         IdString tn_netname = nxio->name;
         NPNR_ASSERT(!ctx->nets.count(tn_netname));
-        std::unique_ptr<NetInfo> toplevel_net{new NetInfo};
+        std::unique_ptr<NetInfo> toplevel_net{new (ctx) NetInfo};
         toplevel_net->name = tn_netname;
         connect_port(ctx, toplevel_net.get(), sbio, ctx->id("PACKAGE_PIN"));
         ctx->ports[nxio->name].net = toplevel_net.get();
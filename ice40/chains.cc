@@ -114,13 +114,13 @@ class ChainConstrainer
         lc->params[ctx->id("LUT_INIT")] = Property(65280, 16); // 0xff00: O = I3
         lc->params[ctx->id("CARRY_ENABLE")] = Property::State::S1;
         lc->ports.at(id_O).net = cout_port.net;
-        std::unique_ptr<NetInfo> co_i3_net(new NetInfo());
+        std::unique_ptr<NetInfo> co_i3_net(new (ctx) NetInfo());
         co_i3_net->name = ctx->id(lc->name.str(ctx) + "$I3");
         co_i3_net->driver = cout_port.net->driver;
         PortRef i3_r;
         i3_r.port = id_I3;
         i3_r.cell = lc.get();
-        co_i3_net->users.push_back(i3_r);
+        co_i3_net->add_user(i3_r);
         PortRef o_r;
         o_r.port = id_O;
         o_r.cell = lc.get();
@@ -134,7 +134,7 @@ class ChainConstrainer
 
         // If COUT also connects to a CIN; preserve the carry chain
         if (cin_cell) {
-            std::unique_ptr<NetInfo> co_cin_net(new NetInfo());
+            std::unique_ptr<NetInfo> co_cin_net(new (ctx) NetInfo());
             co_cin_net->name = ctx->id(lc->name.str(ctx) + "$COUT");
 
             // Connect I1 to 1 to preserve carry chain
@@ -143,7 +143,7 @@ class ChainConstrainer
             PortRef i1_r;
             i1_r.port = id_I1;
             i1_r.cell = lc.get();
-            vcc->users.push_back(i1_r);
+            vcc->add_user(i1_r);
 
             // Connect co_cin_net to the COUT of the LC
             PortRef co_r;
@@ -164,8 +164,9 @@ class ChainConstrainer
                 auto fnd_user = std::find_if(usr.begin(), usr.end(),
                                              [&](const PortRef &pr) { return pr.cell == cin_cell && pr.port == port; });
                 if (fnd_user != usr.end()) {
-                    co_cin_net->users.push_back(*fnd_user);
+                    co_cin_net->add_user(*fnd_user);
                     usr.erase(fnd_user);
+                    lc->ports.at(id_O).net->refresh_user_idx();
                     cin_cell->ports.at(port).net = co_cin_net.get();
                     ++replaced_ports;
                 }
@@ -191,17 +192,16 @@ class ChainConstrainer
         lc->params[ctx->id("CIN_CONST")] = Property::State::S1;
         lc->params[ctx->id("CIN_SET")] = Property::State::S1;
         lc->ports.at(ctx->id("I1")).net = cin_port.net;
-        cin_port.net->users.erase(std::remove_if(cin_port.net->users.begin(), cin_port.net->users.end(),
-                                                 [cin_cell, cin_port](const PortRef &usr) {
-                                                     return usr.cell == cin_cell && usr.port == cin_port.name;
-                                                 }));
+        cin_port.net->remove_users_if([cin_cell, cin_port](const PortRef &usr) {
+            return usr.cell == cin_cell && usr.port == cin_port.name;
+        });
 
         PortRef i1_ref;
         i1_ref.cell = lc.get();
         i1_ref.port = ctx->id("I1");
-        lc->ports.at(ctx->id("I1")).net->users.push_back(i1_ref);
+        lc->ports.at(ctx->id("I1")).net->add_user(i1_ref);
 
-        std::unique_ptr<NetInfo> out_net(new NetInfo());
+        std::unique_ptr<NetInfo> out_net(new (ctx) NetInfo());
         out_net->name = ctx->id(lc->name.str(ctx) + "$O");
 
         PortRef drv_ref;
@@ -213,7 +213,7 @@ class ChainConstrainer
         PortRef usr_ref;
         usr_ref.port = cin_port.name;
         usr_ref.cell = cin_cell;
-        out_net->users.push_back(usr_ref);
+        out_net->add_user(usr_ref);
         cin_cell->ports.at(cin_port.name).net = out_net.get();
 
         IdString out_net_name = out_net->name;
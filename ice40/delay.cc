@@ -152,6 +152,10 @@ struct model_params_t
 delay_t Arch::estimateDelay(WireId src, WireId dst) const
 {
     NPNR_ASSERT(src != WireId());
+    delay_t lookahead_delay;
+    if (lookahead.estimateDelay(getWireIndex(src), getWireIndex(dst), lookahead_delay))
+        return lookahead_delay;
+
     int x1 = chip_info->wire_data[src.index].x;
     int y1 = chip_info->wire_data[src.index].y;
     int z1 = chip_info->wire_data[src.index].z;
@@ -212,14 +212,14 @@ static void pack_carries(Context *ctx)
                     PortRef pr;
                     pr.cell = created_lc.get();
                     pr.port = ctx->id("I1");
-                    i0_net->users.push_back(pr);
+                    i0_net->add_user(pr);
                 }
                 created_lc->ports.at(ctx->id("I2")).net = i1_net;
                 if (i1_net) {
                     PortRef pr;
                     pr.cell = created_lc.get();
                     pr.port = ctx->id("I2");
-                    i1_net->users.push_back(pr);
+                    i1_net->add_user(pr);
                 }
                 new_cells.push_back(std::move(created_lc));
                 ++carry_only;
@@ -228,16 +228,12 @@ static void pack_carries(Context *ctx)
             replace_port(ci, ctx->id("CI"), carry_lc, ctx->id("CIN"));
             replace_port(ci, ctx->id("CO"), carry_lc, ctx->id("COUT"));
             if (i0_net) {
-                auto &i0_usrs = i0_net->users;
-                i0_usrs.erase(std::remove_if(i0_usrs.begin(), i0_usrs.end(), [ci, ctx](const PortRef &pr) {
-                    return pr.cell == ci && pr.port == ctx->id("I0");
-                }));
+                i0_net->remove_users_if(
+                        [ci, ctx](const PortRef &pr) { return pr.cell == ci && pr.port == ctx->id("I0"); });
             }
             if (i1_net) {
-                auto &i1_usrs = i1_net->users;
-                i1_usrs.erase(std::remove_if(i1_usrs.begin(), i1_usrs.end(), [ci, ctx](const PortRef &pr) {
-                    return pr.cell == ci && pr.port == ctx->id("I1");
-                }));
+                i1_net->remove_users_if(
+                        [ci, ctx](const PortRef &pr) { return pr.cell == ci && pr.port == ctx->id("I1"); });
             }
 
             // Check for constant driver on CIN
@@ -248,11 +244,9 @@ static void pack_carries(Context *ctx)
                     carry_lc->params[ctx->id("CIN_SET")] =
                             cin_net == ctx->id("$PACKER_VCC_NET") ? Property::State::S1 : Property::State::S0;
                     carry_lc->ports.at(ctx->id("CIN")).net = nullptr;
-                    auto &cin_users = ctx->nets.at(cin_net)->users;
-                    cin_users.erase(
-                            std::remove_if(cin_users.begin(), cin_users.end(), [carry_lc, ctx](const PortRef &pr) {
-                                return pr.cell == carry_lc && pr.port == ctx->id("CIN");
-                            }));
+                    ctx->nets.at(cin_net)->remove_users_if([carry_lc, ctx](const PortRef &pr) {
+                        return pr.cell == carry_lc && pr.port == ctx->id("CIN");
+                    });
                 }
             }
             exhausted_cells.insert(carry_lc->name);
@@ -337,7 +331,7 @@ static void set_net_constant(const Context *ctx, NetInfo *orig, NetInfo *constne
                 uc->ports[user.port].net = nullptr;
             } else {
                 uc->ports[user.port].net = constnet;
-                constnet->users.push_back(user);
+                constnet->add_user(user);
             }
         }
     }
@@ -351,7 +345,7 @@ static void pack_constants(Context *ctx)
 
     std::unique_ptr<CellInfo> gnd_cell = create_ice_cell(ctx, ctx->id("ICESTORM_LC"), "$PACKER_GND");
     gnd_cell->params[ctx->id("LUT_INIT")] = Property(0, 16);
-    std::unique_ptr<NetInfo> gnd_net = std::unique_ptr<NetInfo>(new NetInfo);
+    std::unique_ptr<NetInfo> gnd_net = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
     gnd_net->name = ctx->id("$PACKER_GND_NET");
     gnd_net->driver.cell = gnd_cell.get();
     gnd_net->driver.port = ctx->id("O");
@@ -364,7 +358,7 @@ static void pack_constants(Context *ctx)
 
     std::unique_ptr<CellInfo> vcc_cell = create_ice_cell(ctx, ctx->id("ICESTORM_LC"), "$PACKER_VCC");
     vcc_cell->params[ctx->id("LUT_INIT")] = Property(1, 16);
-    std::unique_ptr<NetInfo> vcc_net = std::unique_ptr<NetInfo>(new NetInfo);
+    std::unique_ptr<NetInfo> vcc_net = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
     vcc_net->name = ctx->id("$PACKER_VCC_NET");
     vcc_net->driver.cell = vcc_cell.get();
     vcc_net->driver.port = ctx->id("O");
@@ -598,11 +592,11 @@ static void insert_global(Context *ctx, NetInfo *net, bool is_reset, bool is_cen
     PortRef pr;
     pr.cell = gb.get();
     pr.port = ctx->id("USER_SIGNAL_TO_GLOBAL_BUFFER");
-    net->users.push_back(pr);
+    net->add_user(pr);
 
     pr.cell = gb.get();
     pr.port = ctx->id("GLOBAL_BUFFER_OUTPUT");
-    std::unique_ptr<NetInfo> glbnet = std::unique_ptr<NetInfo>(new NetInfo());
+    std::unique_ptr<NetInfo> glbnet = std::unique_ptr<NetInfo>(new (ctx) NetInfo());
     glbnet->name = ctx->id(glb_name);
     glbnet->driver = pr;
     gb->ports[ctx->id("GLOBAL_BUFFER_OUTPUT")].net = glbnet.get();
@@ -611,12 +605,13 @@ static void insert_global(Context *ctx, NetInfo *net, bool is_reset, bool is_cen
         if (is_clock_port(ctx, user) || (is_reset && is_reset_port(ctx, user)) ||
             (is_cen && is_enable_port(ctx, user)) || (is_logic && is_logic_port(ctx, user))) {
             user.cell->ports[user.port].net = glbnet.get();
-            glbnet->users.push_back(user);
+            glbnet->add_user(user);
         } else {
             keep_users.push_back(user);
         }
     }
     net->users = keep_users;
+    net->refresh_user_idx();
 
     if (net->clkconstr) {
         glbnet->clkconstr = std::unique_ptr<ClockConstraint>(new ClockConstraint());
@@ -1022,7 +1017,7 @@ static std::unique_ptr<CellInfo> spliceLUT(Context *ctx, CellInfo *ci, IdString
     pt->params[ctx->id("LUT_INIT")] = Property(65280, 16); // output is always I3
 
     // Create LUT output net.
-    std::unique_ptr<NetInfo> out_net = std::unique_ptr<NetInfo>(new NetInfo);
+    std::unique_ptr<NetInfo> out_net = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
     out_net->name = ctx->id(ci->name.str(ctx) + "$nextnr_" + portId.str(ctx) + "_lut_through_net");
     out_net->driver.cell = pt.get();
     out_net->driver.port = ctx->id("O");
@@ -1041,7 +1036,7 @@ static std::unique_ptr<CellInfo> spliceLUT(Context *ctx, CellInfo *ci, IdString
         PortRef pr;
         pr.cell = user.cell;
         pr.port = user.port;
-        out_net->users.push_back(pr);
+        out_net->add_user(pr);
     }
 
     // Add LUT to new users.
@@ -1053,6 +1048,7 @@ static std::unique_ptr<CellInfo> spliceLUT(Context *ctx, CellInfo *ci, IdString
 
     // Replace users of the original net.
     port.net->users = new_users;
+    port.net->refresh_user_idx();
 
     ctx->nets[out_net->name] = std::move(out_net);
     return pt;
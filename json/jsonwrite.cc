@@ -45,7 +45,7 @@ std::string get_string(std::string str)
 
 std::string get_name(IdString name, Context *ctx) { return get_string(name.c_str(ctx)); }
 
-void write_parameters(std::ostream &f, Context *ctx, const std::unordered_map<IdString, Property> &parameters,
+void write_parameters(std::ostream &f, Context *ctx, const dict<IdString, Property> &parameters,
                       bool for_module = false)
 {
     bool first = true;
@@ -64,7 +64,7 @@ struct PortGroup
     PortType dir;
 };
 
-std::vector<PortGroup> group_ports(Context *ctx, const std::unordered_map<IdString, PortInfo> &ports,
+std::vector<PortGroup> group_ports(Context *ctx, const dict<IdString, PortInfo> &ports,
                                    bool is_cell = false)
 {
     std::vector<PortGroup> groups;
@@ -117,7 +117,7 @@ std::string format_port_bits(const PortGroup &port, int &dummy_idx)
 void write_module(std::ostream &f, Context *ctx)
 {
     auto val = ctx->attrs.find(ctx->id("module"));
-    int dummy_idx = int(ctx->idstring_idx_to_str->size()) + 1000;
+    int dummy_idx = ctx->idstring_db->size() + 1000;
     if (val != ctx->attrs.end())
         f << stringf("    %s: {\n", get_string(val->second.as_string()).c_str());
     else
@@ -24,6 +24,7 @@
 #include "nextpnr.h"
 #include "placer1.h"
 #include "placer_heap.h"
+#include "placer_static.h"
 #include "router1.h"
 #include "router2.h"
 #include "util.h"
@@ -89,6 +90,16 @@ Arch::Arch(ArchArgs args) : args(args)
     if (!package_info)
         log_error("Unsupported package '%s' for '%s'.\n", args.package.c_str(), getChipName().c_str());
 
+    tile_bel_base.push_back(0);
+    tile_wire_base.push_back(0);
+    tile_pip_base.push_back(0);
+    for (int i = 0; i < chip_info->height * chip_info->width; i++) {
+        auto &tile = chip_info->tiles[i];
+        tile_bel_base.push_back(tile_bel_base.back() + tile.num_bels);
+        tile_wire_base.push_back(tile_wire_base.back() + tile.num_wires);
+        tile_pip_base.push_back(tile_pip_base.back() + tile.num_pips);
+    }
+
     BaseArch::init_cell_types();
     BaseArch::init_bel_buckets();
 
@@ -419,10 +430,10 @@ bool Arch::place()
         getCtx()->settings[getCtx()->id("place")] = 1;
         archInfoToAttributes();
         return retVal;
-    } else if (placer == "heap") {
+    } else if (placer == "heap" || placer == "static") {
         PlacerHeapCfg cfg(getCtx());
         cfg.ioBufTypes.insert(id_FACADE_IO);
-        bool retVal = placer_heap(getCtx(), cfg);
+        bool retVal = (placer == "static") ? placer_static(getCtx(), cfg) : placer_heap(getCtx(), cfg);
         getCtx()->settings[getCtx()->id("place")] = 1;
         archInfoToAttributes();
         return retVal;
@@ -464,7 +475,7 @@ const std::string Arch::defaultPlacer = "sa";
 
 const std::vector<std::string> Arch::availablePlacers = {"sa",
 #ifdef WITH_HEAP
-                                                         "heap"
+                                                         "heap", "static"
 #endif
 };
 
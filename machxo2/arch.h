@@ -409,6 +409,8 @@ struct Arch : BaseArch<ArchRanges>
     std::vector<IdString> x_ids, y_ids;
     // inverse of the above for name->object mapping
     std::unordered_map<IdString, int> id_to_x, id_to_y;
+    // first flat bel/wire/pip index of each tile
+    std::vector<int> tile_bel_base, tile_wire_base, tile_pip_base;
 
     // Helpers
     template <typename Id> const TileTypePOD *tile_info(Id &id) const
@@ -500,6 +502,12 @@ struct Arch : BaseArch<ArchRanges>
     PortType getBelPinType(BelId bel, IdString pin) const override;
     std::vector<IdString> getBelPins(BelId bel) const override;
 
+    int getBelCount() const override { return tile_bel_base.back(); }
+    int getBelIndex(BelId bel) const override
+    {
+        return tile_bel_base[bel.location.y * chip_info->width + bel.location.x] + bel.index;
+    }
+
     // Package
     BelId getPackagePinBel(const std::string &pin) const;
 
@@ -516,6 +524,12 @@ struct Arch : BaseArch<ArchRanges>
 
     DelayQuad getWireDelay(WireId wire) const override { return DelayQuad(0); }
 
+    int getWireCount() const override { return tile_wire_base.back(); }
+    int getWireIndex(WireId wire) const override
+    {
+        return tile_wire_base[wire.location.y * chip_info->width + wire.location.x] + wire.index;
+    }
+
     WireRange getWires() const override
     {
         WireRange range;
@@ -589,6 +603,12 @@ struct Arch : BaseArch<ArchRanges>
 
     DelayQuad getPipDelay(PipId pip) const override { return DelayQuad(0); }
 
+    int getPipCount() const override { return tile_pip_base.back(); }
+    int getPipIndex(PipId pip) const override
+    {
+        return tile_pip_base[pip.location.y * chip_info->width + pip.location.x] + pip.index;
+    }
+
     PipRange getPipsDownhill(WireId wire) const override
     {
         PipRange range;
@@ -156,7 +156,7 @@ static void set_net_constant(Context *ctx, NetInfo *orig, NetInfo *constnet, boo
                 uc->ports[user.port].net = constnet;
             }
 
-            constnet->users.push_back(user);
+            constnet->add_user(user);
         }
     }
     orig->users.clear();
@@ -179,13 +179,13 @@ static void pack_constants(Context *ctx)
     const_cell->params[id_LUT0_INITVAL] = Property(0, 16);
     const_cell->params[id_LUT1_INITVAL] = Property(0xFFFF, 16);
 
-    std::unique_ptr<NetInfo> gnd_net = std::unique_ptr<NetInfo>(new NetInfo);
+    std::unique_ptr<NetInfo> gnd_net = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
     gnd_net->name = ctx->id("$PACKER_GND_NET");
     gnd_net->driver.cell = const_cell.get();
     gnd_net->driver.port = id_F0;
     const_cell->ports.at(id_F0).net = gnd_net.get();
 
-    std::unique_ptr<NetInfo> vcc_net = std::unique_ptr<NetInfo>(new NetInfo);
+    std::unique_ptr<NetInfo> vcc_net = std::unique_ptr<NetInfo>(new (ctx) NetInfo);
     vcc_net->name = ctx->id("$PACKER_VCC_NET");
     vcc_net->driver.cell = const_cell.get();
     vcc_net->driver.port = id_F1;
@@ -25,6 +25,7 @@
 #include "nextpnr.h"
 #include "placer1.h"
 #include "placer_heap.h"
+#include "placer_static.h"
 #include "router1.h"
 #include "router2.h"
 #include "timing.h"
@@ -105,6 +106,14 @@ Arch::Arch(ArchArgs args) : args(args)
     for (size_t i = 0; i < chip_info->grid.size(); i++) {
         tileStatus[i].boundcells.resize(db->loctypes[chip_info->grid[i].loc_type].bels.size());
     }
+    // Dense wire and pip indices; non-primary tile wires are given an index too, for simplicity
+    tile_wire_base.push_back(0);
+    tile_pip_base.push_back(0);
+    for (size_t i = 0; i < chip_info->grid.size(); i++) {
+        auto &lt = db->loctypes[chip_info->grid[i].loc_type];
+        tile_wire_base.push_back(tile_wire_base.back() + lt.wires.ssize());
+        tile_pip_base.push_back(tile_pip_base.back() + lt.pips.ssize());
+    }
     // This structure is needed for a fast getBelByLocation because bels can have an offset
     for (size_t i = 0; i < chip_info->grid.size(); i++) {
         auto &loc = db->loctypes[chip_info->grid[i].loc_type];
@@ -565,6 +574,9 @@ TimingClockingInfo Arch::getPortClockingInfo(const CellInfo *cell, IdString port
 
 delay_t Arch::estimateDelay(WireId src, WireId dst) const
 {
+    delay_t lookahead_delay;
+    if (lookahead.estimateDelay(getWireIndex(src), getWireIndex(dst), lookahead_delay))
+        return lookahead_delay;
     int src_x = src.tile % chip_info->width, src_y = src.tile / chip_info->width;
     int dst_x = dst.tile % chip_info->width, dst_y = dst.tile / chip_info->width;
     int dist_x = std::abs(src_x - dst_x);
@@ -627,7 +639,7 @@ bool Arch::place()
 {
     std::string placer = str_or_default(settings, id("placer"), defaultPlacer);
 
-    if (placer == "heap") {
+    if (placer == "heap" || placer == "static") {
         PlacerHeapCfg cfg(getCtx());
         cfg.ioBufTypes.insert(id_SEIO33_CORE);
         cfg.ioBufTypes.insert(id_SEIO18_CORE);
@@ -635,7 +647,8 @@ bool Arch::place()
         cfg.placeAllAtOnce = true;
         cfg.beta = 0.5;
         cfg.criticalityExponent = 7;
-        if (!placer_heap(getCtx(), cfg))
+        bool placed = (placer == "static") ? placer_static(getCtx(), cfg) : placer_heap(getCtx(), cfg);
+        if (!placed)
             return false;
     } else if (placer == "sa") {
         if (!placer1(getCtx(), Placer1Cfg(getCtx())))
@@ -682,6 +695,9 @@ bool Arch::route()
 
     route_globals();
 
+    if (bool_or_default(settings, id("router/lookahead")))
+        lookahead.init(getCtx());
+
     std::string router = str_or_default(settings, id("router"), defaultRouter);
     bool result;
     if (router == "router1") {
@@ -951,7 +967,7 @@ const std::string Arch::defaultPlacer = "sa";
 
 const std::vector<std::string> Arch::availablePlacers = {"sa",
 #ifdef WITH_HEAP
-                                                         "heap"
+                                                         "heap", "static"
 #endif
 
 };
@@ -28,6 +28,7 @@
 #include "nextpnr_namespaces.h"
 #include "nextpnr_types.h"
 #include "relptr.h"
+#include "router_lookahead.h"
 
 NEXTPNR_NAMESPACE_BEGIN
 
@@ -903,6 +904,8 @@ struct Arch : BaseArch<ArchRanges>
         CellInfo *cells[32];
     };
 
+    // Bels are bound in boundcells rather than in the BaseArch bind table, so that binding can update the logic tile
+    // status used by the validity checks
     struct TileStatus
     {
         std::vector<CellInfo *> boundcells;
@@ -912,6 +915,8 @@ struct Arch : BaseArch<ArchRanges>
     };
 
     std::vector<TileStatus> tileStatus;
+    // First dense wire and pip index for each tile, in the same order as getWires/getPips
+    std::vector<int> tile_wire_base, tile_pip_base;
 
     // fast access to  X and Y IdStrings for building object names
     std::vector<IdString> x_ids, y_ids;
@@ -1046,6 +1051,9 @@ struct Arch : BaseArch<ArchRanges>
 
     DelayQuad getWireDelay(WireId wire) const override { return DelayQuad(0); }
 
+    int getWireCount() const override { return tile_wire_base.back(); }
+    int getWireIndex(WireId wire) const override { return tile_wire_base[wire.tile] + wire.index; }
+
     BelPinRange getWireBelPins(WireId wire) const override
     {
         BelPinRange range;
@@ -1109,6 +1117,9 @@ struct Arch : BaseArch<ArchRanges>
         return loc;
     }
 
+    int getPipCount() const override { return tile_pip_base.back(); }
+    int getPipIndex(PipId pip) const override { return tile_pip_base[pip.tile] + pip.index; }
+
     IdString getPipType(PipId pip) const override;
     std::vector<std::pair<IdString, std::string>> getPipAttrs(PipId pip) const override;
 
@@ -1167,6 +1178,8 @@ struct Arch : BaseArch<ArchRanges>
     // -------------------------------------------------
 
     delay_t estimateDelay(WireId src, WireId dst) const override;
+    // Precomputed lookahead used by estimateDelay, if enabled with the router/lookahead setting
+    RouterLookahead lookahead;
     delay_t predictDelay(const NetInfo *net_info, const PortRef &sink) const override;
     delay_t getDelayEpsilon() const override { return 20; }
     delay_t getRipupDelayPenalty() const override { return 120; }
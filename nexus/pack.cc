@@ -154,8 +154,11 @@ struct NexusPacker
         for (auto &param : ci->params)
             if (rule.param_xform.count(param.first))
                 xform_params.push_back(param.first);
-        for (auto param : xform_params)
-            ci->params[rule.param_xform.at(param)] = ci->params[param];
+        for (auto param : xform_params) {
+            // Copy the value first, as adding the new parameter may move the existing ones
+            Property value = ci->params.at(param);
+            ci->params[rule.param_xform.at(param)] = value;
+        }
 
         for (auto &attr : rule.set_attrs)
             ci->attrs[attr.first] = attr.second;
@@ -835,13 +838,14 @@ struct NexusPacker
         for (auto &usr : net->users) {
             if (pred(usr)) {
                 usr.cell->ports[usr.port].net = buffered_net;
-                buffered_net->users.push_back(usr);
+                buffered_net->add_user(usr);
             } else {
                 remaining_users.push_back(usr);
             }
         }
 
         std::swap(net->users, remaining_users);
+        net->refresh_user_idx();
 
         // Connect buffer input to original net
         connect_port(ctx, net, buffer, i);
@@ -1571,7 +1575,8 @@ struct NexusPacker
     {
         if (!orig->params.count(orig_name))
             return;
-        dst->params[dst_name] = orig->params[orig_name];
+        Property value = orig->params.at(orig_name);
+        dst->params[dst_name] = value;
     }
 
     struct DSPMacroType